@@ -25,6 +25,12 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <ctype.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
 #include "ossie/debug.h"
 
 template <typename T>
@@ -136,133 +142,121 @@ std::string getAffinity(pthread_t thread, LOGGER _log=LOGGER()) {
 	return stream.str();
 }
 
-static uint64_t get_rx_queue(std::string ip, uint16_t port, int &num_listeners, LOGGER _log=LOGGER()) {
-
-    if (!_log) {
-        _log = rh_logger::Logger::getLogger("SourceSDDS_utils");
-        RH_DEBUG(_log, "get_rx_queue method passed null logger; creating logger "<<_log->getName());
-    } else {
-        RH_DEBUG(_log, "get_rx_queue method passed valid logger "<<_log->getName());
-    }
-
-	// Im not super happy with this but there doesnt seem to be any other API to get the current
-	// buffer "fullness" other than the proc file system....so we're file parsing in C++ to get a kernel
-	// value.
-
-	// Taken from: http://www.makelinux.net/alp/050
-
-	FILE* fp;
-	char buffer[1024*1024];  // Too big?
-	size_t bytes_read;
-	char* match;
-
-	// local_address rem_address   st tx_queue:rx_queue
-	char local_address[128];
-	char rem_address[128];
-	char st[128];
-	char tx_rx_queue[128];
-
-	uint64_t rx_queue = 0;
-	num_listeners = 0;
-
-	/* Read the entire contents of /proc/net/udp into the buffer.  */
-	fp = fopen ("/proc/net/udp", "r");
-	if (fp == NULL) {
-		RH_DEBUG(_log, "get_rx_queue: Failed to open /proc/net/udp");
-		return 0;
-	}
-	bytes_read = fread (buffer, 1, sizeof (buffer), fp);
-	fclose (fp);
-
-	/* Bail if read failed or if buffer isn't big enough.  */
-	if (bytes_read == 0 || bytes_read == sizeof (buffer)) {
-	 return 0;
-	}
-
-	/* NUL-terminate the text.  */
-	buffer[bytes_read] = '\0';
-
-	/* Locate the line that starts with our ip and port  */
-	in_addr_t ip_add = inet_addr(ip.c_str());
-	std::stringstream ss;
-	ss << std::uppercase << std::hex << ip_add << ":" << port;
-
-	// Find all occurrences and return the max
-	match = strstr (buffer, ss.str().c_str());
-	if (match == NULL) {
-		RH_DEBUG(_log, "get_rx_queue: In parsing /proc/net/udp the IP and port not found, is the socket bound?");
-		return 0;
+/**
+ * Pins the thread to the single provided CPU. Unlike setAffinity this works for any CPU number.
+ */
+int setAffinityToCpu(pthread_t thread, int cpu) {
+	if (cpu < 0 || cpu >= CPU_SETSIZE) {
+		return -1;
 	}
 
-	while (match) {
-		num_listeners++;
-		/* Parse the line to extract the tx_queue:rx_queue.  */
-		// 00000000:0801 00000000:0000 07 00000000:00000000
-		sscanf (match, "%s %s %s %s", &local_address[0], &rem_address[0], &st[0], &tx_rx_queue[0]);
-
-		std::string rx_queue_str(tx_rx_queue);
-		std::size_t colon_pos = rx_queue_str.find(':');
+	cpu_set_t cpuset;
+	CPU_ZERO(&cpuset);
+	CPU_SET(cpu, &cpuset);
+	return (pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpuset) == 0) ? 0 : -1;
+}
 
-		if (colon_pos == std::string::npos) {
-			RH_WARN(_log, "get_rx_queue: Failed to properly parse the UDP socket buffer information from /proc/net/udp");
-			return 0;
+/**
+ * Parses a comma separated list of CPU numbers (eg. 2,3,6) into cpus, white space is ignored. Returns false, leaving cpus empty,
+ * if any entry is not a valid CPU number. An empty string is an empty list.
+ */
+bool parseCpuList(const std::string &list, std::vector<int> &cpus) {
+	cpus.clear();
+	std::stringstream stream(list);
+	std::string entry;
+
+	while (std::getline(stream, entry, ',')) {
+		entry.erase(std::remove_if(entry.begin(), entry.end(), ::isspace), entry.end());
+		try {
+			int cpu = boost::lexical_cast<int>(entry);
+			if (cpu < 0 || cpu >= CPU_SETSIZE) {
+				cpus.clear();
+				return false;
+			}
+			cpus.push_back(cpu);
+		} catch (boost::bad_lexical_cast &e) {
+			cpus.clear();
+			return false;
 		}
+	}
+	return true;
+}
 
-		rx_queue_str = rx_queue_str.substr(colon_pos+1, rx_queue_str.size());
-
-		bool success;
-		uint64_t tmp_rx_queue = ConvertString<uint64_t>(rx_queue_str, success);
-
-		if (success) {
-			rx_queue = std::max(rx_queue, tmp_rx_queue);
+/**
+ * Pins the thread to the provided CPUs, letting the scheduler pick between them.
+ */
+int setAffinityToCpus(pthread_t thread, const std::vector<int> &cpus) {
+	cpu_set_t cpuset;
+	CPU_ZERO(&cpuset);
+	for (size_t i = 0; i < cpus.size(); ++i) {
+		if (cpus[i] >= 0 && cpus[i] < CPU_SETSIZE) {
+			CPU_SET(cpus[i], &cpuset);
 		}
-
-
-		// Move the pointer along
-		match++;
-		match = strstr (match, ss.str().c_str());
 	}
 
-	return rx_queue;
+	if (CPU_COUNT(&cpuset) == 0) {
+		return -1;
+	}
+	return (pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpuset) == 0) ? 0 : -1;
 }
 
-static int64_t get_rx_dropped(std::string interface, LOGGER _log=LOGGER()) {
+/**
+ * Returns the NUMA node the network interface's device is attached to as reported by sysfs, or -1 if the kernel does
+ * not say, which is the case for virtual interfaces, single node machines and platforms without NUMA.
+ */
+int getInterfaceNumaNode(std::string interface, LOGGER _log=LOGGER()) {
     if (!_log) {
         _log = rh_logger::Logger::getLogger("SourceSDDS_utils");
-        RH_DEBUG(_log, "get_rx_dropped method passed null logger; creating logger "<<_log->getName());
+        RH_DEBUG(_log, "getInterfaceNumaNode method passed null logger; creating logger "<<_log->getName());
     } else {
-        RH_DEBUG(_log, "get_rx_dropped method passed valid logger "<<_log->getName());
+        RH_DEBUG(_log, "getInterfaceNumaNode method passed valid logger "<<_log->getName());
     }
 
-	if (interface.empty()) {
-		RH_DEBUG(_log, "get_rx_dropped: Interface provided is empty, cannot get rx_dropped statistics");
-		return 0;
-	}
-
-	FILE* fp;
-	char buffer[1024];
-	size_t bytes_read;
-
-	std::stringstream ss;
-	ss << "/sys/class/net/" << interface << "/statistics/rx_dropped";
-
-	fp = fopen(ss.str().c_str(), "r");
-	if (!fp) {
-		RH_DEBUG(_log, "get_rx_dropped: Failed to open " << ss.str());
+	int node = -1;
+	std::string path = "/sys/class/net/" + interface + "/device/numa_node";
+	std::ifstream file(path.c_str());
+	if (not (file >> node)) {
+		RH_DEBUG(_log, "getInterfaceNumaNode: Could not read " << path);
 		return -1;
 	}
-	bytes_read = fread(buffer, 1, sizeof (buffer), fp);
-	fclose (fp);
 
-	/* Bail if read failed or if buffer isn't big enough.  */
-	if (bytes_read == 0 || bytes_read == sizeof (buffer)) {
-	 return -1;
+	return (node < 0) ? -1 : node;
+}
+
+/**
+ * Fills cpus with the CPUs of the NUMA node as listed in sysfs, where the list is made up of ranges (eg. 0-7,16-23).
+ * Returns false, leaving cpus empty, if the node does not exist or the list could not be parsed.
+ */
+bool getNumaNodeCpus(int node, std::vector<int> &cpus) {
+	cpus.clear();
+	std::string path = "/sys/devices/system/node/node" + boost::lexical_cast<std::string>(node) + "/cpulist";
+	std::ifstream file(path.c_str());
+	std::string list;
+	if (node < 0 || not std::getline(file, list)) {
+		return false;
 	}
 
-	/* NUL-terminate the text.  */
-	buffer[bytes_read] = '\0';
+	std::stringstream stream(list);
+	std::string entry;
+	while (std::getline(stream, entry, ',')) {
+		entry.erase(std::remove_if(entry.begin(), entry.end(), ::isspace), entry.end());
+		if (entry.empty()) {
+			continue;
+		}
 
-	return atol(buffer);
+		size_t dash = entry.find('-');
+		try {
+			int first = boost::lexical_cast<int>(entry.substr(0, dash));
+			int last = (dash == std::string::npos) ? first : boost::lexical_cast<int>(entry.substr(dash + 1));
+			for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+				cpus.push_back(cpu);
+			}
+		} catch (boost::bad_lexical_cast &e) {
+			cpus.clear();
+			return false;
+		}
+	}
+	return not cpus.empty();
 }
 
 int setPolicyAndPriority(pthread_t thread, CORBA::Long priority, std::string thread_desc, LOGGER _log=LOGGER()) {
@@ -0,0 +1,142 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#include "ByteSwap.h"
+#include <string.h>
+#if defined(__i386__) || defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+typedef void (*byte_swap_kernel_t)(uint8_t *dst, const uint8_t *src, size_t len, bool non_temporal);
+
+/**
+ * The kernels in use. They are picked once by a static initialiser, see KernelPicker, as the component is loaded so before
+ * any thread can call them or ask for their name. Until then they are the scalar kernels, which are always correct.
+ */
+static byte_swap_kernel_t swap16Kernel = byteSwap16Scalar;
+static byte_swap_kernel_t swap32Kernel = byteSwap32Scalar;
+static const char *kernelName = "scalar";
+
+void byteSwap16Scalar(uint8_t *dst, const uint8_t *src, size_t len, bool non_temporal) {
+	size_t i = 0;
+	for (; i + 2 <= len; i += 2) {
+		uint16_t sample;
+		memcpy(&sample, src + i, sizeof(sample));
+		sample = (uint16_t) ((sample << 8) | (sample >> 8));
+		memcpy(dst + i, &sample, sizeof(sample));
+	}
+	if (i < len && dst != src) {
+		dst[i] = src[i];
+	}
+}
+
+void byteSwap32Scalar(uint8_t *dst, const uint8_t *src, size_t len, bool non_temporal) {
+	size_t i = 0;
+	for (; i + 4 <= len; i += 4) {
+		uint32_t sample;
+		memcpy(&sample, src + i, sizeof(sample));
+		sample = __builtin_bswap32(sample);
+		memcpy(dst + i, &sample, sizeof(sample));
+	}
+	if (i < len && dst != src) {
+		memmove(dst + i, src + i, len - i);
+	}
+}
+
+#ifdef HAVE_BYTESWAP_X86
+/**
+ * Returns the state components the OS saves on a context switch, the SIMD registers may only be used if it saves them.
+ */
+static uint64_t xgetbv() {
+	uint32_t eax, edx;
+	__asm__ __volatile__("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+	return ((uint64_t) edx << 32) | eax;
+}
+#endif
+
+/**
+ * Picks the widest kernels both the CPU and the build support.
+ */
+static void pickKernels() {
+	byte_swap_kernel_t swap16 = byteSwap16Scalar;
+	byte_swap_kernel_t swap32 = byteSwap32Scalar;
+	const char *name = "scalar";
+
+#ifdef HAVE_BYTESWAP_X86
+	unsigned int eax, ebx, ecx, edx;
+	if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+		const bool ssse3 = ecx & bit_SSSE3;
+		const bool osxsave = ecx & bit_OSXSAVE;
+		const uint64_t xcr0 = (osxsave) ? xgetbv() : 0;
+		const bool ymm = (xcr0 & 0x6) == 0x6;    // XMM and YMM state
+		const bool zmm = (xcr0 & 0xe6) == 0xe6;  // and the opmask and ZMM state
+
+		unsigned int max_leaf = __get_cpuid_max(0, NULL);
+		unsigned int ebx7 = 0;
+		if (max_leaf >= 7) {
+			__cpuid_count(7, 0, eax, ebx7, ecx, edx);
+		}
+
+		if (ssse3) {
+			swap16 = byteSwap16Ssse3;
+			swap32 = byteSwap32Ssse3;
+			name = "ssse3";
+		}
+		if (ymm && (ebx7 & (1 << 5))) {          // AVX2
+			swap16 = byteSwap16Avx2;
+			swap32 = byteSwap32Avx2;
+			name = "avx2";
+		}
+#ifdef HAVE_BYTESWAP_AVX512
+		if (zmm && (ebx7 & (1 << 16)) && (ebx7 & (1 << 30))) { // AVX512F and AVX512BW
+			swap16 = byteSwap16Avx512;
+			swap32 = byteSwap32Avx512;
+			name = "avx512";
+		}
+#else
+		(void) zmm;
+#endif
+	}
+#endif
+
+	kernelName = name;
+	swap16Kernel = swap16;
+	swap32Kernel = swap32;
+}
+
+namespace {
+	struct KernelPicker {
+		KernelPicker() {
+			pickKernels();
+		}
+	};
+	KernelPicker kernelPicker;
+}
+
+void byteSwap16(void *dst, const void *src, size_t len, bool non_temporal) {
+	swap16Kernel(static_cast<uint8_t*>(dst), static_cast<const uint8_t*>(src), len, non_temporal);
+}
+
+void byteSwap32(void *dst, const void *src, size_t len, bool non_temporal) {
+	swap32Kernel(static_cast<uint8_t*>(dst), static_cast<const uint8_t*>(src), len, non_temporal);
+}
+
+const char* byteSwapKernel() {
+	return kernelName;
+}
@@ -0,0 +1,64 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef BYTESWAP_H_
+#define BYTESWAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Byte swaps len bytes of 16 or 32 bit samples from src into dst. dst may be src to swap in place but the two must
+ * not otherwise overlap. len should be a multiple of the sample size, any odd bytes left over are copied as is.
+ *
+ * If non_temporal is set dst is written with non temporal stores which go around the cache, worth it when dst is
+ * larger than the cache and would only evict src and everything else on its way through. They need dst aligned to
+ * the kernel's vector size (64 bytes covers all of them), otherwise normal stores are used.
+ *
+ * The work is done by the widest shuffle based kernel the CPU supports (AVX-512, AVX2, SSSE3), picked once from
+ * cpuid as the component is loaded, falling back to the scalar kernels. Each SIMD kernel lives in its own
+ * translation unit built with just its own instruction set flags, so nothing else in the component is ever compiled
+ * with instructions the CPU may not have.
+ */
+void byteSwap16(void *dst, const void *src, size_t len, bool non_temporal = false);
+void byteSwap32(void *dst, const void *src, size_t len, bool non_temporal = false);
+
+/**
+ * Returns the name of the kernel picked: avx512, avx2, ssse3 or scalar.
+ */
+const char* byteSwapKernel();
+
+/**
+ * The kernels behind the dispatch. The SIMD kernels swap whole vectors and hand the rest to the scalar ones, which
+ * always use normal stores. Calling one directly is only safe if the CPU supports it, see test_utils/byteSwapTest.cpp.
+ */
+void byteSwap16Scalar(uint8_t *dst, const uint8_t *src, size_t len, bool non_temporal);
+void byteSwap32Scalar(uint8_t *dst, const uint8_t *src, size_t len, bool non_temporal);
+#ifdef HAVE_BYTESWAP_X86
+void byteSwap16Ssse3(uint8_t *dst, const uint8_t *src, size_t len, bool non_temporal);
+void byteSwap32Ssse3(uint8_t *dst, const uint8_t *src, size_t len, bool non_temporal);
+void byteSwap16Avx2(uint8_t *dst, const uint8_t *src, size_t len, bool non_temporal);
+void byteSwap32Avx2(uint8_t *dst, const uint8_t *src, size_t len, bool non_temporal);
+#endif
+#ifdef HAVE_BYTESWAP_AVX512
+void byteSwap16Avx512(uint8_t *dst, const uint8_t *src, size_t len, bool non_temporal);
+void byteSwap32Avx512(uint8_t *dst, const uint8_t *src, size_t len, bool non_temporal);
+#endif
+
+#endif /* BYTESWAP_H_ */
@@ -0,0 +1,58 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * The AVX2 byte swap kernels, this file alone is built with -mavx2, see ByteSwap.h
+ */
+#include "ByteSwap.h"
+#include <immintrin.h>
+
+/**
+ * Shuffles every whole vector of src into dst and returns the number of bytes done. The non temporal stores need an
+ * aligned dst, they are followed by a fence so the data is visible to other threads once the kernel returns.
+ */
+static size_t shuffle(uint8_t *dst, const uint8_t *src, size_t len, const __m256i mask, bool non_temporal) {
+	size_t i = 0;
+	if (non_temporal && (reinterpret_cast<uintptr_t>(dst) % sizeof(__m256i)) == 0) {
+		for (; i + sizeof(__m256i) <= len; i += sizeof(__m256i)) {
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+			_mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_shuffle_epi8(v, mask));
+		}
+		_mm_sfence();
+	} else {
+		for (; i + sizeof(__m256i) <= len; i += sizeof(__m256i)) {
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_shuffle_epi8(v, mask));
+		}
+	}
+	return i;
+}
+
+// vpshufb shuffles within each 128 bit lane so the mask is the same for both
+void byteSwap16Avx2(uint8_t *dst, const uint8_t *src, size_t len, bool non_temporal) {
+	size_t i = shuffle(dst, src, len, _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+			1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14), non_temporal);
+	byteSwap16Scalar(dst + i, src + i, len - i, false);
+}
+
+void byteSwap32Avx2(uint8_t *dst, const uint8_t *src, size_t len, bool non_temporal) {
+	size_t i = shuffle(dst, src, len, _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+			3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12), non_temporal);
+	byteSwap32Scalar(dst + i, src + i, len - i, false);
+}
@@ -0,0 +1,56 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * The AVX-512 byte swap kernels, this file alone is built with -mavx512bw, see ByteSwap.h
+ */
+#include "ByteSwap.h"
+#include <immintrin.h>
+
+/**
+ * Shuffles every whole vector of src into dst and returns the number of bytes done. The non temporal stores need an
+ * aligned dst, they are followed by a fence so the data is visible to other threads once the kernel returns.
+ */
+static size_t shuffle(uint8_t *dst, const uint8_t *src, size_t len, const __m512i mask, bool non_temporal) {
+	size_t i = 0;
+	if (non_temporal && (reinterpret_cast<uintptr_t>(dst) % sizeof(__m512i)) == 0) {
+		for (; i + sizeof(__m512i) <= len; i += sizeof(__m512i)) {
+			__m512i v = _mm512_loadu_si512(reinterpret_cast<const void*>(src + i));
+			_mm512_stream_si512(reinterpret_cast<__m512i*>(dst + i), _mm512_shuffle_epi8(v, mask));
+		}
+		_mm_sfence();
+	} else {
+		for (; i + sizeof(__m512i) <= len; i += sizeof(__m512i)) {
+			__m512i v = _mm512_loadu_si512(reinterpret_cast<const void*>(src + i));
+			_mm512_storeu_si512(reinterpret_cast<void*>(dst + i), _mm512_shuffle_epi8(v, mask));
+		}
+	}
+	return i;
+}
+
+// vpshufb shuffles within each 128 bit lane so the mask is the same for all four, given here as little endian words
+void byteSwap16Avx512(uint8_t *dst, const uint8_t *src, size_t len, bool non_temporal) {
+	size_t i = shuffle(dst, src, len, _mm512_set4_epi32(0x0E0F0C0D, 0x0A0B0809, 0x06070405, 0x02030001), non_temporal);
+	byteSwap16Scalar(dst + i, src + i, len - i, false);
+}
+
+void byteSwap32Avx512(uint8_t *dst, const uint8_t *src, size_t len, bool non_temporal) {
+	size_t i = shuffle(dst, src, len, _mm512_set4_epi32(0x0C0D0E0F, 0x08090A0B, 0x04050607, 0x00010203), non_temporal);
+	byteSwap32Scalar(dst + i, src + i, len - i, false);
+}
@@ -0,0 +1,55 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * The SSSE3 byte swap kernels, this file alone is built with -mssse3, see ByteSwap.h
+ */
+#include "ByteSwap.h"
+#include <tmmintrin.h>
+
+/**
+ * Shuffles every whole vector of src into dst and returns the number of bytes done. The non temporal stores need an
+ * aligned dst, they are followed by a fence so the data is visible to other threads once the kernel returns.
+ */
+static size_t shuffle(uint8_t *dst, const uint8_t *src, size_t len, const __m128i mask, bool non_temporal) {
+	size_t i = 0;
+	if (non_temporal && (reinterpret_cast<uintptr_t>(dst) % sizeof(__m128i)) == 0) {
+		for (; i + sizeof(__m128i) <= len; i += sizeof(__m128i)) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			_mm_stream_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(v, mask));
+		}
+		_mm_sfence();
+	} else {
+		for (; i + sizeof(__m128i) <= len; i += sizeof(__m128i)) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(v, mask));
+		}
+	}
+	return i;
+}
+
+void byteSwap16Ssse3(uint8_t *dst, const uint8_t *src, size_t len, bool non_temporal) {
+	size_t i = shuffle(dst, src, len, _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14), non_temporal);
+	byteSwap16Scalar(dst + i, src + i, len - i, false);
+}
+
+void byteSwap32Ssse3(uint8_t *dst, const uint8_t *src, size_t len, bool non_temporal) {
+	size_t i = shuffle(dst, src, len, _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12), non_temporal);
+	byteSwap32Scalar(dst + i, src + i, len - i, false);
+}
@@ -0,0 +1,133 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * LatencyHistogram.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author:
+ */
+
+#ifndef LATENCYHISTOGRAM_H_
+#define LATENCYHISTOGRAM_H_
+
+#include <stdint.h>
+#include <string.h>
+
+// Each power of two is split into 2^LATENCY_SUB_BITS buckets so a bucket is at most 12.5% wide
+#define LATENCY_SUB_BITS 3
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_NUM_BUCKETS ((64 - LATENCY_SUB_BITS + 1) * LATENCY_SUB_BUCKETS)
+
+/**
+ * A log scale histogram of latencies in nanoseconds. Values below LATENCY_SUB_BUCKETS get a bucket each, above that
+ * every power of two is split into LATENCY_SUB_BUCKETS equal buckets so the resolution stays relative to the value.
+ *
+ * There is exactly one writer (record and reset) and any number of readers (percentile, max). No locks are taken;
+ * a reader racing the writer may see a count or two that are one record behind which does not matter for percentiles.
+ */
+class LatencyHistogram {
+public:
+	LatencyHistogram() {
+		reset();
+	}
+
+	/**
+	 * Empties the histogram. Must only be called by the writer.
+	 */
+	void reset() {
+		memset((void*) m_counts, 0, sizeof(m_counts));
+		m_total = 0;
+		m_max = 0;
+	}
+
+	/**
+	 * Adds a latency of ns nanoseconds.
+	 */
+	void record(uint64_t ns) {
+		++m_counts[bucket(ns)];
+		++m_total;
+		if (ns > m_max) {
+			m_max = ns;
+		}
+	}
+
+	/**
+	 * Returns the latency, in nanoseconds, that fraction (0 to 1) of the recorded latencies are at or below. The value
+	 * is the top of the bucket the percentile falls in, capped at the largest latency recorded. Zero if nothing has
+	 * been recorded.
+	 */
+	uint64_t percentile(double fraction) const {
+		uint64_t total = m_total;
+		if (total == 0) {
+			return 0;
+		}
+
+		uint64_t target = (uint64_t) (fraction * total + 0.5);
+		target = (target == 0) ? 1 : (target > total) ? total : target;
+
+		uint64_t seen = 0;
+		for (size_t i = 0; i < LATENCY_NUM_BUCKETS; ++i) {
+			seen += m_counts[i];
+			if (seen >= target) {
+				uint64_t top = upper_bound(i);
+				return (top < m_max) ? top : m_max;
+			}
+		}
+		return m_max;
+	}
+
+	/**
+	 * Returns the largest latency recorded, in nanoseconds.
+	 */
+	uint64_t max() const {
+		return m_max;
+	}
+
+	/**
+	 * Returns the number of latencies recorded.
+	 */
+	uint64_t count() const {
+		return m_total;
+	}
+
+private:
+	volatile uint64_t m_counts[LATENCY_NUM_BUCKETS];
+	volatile uint64_t m_total;
+	volatile uint64_t m_max;
+
+	static size_t bucket(uint64_t ns) {
+		if (ns < LATENCY_SUB_BUCKETS) {
+			return ns;
+		}
+		unsigned shift = (63 - __builtin_clzll(ns)) - LATENCY_SUB_BITS;
+		return (shift + 1) * LATENCY_SUB_BUCKETS + ((ns >> shift) & (LATENCY_SUB_BUCKETS - 1));
+	}
+
+	static uint64_t upper_bound(size_t index) {
+		if (index < LATENCY_SUB_BUCKETS) {
+			return index;
+		}
+		unsigned shift = index / LATENCY_SUB_BUCKETS - 1;
+		uint64_t sub = index % LATENCY_SUB_BUCKETS;
+		return ((LATENCY_SUB_BUCKETS + sub) << shift) + ((1ULL << shift) - 1);
+	}
+};
+
+#endif /* LATENCYHISTOGRAM_H_ */
@@ -0,0 +1,388 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * PacketArena.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author:
+ */
+
+#ifndef PACKETARENA_H_
+#define PACKETARENA_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#include <fstream>
+#include <string>
+#include <algorithm>
+#include <new>
+
+#define ARENA_CACHE_LINE_SIZE 64
+#define ARENA_MAX_NUMA_NODES 1024
+
+/**
+ * How the arena's memory is backed.
+ */
+enum arena_pages_t {
+	ARENA_PAGES_DEFAULT,     // Whatever malloc hands out, normally base pages
+	ARENA_PAGES_TRANSPARENT, // Aligned to and advised for transparent huge pages
+	ARENA_PAGES_HUGETLB      // Mapped from the reserved huge page pool, falls back to transparent if the pool is empty
+};
+
+/**
+ * A fixed number of packet slots carved out of a single contiguous block of memory.
+ *
+ * The block is allocated once, aligned to a cache line, and every slot is padded out to a whole
+ * number of cache lines so no two packets ever share a line. Slots are handed out by index,
+ * slot i always lives at the same address for the lifetime of the arena which keeps the access
+ * pattern of the socket reader and processor predictable for the hardware prefetcher.
+ * T is expected to be a plain old data type (eg. SDDSheader), slots are value initialized (zeroed).
+ *
+ * Each slot may carry payload_size bytes of payload following the T. In the packed layout the payload
+ * directly follows the T within the slot, exactly as the packet is laid out on the wire. In the split
+ * layout the slots only hold the T and the payloads live in a second block where the payload for slot i
+ * immediately follows the payload for slot i - 1, so the payloads of consecutive slots form one
+ * contiguous run of memory.
+ *
+ * Each slot may also reserve headroom bytes in front of the T. The headroom is never touched by the arena, it exists
+ * so that something that writes a prefix ahead of the packet (eg. the io_uring multishot recvmsg header) can be handed
+ * the slot minus the headroom and still have the packet itself land on the slot.
+ *
+ * If a NUMA node is given both blocks are page aligned and the kernel is asked, with mbind, to place their pages on
+ * that node whichever CPU the thread creating the arena, or first touching a page, runs on.
+ *
+ * The blocks may be backed by huge pages (see arena_pages_t) which cuts the TLB misses of walking a large arena, and
+ * may be locked into memory so they are never swapped out. Either way every page is faulted in up front, so the
+ * first pass through the slots does not take a page fault per page. page_size() reports the page size obtained.
+ */
+template <class T>
+class PacketArena {
+public:
+	PacketArena(size_t capacity, size_t payload_size = 0, bool split = false, size_t headroom = 0, int numa_node = -1,
+			arena_pages_t pages = ARENA_PAGES_DEFAULT, bool lock = false):
+		m_base(NULL), m_payload_base(NULL), m_base_length(0), m_payload_length(0), m_base_mapped(false), m_payload_mapped(false), m_capacity(0), m_stride(0),
+		m_payload_size(payload_size), m_headroom(headroom), m_split(split), m_numa_node(numa_node), m_bound_node(-1),
+		m_pages(pages), m_lock(lock), m_locked(lock), m_page_size(sysconf(_SC_PAGESIZE)) {
+		m_stride = round_to_cache_line(m_headroom + sizeof(T) + ((m_split) ? 0 : m_payload_size));
+
+		// Placed before anything is written, a page only gets its memory once it is first touched
+		bool bound = true;
+		size_t page_size = 0;
+		m_base = allocate(capacity * m_stride, m_base_length, m_base_mapped, bound, page_size);
+		if (m_split && m_payload_size) {
+			try {
+				m_payload_base = allocate(capacity * m_payload_size, m_payload_length, m_payload_mapped, bound, page_size);
+			} catch (...) {
+				release(m_base, m_base_length, m_base_mapped);
+				throw;
+			}
+		}
+
+		m_capacity = capacity;
+		if (m_numa_node >= 0 && bound) {
+			m_bound_node = m_numa_node;
+		}
+		if (page_size) {
+			m_page_size = page_size;
+		}
+
+		for (size_t i = 0; i < m_capacity; ++i) {
+			new (m_base + i * m_stride + m_headroom) T();
+		}
+	}
+
+	~PacketArena() {
+		release(m_base, m_base_length, m_base_mapped);
+		release(m_payload_base, m_payload_length, m_payload_mapped);
+	}
+
+	/**
+	 * Returns the packet living in slot index. No bounds checking is done.
+	 */
+	T* slot(size_t index) const {
+		return reinterpret_cast<T*>(m_base + index * m_stride + m_headroom);
+	}
+
+	/**
+	 * Returns the slot index of a packet handed out by this arena.
+	 */
+	size_t index_of(const T* pkt) const {
+		return (reinterpret_cast<const uint8_t*>(pkt) - m_base - m_headroom) / m_stride;
+	}
+
+	/**
+	 * Returns the start of the payload belonging to the provided packet.
+	 */
+	uint8_t* payload_of(const T* pkt) const {
+		if (m_split) {
+			return m_payload_base + index_of(pkt) * m_payload_size;
+		}
+		return const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(pkt)) + sizeof(T);
+	}
+
+	size_t capacity() const {
+		return m_capacity;
+	}
+
+	size_t payload_size() const {
+		return m_payload_size;
+	}
+
+	size_t headroom() const {
+		return m_headroom;
+	}
+
+	bool is_split() const {
+		return m_split;
+	}
+
+	/**
+	 * The NUMA node that was asked for, or -1 for none.
+	 */
+	int numa_node() const {
+		return m_numa_node;
+	}
+
+	/**
+	 * The NUMA node the arena's memory is placed on, or -1 if none was asked for or the kernel refused.
+	 */
+	int bound_node() const {
+		return m_bound_node;
+	}
+
+	arena_pages_t pages() const {
+		return m_pages;
+	}
+
+	/**
+	 * Whether locking the arena into memory was asked for.
+	 */
+	bool lock() const {
+		return m_lock;
+	}
+
+	/**
+	 * Whether the arena is locked into memory, false if it was not asked for or the kernel refused (see RLIMIT_MEMLOCK).
+	 */
+	bool locked() const {
+		return m_locked;
+	}
+
+	/**
+	 * The size in bytes of the pages backing the arena, the smallest of the two blocks' if they differ.
+	 */
+	size_t page_size() const {
+		return m_page_size;
+	}
+
+	/**
+	 * The distance in bytes between the start of two consecutive slots.
+	 */
+	size_t stride() const {
+		return m_stride;
+	}
+
+private:
+	PacketArena(const PacketArena&);              // Disabled copy constructor
+	PacketArena& operator = (const PacketArena&); // Disabled assign operator
+
+	static size_t round_to_cache_line(size_t size) {
+		return ((size + ARENA_CACHE_LINE_SIZE - 1) / ARENA_CACHE_LINE_SIZE) * ARENA_CACHE_LINE_SIZE;
+	}
+
+	static size_t round_up(size_t size, size_t multiple) {
+		return ((size + multiple - 1) / multiple) * multiple;
+	}
+
+	/**
+	 * Returns the default huge page size from /proc/meminfo, or 0 if the kernel has no huge pages.
+	 */
+	static size_t huge_page_size() {
+		std::ifstream meminfo("/proc/meminfo");
+		std::string line;
+		unsigned long kb = 0;
+		while (std::getline(meminfo, line)) {
+			if (sscanf(line.c_str(), "Hugepagesize: %lu kB", &kb) == 1) {
+				return kb * 1024;
+			}
+		}
+		return 0;
+	}
+
+	/**
+	 * Returns whether any of the mapping holding mem is backed by transparent huge pages according to /proc/self/smaps.
+	 */
+	static bool has_transparent_huge_pages(const void *mem) {
+		std::ifstream smaps("/proc/self/smaps");
+		std::string line;
+		unsigned long start, end, kb;
+		bool inside = false;
+		while (std::getline(smaps, line)) {
+			if (sscanf(line.c_str(), "%lx-%lx", &start, &end) == 2) {
+				inside = ((unsigned long) mem >= start && (unsigned long) mem < end);
+			} else if (inside && sscanf(line.c_str(), "AnonHugePages: %lu kB", &kb) == 1) {
+				return kb > 0;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * Allocates size bytes aligned to a cache line or, if numa_node is set, maps whole pages of its own, setting mapped,
+	 * and places them on that node. bound is cleared if the node could not be set. The policy is MPOL_PREFERRED rather
+	 * than MPOL_BIND so the arena still comes up, from another node, if the node has run out of memory.
+	 *
+	 * With huge pages the block is instead rounded up to whole huge pages and mapped, setting mapped, either from the
+	 * huge page pool or aligned to a huge page and advised for transparent huge pages. length is set to the size of the
+	 * block actually allocated.
+	 * The block is then locked and faulted in as asked, m_locked is cleared if the lock failed, and page_size is
+	 * lowered to the page size the block ended up with.
+	 */
+	uint8_t* allocate(size_t size, size_t &length, bool &mapped, bool &bound, size_t &page_size) {
+		void *mem = NULL;
+		size_t base_page_size = sysconf(_SC_PAGESIZE);
+		size_t huge_size = (m_pages != ARENA_PAGES_DEFAULT) ? huge_page_size() : 0;
+		bool hugetlb = false;
+		length = size;
+		mapped = false;
+		if (size == 0) {
+			return NULL;
+		}
+
+		if (m_pages == ARENA_PAGES_HUGETLB && huge_size) {
+			length = round_up(size, huge_size);
+			mem = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+			if (mem == MAP_FAILED) {
+				mem = NULL;
+			} else {
+				mapped = hugetlb = true;
+			}
+		}
+
+		// A fresh mapping rather than the heap, which may hand back pages already faulted in as base pages
+		if (not mem && huge_size) {
+			length = round_up(size, huge_size);
+			uint8_t *raw = static_cast<uint8_t*>(mmap(NULL, length + huge_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+			if (raw == MAP_FAILED) {
+				throw std::bad_alloc();
+			}
+			uint8_t *aligned = reinterpret_cast<uint8_t*>(round_up(reinterpret_cast<uintptr_t>(raw), huge_size));
+			if (aligned != raw) {
+				munmap(raw, aligned - raw);
+			}
+			if (aligned + length != raw + length + huge_size) {
+				munmap(aligned + length, (raw + length + huge_size) - (aligned + length));
+			}
+			mem = aligned;
+			mapped = true;
+			madvise(mem, length, MADV_HUGEPAGE);
+		}
+
+		// The NUMA policy has to cover the arena alone, a heap block may share its first and last pages with other chunks
+		if (not mem && m_numa_node >= 0) {
+			length = round_up(size, base_page_size);
+			mem = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (mem == MAP_FAILED) {
+				throw std::bad_alloc();
+			}
+			mapped = true;
+		}
+
+		if (not mem) {
+			size_t alignment = (m_lock) ? base_page_size : ARENA_CACHE_LINE_SIZE;
+			if (posix_memalign(&mem, alignment, length) != 0) {
+				throw std::bad_alloc();
+			}
+		}
+
+		if (m_numa_node >= 0) {
+			const size_t bits = 8 * sizeof(unsigned long);
+			unsigned long nodemask[ARENA_MAX_NUMA_NODES / (8 * sizeof(unsigned long))] = {0};
+			if (m_numa_node >= ARENA_MAX_NUMA_NODES) {
+				bound = false;
+			} else {
+				nodemask[m_numa_node / bits] |= 1UL << (m_numa_node % bits);
+				if (syscall(SYS_mbind, mem, length, MPOL_PREFERRED, nodemask, ARENA_MAX_NUMA_NODES + 1, MPOL_MF_MOVE) != 0) {
+					bound = false;
+				}
+			}
+		}
+
+		// mlock faults the pages in itself, touching them covers the case it was not asked for or was refused
+		if (m_lock && mlock(mem, length) != 0) {
+			m_locked = false;
+		}
+		if (m_lock || m_pages != ARENA_PAGES_DEFAULT) {
+			volatile uint8_t *pages = static_cast<uint8_t*>(mem);
+			for (size_t offset = 0; offset < length; offset += base_page_size) {
+				pages[offset] = 0;
+			}
+		}
+
+		size_t block_page_size = base_page_size;
+		if (hugetlb || (huge_size && has_transparent_huge_pages(mem))) {
+			block_page_size = huge_size;
+		}
+		page_size = (page_size) ? std::min(page_size, block_page_size) : block_page_size;
+		return static_cast<uint8_t*>(mem);
+	}
+
+	/**
+	 * Frees a block from allocate.
+	 */
+	void release(uint8_t *mem, size_t length, bool mapped) {
+		if (not mem) {
+			return;
+		}
+		if (mapped) {
+			munmap(mem, length); // Also unlocks
+			return;
+		}
+		if (m_lock) {
+			munlock(mem, length);
+		}
+		free(mem);
+	}
+
+	uint8_t *m_base;
+	uint8_t *m_payload_base;
+	size_t m_base_length;
+	size_t m_payload_length;
+	bool m_base_mapped;
+	bool m_payload_mapped;
+	size_t m_capacity;
+	size_t m_stride;
+	size_t m_payload_size;
+	size_t m_headroom;
+	bool m_split;
+	int m_numa_node;
+	int m_bound_node;
+	arena_pages_t m_pages;
+	bool m_lock;
+	bool m_locked;
+	size_t m_page_size;
+};
+
+#endif /* PACKETARENA_H_ */
@@ -26,25 +26,52 @@
 
 #include "SddsToBulkIOProcessor.h"
 #include "SddsToBulkIOUtils.h"
+#include "ByteSwap.h"
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * Returns the wall clock in nanoseconds since the epoch, the clock the kernel time stamps received packets with.
+ */
+static inline uint64_t realtimeNs() {
+	struct timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+	return (uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+/**
+ * Returns the monotonic clock in nanoseconds, used to pace the status snapshots.
+ */
+static inline uint64_t monotonicNs() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
 
 //TODO: Should accum_error_tolerance be a setable property?  Should we report it back?
 SddsToBulkIOProcessor::SddsToBulkIOProcessor(bulkio::OutOctetPort *octet_out, bulkio::OutShortPort *short_out, bulkio::OutFloatPort *float_out):
 	m_pkts_per_read(DEFAULT_PKTS_PER_READ), m_running(false), m_shuttingDown(false), m_wait_for_ttv(false),
-	m_push_on_ttv(false), m_first_packet(true), m_current_ttv_flag(false),m_expected_seq_number(0),
-	m_last_sdds_time(0), m_pkts_dropped(0), m_bps(0), m_octet_out(octet_out), m_short_out(short_out),
+	m_push_on_ttv(false), m_first_packet(true), m_current_ttv_flag(false),
+	m_last_sdds_time(0), m_bps(0), m_pkts_since_anchor(0), m_octet_out(octet_out), m_short_out(short_out),
 	m_float_out(float_out), m_upstream_sri_set(false), m_endianness(ENDIANNESS::ENDIAN_DEFAULT),
-	m_new_upstream_sri(false), m_use_upstream_sri(false), m_num_time_slips(0), m_current_sample_rate(0),
+	m_new_upstream_sri(false), m_use_upstream_sri(false), m_current_sample_rate(0),
 	m_max_time_step(0), m_min_time_step(0), m_ideal_time_step(0), m_time_error_accum(0),
-	m_accum_error_tolerance(0.000001),m_non_conforming_device(false)
+	m_accum_error_tolerance(0.000001),m_non_conforming_device(false), m_pktbuffer(NULL), m_zero_copy(false),
+	m_run_start(NULL), m_run_pkts(0), m_run_swapped(false), m_swap_buffer(NULL), m_swap_non_temporal(false), m_merge_seq(0), m_merge_started(false), m_merge_hold_start(0), m_track_latency(false),
+	m_lane(0), m_default_stream_id(DEFAULT_SDDS_STREAM_ID), m_packet_kernel(NULL), m_status_interval_ms(DEFAULT_STATUS_INTERVAL_MS), m_next_publish(0)
 {
 	_log = rh_logger::Logger::getLogger("SddsToBulkIOProcessor");
 	RH_DEBUG(_log,"SddsToBulkIOProcessor constructor - Set logger to "<< _log->getName());
+	memset(&m_counters, 0, sizeof(m_counters));
+	selectPacketKernel();
 	// reserve size so it is done at construct time
 	m_bulkIO_data.reserve(m_pkts_per_read * SDDS_DATA_SIZE);
 
 	// Needs to be initialized.
-	m_sri.streamID = "DEFAULT_SDDS_STREAM_ID";
+	m_sri.streamID = m_default_stream_id.c_str();
 	m_sri.xdelta = -1;
 	m_sri.mode = -1;
 	m_sri.hversion = 0;
@@ -56,10 +83,14 @@ SddsToBulkIOProcessor::SddsToBulkIOProcessor(bulkio::OutOctetPort *octet_out, bu
 	m_sri.yunits= 0;
 	m_sri.blocking= false;
 	m_start_of_year = getStartOfYear();
+	publishMetrics(true);
 }
 
 SddsToBulkIOProcessor::~SddsToBulkIOProcessor() {
 	shutDown();
+	if (m_swap_buffer) {
+		m_swap_pool->release(m_swap_buffer);
+	}
 }
 
 void SddsToBulkIOProcessor::setLogger(LOGGER log) {
@@ -119,6 +150,7 @@ void SddsToBulkIOProcessor::setWaitForTTV(bool wait_for_ttv) {
 		return;
 	}
 	m_wait_for_ttv = wait_for_ttv;
+	selectPacketKernel();
 }
 
 /**
@@ -132,6 +164,136 @@ void SddsToBulkIOProcessor::setPushOnTTV(bool push_on_ttv) {
 	}
 
 	m_push_on_ttv = push_on_ttv;
+	selectPacketKernel();
+}
+
+/**
+ * Sets the lane of the packet buffer this processor works when run with runStreams. Cannot be called while the run
+ * method is active.
+ */
+void SddsToBulkIOProcessor::setLane(size_t lane) {
+	if (m_running) {
+		RH_WARN(_log, "Cannot change the lane while the processor is running");
+		return;
+	}
+	m_lane = lane;
+}
+
+/**
+ * Sets the stream ID used when there is no upstream SRI to take one from, by default DEFAULT_SDDS_STREAM_ID. Each
+ * attached stream needs its own when more than one is attached. Cannot be called while the run method is active.
+ */
+void SddsToBulkIOProcessor::setStreamId(std::string stream_id) {
+	if (m_running) {
+		RH_WARN(_log, "Cannot change the stream ID while the processor is running");
+		return;
+	}
+	boost::unique_lock<boost::mutex> lock(m_upstream_sri_lock);
+	m_default_stream_id = stream_id;
+	if (not m_use_upstream_sri) {
+		m_sri.streamID = m_default_stream_id.c_str();
+	}
+	lock.unlock();
+	publishMetrics(true);
+}
+
+/**
+ * Records how long each packet took from being received by the kernel to being taken off the packet buffer and to
+ * being pushed out the BulkIO port, see getDequeueLatency and getPushLatency. The socket reader must be set to time
+ * stamp the packets. Cannot be called while the run method is active.
+ */
+void SddsToBulkIOProcessor::setLatencyTracking(bool track_latency) {
+	if (m_running) {
+		RH_WARN(_log, "Cannot set latency tracking while thread is running");
+		return;
+	}
+	m_track_latency = track_latency;
+}
+
+/**
+ * Returns the latency, in microseconds, between the kernel receiving a packet and the packet being taken off the packet
+ * buffer that fraction (0 to 1) of the packets since the last start were at or below. Zero if nothing was recorded.
+ */
+double SddsToBulkIOProcessor::getDequeueLatency(double fraction) {
+	return m_dequeue_latency.percentile(fraction) / 1e3;
+}
+
+/**
+ * Returns the latency, in microseconds, between the kernel receiving a packet and the packet's data being pushed out
+ * the BulkIO port that fraction (0 to 1) of the packets since the last start were at or below. Zero if nothing was recorded.
+ */
+double SddsToBulkIOProcessor::getPushLatency(double fraction) {
+	return m_push_latency.percentile(fraction) / 1e3;
+}
+
+/**
+ * Sets how often, in milliseconds, the processing thread publishes its status while busy, see getMetrics. It also
+ * publishes whenever it runs out of packets to work. Can be changed while running.
+ */
+void SddsToBulkIOProcessor::setStatusInterval(unsigned int interval_ms) {
+	m_status_interval_ms = interval_ms;
+}
+
+/**
+ * Returns the status last published by the processing thread. Never touches anything the processing thread is working
+ * on so it is safe, and cheap, to call as often as wanted from any thread.
+ */
+processor_metrics_t SddsToBulkIOProcessor::getMetrics() {
+	return m_metrics.read();
+}
+
+/**
+ * Publishes the processor's status once the status interval has passed since the last time, or straight away if idle
+ * is set which is done once everything waiting has been worked so the status is current while nothing is arriving.
+ * Called by the processing thread and, while it is not running, by the setters of anything in the status.
+ */
+void SddsToBulkIOProcessor::publishMetrics(bool idle) {
+	uint64_t now = monotonicNs();
+	if (not idle && now < m_next_publish) {
+		return;
+	}
+	boost::unique_lock<boost::mutex> publish_lock(m_publish_lock);
+	m_next_publish = now + m_status_interval_ms * 1000000ULL;
+
+	static const double fractions[4] = {0.5, 0.99, 0.999, 1.0};
+	processor_metrics_t metrics;
+	metrics.bps = m_bps;
+	{
+		// Both can be replaced from outside the processing thread, see unsetUpstreamSri
+		boost::unique_lock<boost::mutex> lock(m_upstream_sri_lock);
+		strncpy(metrics.stream_id, m_sri.streamID, sizeof(metrics.stream_id) - 1);
+		metrics.stream_id[sizeof(metrics.stream_id) - 1] = '\0';
+		strncpy(metrics.endianness, m_endianness.c_str(), sizeof(metrics.endianness) - 1);
+		metrics.endianness[sizeof(metrics.endianness) - 1] = '\0';
+	}
+	metrics.dropped_packets = m_counters.pkts_dropped;
+	metrics.expected_sequence_number = m_counters.expected_seq_number;
+	metrics.sample_rate = m_current_sample_rate;
+	metrics.time_slips = m_counters.num_time_slips;
+	metrics.buffer_wait_time = m_counters.buffer_wait_ns / 1e9;
+	for (size_t i = 0; i < 4; ++i) {
+		metrics.dequeue_latency[i] = getDequeueLatency(fractions[i]);
+		metrics.push_latency[i] = getPushLatency(fractions[i]);
+	}
+	m_metrics.publish(metrics);
+}
+
+/**
+ * Records the latency of every packet in pkts from index first on against the current time. Packets without a
+ * time stamp are skipped.
+ */
+void SddsToBulkIOProcessor::recordDequeueLatency(const std::deque<SddsPacketPtr> &pkts, size_t first) {
+	if (first >= pkts.size()) {
+		return;
+	}
+
+	uint64_t now = realtimeNs();
+	for (size_t i = first; i < pkts.size(); ++i) {
+		uint64_t received = m_pktbuffer->get_timestamp(pkts[i]);
+		if (received && received <= now) {
+			m_dequeue_latency.record(now - received);
+		}
+	}
 }
 
 /**
@@ -139,28 +301,240 @@ void SddsToBulkIOProcessor::setPushOnTTV(bool push_on_ttv) {
  * used to pull full packets from, processed via the processPackets call, then the processed
  * packets will be recycled. This method does not return until the shutdown method is called.
  */
-void SddsToBulkIOProcessor::run(SmartPacketBuffer<SDDSpacket> *pktbuffer) {
-	m_running = true;
-	m_shuttingDown = false;
+void SddsToBulkIOProcessor::run(SmartPacketBuffer<SDDSheader> *pktbuffer) {
 	pthread_setname_np(pthread_self(), "SddsToBulkIOProcessor");
+	startRun(pktbuffer);
 
-	// Feed in packets to process,
-	// Since these are deques there is no reserve so we can just throw it on the stack.
-	std::deque<SddsPacketPtr> pktsToProcess;
-	std::deque<SddsPacketPtr> pktsToRecycle;
+	// With more than one socket reader each fills its own lane and the lanes are merged back into sequence order
+	const bool merge = (pktbuffer->get_num_lanes() > 1);
 
 	while (not m_shuttingDown) {
 		// We HAVE to recycle this buffer.
-		pktbuffer->pop_full_buffers(pktsToProcess, m_pkts_per_read);
+		size_t already_queued = m_pkts_to_process.size();
+		uint64_t wait_start = monotonicNs();
+		if (merge) {
+			popMergedBuffers(pktbuffer, m_pkts_to_process);
+		} else {
+			pktbuffer->pop_full_buffers(m_pkts_to_process, m_pkts_per_read);
+		}
+		m_counters.buffer_wait_ns += monotonicNs() - wait_start;
+		if (m_track_latency) {
+			recordDequeueLatency(m_pkts_to_process, already_queued);
+		}
 		if (not m_shuttingDown) {
-			processPackets(pktsToProcess, pktsToRecycle);
+			processPackets(m_pkts_to_process, m_pkts_to_recycle);
+
+			// Anything still pointing into the payload block has to go out before the packets are recycled
+			pushPayloadRun();
 		}
 
-		pktbuffer->recycle_buffers(pktsToRecycle);
+		pktbuffer->recycle_buffers(m_pkts_to_recycle);
+		publishMetrics(m_pkts_to_process.empty() && pktbuffer->get_num_full_buffers() < m_pkts_per_read);
 	}
 
+	finishRun();
+}
+
+/**
+ * The entry point to the processing thread when more than one stream is attached. Each processor works the packets of
+ * its own lane of the shared packet buffer, see setLane, and pushes them out on its own BulkIO stream. A single thread
+ * goes round the processors of the set working whatever each lane has waiting and backs off once none of them had
+ * anything. Processors added to or removed from the set are started or finished at the top of the next pass, see
+ * updateProcessors. This method does not return until the set's shutDown method is called.
+ */
+void SddsToBulkIOProcessor::runStreams(SddsToBulkIOProcessorSet *set, SmartPacketBuffer<SDDSheader> *pktbuffer) {
+	pthread_setname_np(pthread_self(), "SddsToBulkIOProcessor");
+	std::vector<SddsToBulkIOProcessor*> processors;
+	boost::unique_lock<boost::mutex> lock(set->m_lock);
+	set->m_running = true;
+	set->m_changed = true;
+	lock.unlock();
+
+	unsigned int attempt = 0;
+	while (not set->m_shuttingDown) {
+		if (set->m_changed) {
+			updateProcessors(set, processors, pktbuffer);
+		}
 
+		bool worked = false;
+		for (size_t i = 0; i < processors.size(); ++i) {
+			if (processors[i] && processors[i]->processLane()) {
+				worked = true;
+			}
+		}
+
+		if (worked) {
+			attempt = 0;
+		} else if (not set->m_shuttingDown) {
+			// Every lane was empty so every processor was waiting for the whole back off
+			uint64_t wait_start = monotonicNs();
+			SpscRing<SddsPacketPtr>::backoff(attempt);
+			uint64_t waited = monotonicNs() - wait_start;
+			for (size_t i = 0; i < processors.size(); ++i) {
+				if (processors[i]) {
+					processors[i]->m_counters.buffer_wait_ns += waited;
+				}
+			}
+		}
+	}
+
+	lock.lock();
+	for (size_t i = 0; i < processors.size(); ++i) {
+		if (processors[i]) {
+			processors[i]->finishRun();
+		}
+	}
+	set->m_running = false;
+	lock.unlock();
+	set->m_updated.notify_all();
+}
+
+/**
+ * Brings the processors runStreams is working up to date with the set. A removed processor first works whatever the
+ * socket reader left in its lane before letting go of it, then pushes out what it holds and closes its stream. An
+ * added one is started. Anyone waiting in SddsToBulkIOProcessorSet::remove is then woken.
+ */
+void SddsToBulkIOProcessor::updateProcessors(SddsToBulkIOProcessorSet *set, std::vector<SddsToBulkIOProcessor*> &processors, SmartPacketBuffer<SDDSheader> *pktbuffer) {
+	boost::unique_lock<boost::mutex> lock(set->m_lock);
+	processors.resize(set->m_processors.size(), NULL);
+	for (size_t lane = 0; lane < processors.size(); ++lane) {
+		if (processors[lane] == set->m_processors[lane]) {
+			continue;
+		}
+
+		if (processors[lane]) {
+			processors[lane]->processLane();
+			processors[lane]->finishRun();
+		}
+		processors[lane] = set->m_processors[lane];
+		if (processors[lane]) {
+			processors[lane]->startRun(pktbuffer);
+		}
+	}
+
+	set->m_changed = false;
+	set->m_applied = set->m_requested;
+	lock.unlock();
+	set->m_updated.notify_all();
+}
+
+SddsToBulkIOProcessorSet::SddsToBulkIOProcessorSet(): m_changed(false), m_shuttingDown(false), m_running(false),
+	m_requested(0), m_applied(0) {}
+
+/**
+ * Empties the set and makes room for a processor on each of num_lanes lanes. Must not be called while runStreams is
+ * working the set.
+ */
+void SddsToBulkIOProcessorSet::assign(size_t num_lanes) {
+	boost::unique_lock<boost::mutex> lock(m_lock);
+	m_processors.assign(num_lanes, NULL);
+	m_changed = false;
+	m_shuttingDown = false;
+}
+
+/**
+ * Adds a processor, which must already be set up to work the given lane, to the set. runStreams, if it is working the
+ * set, starts it on its next pass. The set does not take ownership of the processor.
+ */
+void SddsToBulkIOProcessorSet::add(size_t lane, SddsToBulkIOProcessor *processor) {
+	boost::unique_lock<boost::mutex> lock(m_lock);
+	if (lane >= m_processors.size()) {
+		m_processors.resize(lane + 1, NULL);
+	}
+	m_processors[lane] = processor;
+	m_changed = true;
+	++m_requested;
+}
+
+/**
+ * Removes the processor of the given lane from the set. If runStreams is working the set this waits for it to finish
+ * the processor, after which the processor may be deleted and, once the socket reader has let go of it too, the lane
+ * reset.
+ */
+void SddsToBulkIOProcessorSet::remove(size_t lane) {
+	boost::unique_lock<boost::mutex> lock(m_lock);
+	if (lane >= m_processors.size()) {
+		return;
+	}
+	m_processors[lane] = NULL;
+	m_changed = true;
+	uint64_t request = ++m_requested;
+	while (m_running && m_applied < request) {
+		m_updated.wait(lock);
+	}
+}
+
+/**
+ * Makes runStreams finish every processor in the set and return.
+ */
+void SddsToBulkIOProcessorSet::shutDown() {
+	m_shuttingDown = true;
+}
+
+/**
+ * Resets the per run state at the start of a processing thread, see run and runStreams.
+ */
+void SddsToBulkIOProcessor::startRun(SmartPacketBuffer<SDDSheader> *pktbuffer) {
+	m_running = true;
+	m_shuttingDown = false;
+
+	// If the payloads were received into their own contiguous block we can push them straight out of it
+	m_pktbuffer = pktbuffer;
+	m_zero_copy = pktbuffer->is_split_payload();
+	m_run_pkts = 0;
+	m_run_received.clear();
+	m_run_received.reserve(m_pkts_per_read);
+
+	// Swapped payloads are written around the cache if a whole push would not fit in it anyway
+	long cache_size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+	if (cache_size <= 0) {
+		cache_size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+	}
+	m_swap_non_temporal = (cache_size > 0 && m_pkts_per_read * SDDS_DATA_SIZE > (size_t) cache_size);
+	if (m_swap_buffer) {
+		m_swap_pool->release(m_swap_buffer);
+		m_swap_buffer = NULL;
+	}
+	if (not m_swap_pool || m_swap_pool->getBufferSize() != m_pkts_per_read * SDDS_DATA_SIZE) {
+		m_swap_pool.reset(new SwapBufferPool(m_pkts_per_read * SDDS_DATA_SIZE, SWAP_POOL_MAX_FREE));
+	}
+	m_dequeue_latency.reset();
+	m_push_latency.reset();
+
+	m_lane_pending.assign(pktbuffer->get_num_lanes(), std::deque<SddsPacketPtr>());
+	m_merge_started = false;
+	m_merge_hold_start = 0;
+	m_counters.buffer_wait_ns = 0;
+	publishMetrics(true);
+}
+
+/**
+ * Works every packet currently waiting in this processor's lane, along with any packet processPackets left to be
+ * worked again, without blocking. Returns false if there was nothing to work.
+ */
+bool SddsToBulkIOProcessor::processLane() {
+	size_t already_queued = m_pkts_to_process.size();
+	if (not m_pktbuffer->try_pop_full_buffers(m_pkts_to_process, m_lane) && not already_queued) {
+		return false;
+	}
+
+	if (m_track_latency) {
+		recordDequeueLatency(m_pkts_to_process, already_queued);
+	}
+	processPackets(m_pkts_to_process, m_pkts_to_recycle);
+	pushPayloadRun();
+	m_pktbuffer->recycle_buffers(m_pkts_to_recycle);
+	publishMetrics(m_pkts_to_process.empty());
+	return true;
+}
+
+/**
+ * Pushes out anything left, closes the output streams and recycles every packet still held at the end of a
+ * processing thread, see run and runStreams.
+ */
+void SddsToBulkIOProcessor::finishRun() {
 	// Flush out any remaining data and close the streams
+	pushPayloadRun();
 	if (octetStream)
 		octetStream.close();
 	if (shortStream)
@@ -170,8 +544,13 @@ void SddsToBulkIOProcessor::run(SmartPacketBuffer<SDDSpacket> *pktbuffer) {
 
 
 	// Shutting down, recycle all the packets
-	pktbuffer->recycle_buffers(pktsToProcess);
-	pktbuffer->recycle_buffers(pktsToRecycle);
+	m_pktbuffer->recycle_buffers(m_pkts_to_process);
+	m_pktbuffer->recycle_buffers(m_pkts_to_recycle);
+	for (size_t lane = 0; lane < m_lane_pending.size(); ++lane) {
+		m_pktbuffer->recycle_buffers(m_lane_pending[lane]);
+	}
+
+	publishMetrics(true);
 
 	// Reseting flags for next time the run command is called.
 	m_running = false;
@@ -180,6 +559,84 @@ void SddsToBulkIOProcessor::run(SmartPacketBuffer<SDDSpacket> *pktbuffer) {
 	RH_DEBUG(_log, "Reseting first-packet and non-conforming flag in SDDSTOBULKIO Processor.")
 }
 
+/**
+ * Fills pktsToWork with up to m_pkts_per_read packets merged from every lane of the packet buffer in sequence number
+ * order. Each socket reader receives packets in order but the packets of a stream may be split across the readers, so
+ * the next packet is always the lane head that comes soonest after the last packet handed out. Packets are only handed
+ * out while every lane has one waiting, otherwise we cannot know an earlier packet is not about to arrive on the empty
+ * lane, or once m_pkts_per_read packets are waiting so that a lane that receives nothing (a single flow is always read
+ * by the same reader) cannot stall the others. Packets held back waiting on an empty lane are handed out anyway, lowest
+ * sequence number first, once they have been held for MERGE_HOLD_TIMEOUT_NS (1ms), so the tail of a burst is not held
+ * until more traffic arrives; with a lane that never receives anything this adds up to 1ms, plus one backoff step, of
+ * latency to every push smaller than m_pkts_per_read. Any gap, or a packet that turns up on the empty lane after the
+ * packets that follow it were handed out, is then picked up by the usual sequence number check.
+ * Blocks, spinning then backing off, until there is at least one packet or we are shutting down.
+ */
+void SddsToBulkIOProcessor::popMergedBuffers(SmartPacketBuffer<SDDSheader> *pktbuffer, std::deque<SddsPacketPtr> &pktsToWork) {
+	const size_t num_lanes = m_lane_pending.size();
+	unsigned int attempt = 0;
+
+	while (not m_shuttingDown) {
+		size_t pending = 0;
+		for (size_t lane = 0; lane < num_lanes; ++lane) {
+			pktbuffer->try_pop_full_buffers(m_lane_pending[lane], lane);
+			pending += m_lane_pending[lane].size();
+		}
+		const bool held_too_long = (m_merge_hold_start && monotonicNs() - m_merge_hold_start >= MERGE_HOLD_TIMEOUT_NS);
+
+		while (pending && pktsToWork.size() < m_pkts_per_read) {
+			size_t next = num_lanes;
+			bool all_waiting = true;
+			uint16_t next_distance = 0;
+
+			for (size_t lane = 0; lane < num_lanes; ++lane) {
+				if (m_lane_pending[lane].empty()) {
+					all_waiting = false;
+					continue;
+				}
+
+				// Start half the sequence space behind the first packet we see so either side of it sorts correctly
+				uint16_t seq = m_lane_pending[lane].front()->get_seq();
+				if (not m_merge_started) {
+					m_merge_seq = seq - 0x8000;
+					m_merge_started = true;
+				}
+
+				uint16_t distance = seq - m_merge_seq;
+				if (next == num_lanes || distance < next_distance) {
+					next = lane;
+					next_distance = distance;
+				}
+			}
+
+			if (not all_waiting && pending < m_pkts_per_read && not held_too_long) {
+				break;
+			}
+
+			SddsPacketPtr pkt = m_lane_pending[next].front();
+			m_lane_pending[next].pop_front();
+			m_merge_seq = pkt->get_seq();
+			pktsToWork.push_back(pkt);
+			--pending;
+		}
+
+		// Time how long packets have been held back waiting on an empty lane
+		if (pending && pktsToWork.size() < m_pkts_per_read) {
+			if (not m_merge_hold_start) {
+				m_merge_hold_start = monotonicNs();
+			}
+		} else {
+			m_merge_hold_start = 0;
+		}
+
+		if (not pktsToWork.empty()) {
+			return;
+		}
+
+		SpscRing<SddsPacketPtr>::backoff(attempt);
+	}
+}
+
 /**
  * Calculates the expected xdelta based on the provided rate, complex flag, and current m_bps.
  * The member variables max, ideal, and min time steps are updated which are used to deteremine
@@ -209,26 +666,27 @@ void SddsToBulkIOProcessor::updateExpectedXdelta(double rate, bool complex) {
  * Increments the expected sequence number if true.
  * If the packet does not match the expected, we calculate packets dropped and reset first packet
  */
-bool SddsToBulkIOProcessor::orderIsValid(SddsPacketPtr &pkt) {
+bool SddsToBulkIOProcessor::orderIsValid(SddsPacketPtr pkt) {
 
 	// First packet, its valid.
 	if (m_first_packet) {
 		m_first_packet = false;
 		m_current_ttv_flag = pkt->get_ttv();
-		m_expected_seq_number = pkt->get_seq();
+		m_counters.expected_seq_number = pkt->get_seq();
 		m_bps = (pkt->bps == 31) ? 32 : pkt->bps;
 		m_last_sdds_time = 0;
+		selectPacketKernel();
 
 		updateExpectedXdelta(m_non_conforming_device ? pkt->get_rate() * 2 : pkt->get_rate(), pkt->cx != 0);
 		return true;
 	}
 
 	// If it doesn't match what we're expecting then it's not valid.
-	if (m_expected_seq_number != pkt->get_seq()) {
+	if (m_counters.expected_seq_number != pkt->get_seq()) {
 		// No need to worry about the wrap around, if everything is uint16_t twos compliment takes care of it all for us.
-		uint16_t numDropped = pkt->get_seq() - m_expected_seq_number;
-		RH_WARN(_log, "Expected packet " << m_expected_seq_number << " Received: " << pkt->get_seq() << " Dropped: " << numDropped);
-		m_pkts_dropped += numDropped;
+		uint16_t numDropped = pkt->get_seq() - m_counters.expected_seq_number;
+		RH_WARN(_log, "Expected packet " << m_counters.expected_seq_number << " Received: " << pkt->get_seq() << " Dropped: " << numDropped);
+		m_counters.pkts_dropped += numDropped;
 		m_first_packet = true;
 		return false;
 	}
@@ -242,19 +700,21 @@ bool SddsToBulkIOProcessor::orderIsValid(SddsPacketPtr &pkt) {
  * calculating the accumulated time slip. See the documentation for details.
  * There is also a check, and adjustments for poorly behaving devices which may not abide by the SDDS standard (such as the MSDD)
  * see the note below for details.
+ * Returns true only if the packet carries on from the last one with the expected time step, see updateTimeStamp.
  */
-void SddsToBulkIOProcessor::checkForTimeSlip(SddsPacketPtr &pkt) {
+bool SddsToBulkIOProcessor::checkForTimeSlip(SddsPacketPtr pkt) {
 	// If time tag is not valid no need to check for time slips.
 	bool slip = false;
+	bool contiguous = true;
 
 	if (not pkt->get_ttv()) {
-		return;
+		return false;
 	}
 
 	// This magically works. :-) (operator overloading)
 	if (m_last_sdds_time == 0) {
 		m_last_sdds_time = pkt->get_SDDSTime();
-		return;
+		return false;
 	}
 
 	SDDSTime curr_time = pkt->get_SDDSTime();
@@ -265,14 +725,15 @@ void SddsToBulkIOProcessor::checkForTimeSlip(SddsPacketPtr &pkt) {
 	if (deltaTime < 0) {
 		RH_INFO(_log, "Received a negative delta between packet time stamps, time is either going backwards or the year has rolled over");
 		m_last_sdds_time = curr_time;
-		return;
+		return false;
 	}
 
 	if (deltaTime > m_max_time_step || deltaTime < m_min_time_step) {
+		contiguous = false;
 		// XXX Special case here! Some devices, like the MSDD do not conform to the SDDS standard and the header contains a bad sample rate
 		// the sample rate is off by a factor of two which we detect here based on the xdelta and account for with the m_non_conforming_device boolean.
-		// we also check m_num_time_slips just in case we have a device that is slipping a lot and happens to fall into this position.
-		if (!m_non_conforming_device && pkt->cx != 0 && m_num_time_slips == 0 && 2*deltaTime < m_max_time_step && 2*deltaTime > m_min_time_step) {
+		// we also check m_counters.num_time_slips just in case we have a device that is slipping a lot and happens to fall into this position.
+		if (!m_non_conforming_device && pkt->cx != 0 && m_counters.num_time_slips == 0 && 2*deltaTime < m_max_time_step && 2*deltaTime > m_min_time_step) {
 			RH_INFO(_log, "Based on the received XDelta between packets, it appears that these SDDS packets do not conform to the spec. "
 						   "This is a known issue for some devices (eg. MSDD) where the sample rate in the header is off by a factor of two. "
 						   "The expected XDelta has been adjusted, this will also be reflected in the output SRI unless overridden via SRI Keywords, if the SRI is not overridden it will result in a single erroneous SRI push");
@@ -293,7 +754,31 @@ void SddsToBulkIOProcessor::checkForTimeSlip(SddsPacketPtr &pkt) {
 	}
 
 	if(slip) {
-		m_num_time_slips++;
+		m_counters.num_time_slips++;
+	}
+
+	return contiguous && not slip;
+}
+
+/**
+ * Sets m_bulkio_time_stamp for the packet about to be written, which is the first of a run, see scanRun. Working the
+ * time stamp out from the packet's time tag is costly, so it is only done when checkForTimeSlip finds the packet does
+ * not carry on from the last one. Otherwise the time stamp is the time stamp of the packet that started the contiguous
+ * stretch moved on by the ideal time step for every packet written since, see m_pkts_since_anchor. Any drift from the
+ * time tags is bounded by the time slip accumulator, which ends the stretch once it is exceeded.
+ */
+void SddsToBulkIOProcessor::updateTimeStamp(SddsPacketPtr pkt) {
+	const SDDSTime last_sdds_time = m_last_sdds_time;
+	if (checkForTimeSlip(pkt)) {
+		m_bulkio_time_stamp = m_time_anchor;
+		m_bulkio_time_stamp.tfsec += m_pkts_since_anchor * m_ideal_time_step;
+		const double whole = floor(m_bulkio_time_stamp.tfsec);
+		m_bulkio_time_stamp.twsec += whole;
+		m_bulkio_time_stamp.tfsec -= whole;
+	} else {
+		m_bulkio_time_stamp = getBulkIOTimeStamp(pkt, last_sdds_time, m_start_of_year, _log);
+		m_time_anchor = m_bulkio_time_stamp;
+		m_pkts_since_anchor = 0;
 	}
 }
 /**
@@ -302,6 +787,52 @@ void SddsToBulkIOProcessor::checkForTimeSlip(SddsPacketPtr &pkt) {
  * a TTV we can recycle what we've used and get a refill on pktsToWork to bring it back up to size.
  */
 void SddsToBulkIOProcessor::processPackets(std::deque<SddsPacketPtr> &pktsToWork, std::deque<SddsPacketPtr> &pktsToRecycle) {
+	while ((this->*m_packet_kernel)(pktsToWork, pktsToRecycle)) {}
+}
+
+/**
+ * Picks the instance of processPacketsAs matching the current bits per sample, endianness and TTV settings. Only
+ * called when one of them changes: when they are set, when the first packet gives the bits per sample, see
+ * orderIsValid, and when upstream SRI is merged or unset, see processPacketsAs, rather than on every batch.
+ */
+void SddsToBulkIOProcessor::selectPacketKernel() {
+	const bool swap = (atol(m_endianness.c_str()) != __BYTE_ORDER);
+	switch (m_bps) {
+	case 8:
+		m_packet_kernel = packetKernel<8, false>();
+		break;
+	case 16:
+		m_packet_kernel = (swap) ? packetKernel<16, true>() : packetKernel<16, false>();
+		break;
+	case 32:
+		m_packet_kernel = (swap) ? packetKernel<32, true>() : packetKernel<32, false>();
+		break;
+	default:
+		m_packet_kernel = packetKernel<0, false>();
+		break;
+	}
+}
+
+/**
+ * Returns the instance of processPacketsAs for BPS and SWAP matching the TTV settings.
+ */
+template <unsigned short BPS, bool SWAP>
+SddsToBulkIOProcessor::PacketKernel SddsToBulkIOProcessor::packetKernel() {
+	if (m_wait_for_ttv) {
+		return (m_push_on_ttv) ? &SddsToBulkIOProcessor::processPacketsAs<BPS, SWAP, true, true> : &SddsToBulkIOProcessor::processPacketsAs<BPS, SWAP, true, false>;
+	}
+	return (m_push_on_ttv) ? &SddsToBulkIOProcessor::processPacketsAs<BPS, SWAP, false, true> : &SddsToBulkIOProcessor::processPacketsAs<BPS, SWAP, false, false>;
+}
+
+/**
+ * The body of processPackets, built once for every combination of bits per sample (0 for anything unsupported),
+ * whether the payload needs byte swapping and the TTV settings, so the per packet work carries none of those checks.
+ * Returns true, leaving the packet it was on at the front of pktsToWork, if it finds it is no longer the kernel for
+ * the stream (the first packet set the bits per sample or the upstream SRI changed the endianness) so that
+ * processPackets can hand the rest of the packets to the new one.
+ */
+template <unsigned short BPS, bool SWAP, bool WAIT_FOR_TTV, bool PUSH_ON_TTV>
+bool SddsToBulkIOProcessor::processPacketsAs(std::deque<SddsPacketPtr> &pktsToWork, std::deque<SddsPacketPtr> &pktsToRecycle) {
 	std::deque<SddsPacketPtr>::iterator pkt_it = pktsToWork.begin();
 	while (pkt_it != pktsToWork.end()) {
 		SddsPacketPtr pkt = *pkt_it;
@@ -309,39 +840,27 @@ void SddsToBulkIOProcessor::processPackets(std::deque<SddsPacketPtr> &pktsToWork
 		// The user may have requested we not push when the timecode is invalid. If this is the case we just need to recycle
 		// the buffers that don't have good ttv's and continue with the next packet hoping the ttv is true.
 
-		if (m_wait_for_ttv && (pkt->get_ttv() == 0)) {
+		if (WAIT_FOR_TTV && (pkt->get_ttv() == 0)) {
 			pktsToRecycle.push_back(pkt);
 			pkt_it = pktsToWork.erase(pkt_it);
-			if (octetStream) {
-				octetStream.flush();
-				shortStream.flush();
-				floatStream.flush();
-			}
+			flushStreams();
 			continue;
 		}
 
 		// If the order is not valid we've lost some packets, we need to push what we have, reset the SRI.
 		if (!orderIsValid(pkt)) {
-			if (octetStream) {
-				octetStream.flush();
-				shortStream.flush();
-				floatStream.flush();
-			}
+			flushStreams();
 			m_first_packet = true;
-			return;
+			return false;
 		} else {
 
 			// If the current ttv flag does not match this packets, there has been a state change.
 			// This only matters if the user has requested we push on ttv.
 			// If this is the case we need to push and restart with the new ttv state.
-			if (m_push_on_ttv && m_current_ttv_flag != (pkt->get_ttv() != 0) ) {
+			if (PUSH_ON_TTV && m_current_ttv_flag != (pkt->get_ttv() != 0) ) {
 				m_current_ttv_flag = (pkt->get_ttv() != 0);
-				if (octetStream) {
-					octetStream.flush();
-					shortStream.flush();
-					floatStream.flush();
-				}
-				return;
+				flushStreams();
+				return false;
 			}
 
 			// At this point we should have a good packet and have dealt with any specific user requests regarding the ttv field.
@@ -353,19 +872,23 @@ void SddsToBulkIOProcessor::processPackets(std::deque<SddsPacketPtr> &pktsToWork
 
 			{
 				boost::unique_lock<boost::mutex> lock(m_upstream_sri_lock);
-				if (m_upstream_sri_set && m_new_upstream_sri) {
+				if (m_new_upstream_sri) {
 					m_new_upstream_sri = false;
-					mergeUpstreamSRI(m_sri, m_upstream_sri, m_use_upstream_sri, sriChanged,streamIDChanged, m_endianness, _log);
-					// If it is a new Stream ID then we need to create new BULKIO Streams
-					if (streamIDChanged) {
-						createOutputStreams();
+					if (m_upstream_sri_set) {
+						mergeUpstreamSRI(m_sri, m_upstream_sri, m_use_upstream_sri, sriChanged,streamIDChanged, m_endianness, _log);
+						// If it is a new Stream ID then we need to create new BULKIO Streams
+						if (streamIDChanged) {
+							createOutputStreams();
 
+						}
 					}
+					// The endianness may have changed, or gone back to the default if the upstream SRI was unset
+					selectPacketKernel();
 				}
 			}
 
 			if (!m_use_upstream_sri) {
-				mergeSddsSRI(pkt.get(), m_sri, sriChanged, m_non_conforming_device);
+				mergeSddsSRI(pkt, m_sri, sriChanged, m_non_conforming_device);
 			}
 
 			// If streams have not been create then create them.
@@ -377,75 +900,156 @@ void SddsToBulkIOProcessor::processPackets(std::deque<SddsPacketPtr> &pktsToWork
 
 				updateExpectedXdelta(m_non_conforming_device ? pkt->get_rate() * 2 : pkt->get_rate(), pkt->cx != 0);
 				m_last_sdds_time = 0;
-				return; // Refill our packets
+				return false; // Refill our packets
 			}
 
-			// Create the bulkIO time stamp if this is the first packet to send.
-			//if (m_bulkIO_data.size() == 0) {
-			//	m_bulkio_time_stamp = getBulkIOTimeStamp(pkt.get(), m_last_sdds_time, m_start_of_year);
-			//}
-
-			m_bulkio_time_stamp = getBulkIOTimeStamp(pkt.get(), m_last_sdds_time, m_start_of_year, _log);
+			// Everything above is safe to repeat for this packet in the new kernel
+			if (m_packet_kernel != &SddsToBulkIOProcessor::processPacketsAs<BPS, SWAP, WAIT_FOR_TTV, PUSH_ON_TTV>) {
+				return true;
+			}
 
-			// Check for time slips
-			checkForTimeSlip(pkt);
+			// Check for time slips and create the bulkIO time stamp
+			updateTimeStamp(pkt);
 
-			// Grab data from packet and write it to BULKIO stream. Based on the type of data in the packet write it to the correct stream type.
-			switch(m_bps) {
-			case 8: {
-		        octetStream.write(&pkt->d[0],1024,m_bulkio_time_stamp);
-				break;
-			}
-			case 16: {
-				// We need to byte swap. At least there is a nice builtin for swapping bytes for shorts.
-				if (atol(m_endianness.c_str()) != __BYTE_ORDER) {
-					swab(&pkt->d[0], &pkt->d[0], 1024);
-				}
+			// Everything up to here only has to be done for the first packet of a run, the rest of the run is found by a pass
+			// over the packet headers alone and written out along with it.
+			const size_t run_pkts = scanRun(pkt_it, pktsToWork.end());
 
-				shortStream.write((short*)&pkt->d[0],512,m_bulkio_time_stamp);
-				break;
-			}
-			case 32: {
-				// We need to byte swap and for floats there is no nice method for us to use like there is for shorts. Time to iterate.
-				if (atol(m_endianness.c_str()) != __BYTE_ORDER) {
-					uint32_t *buf = reinterpret_cast<uint32_t*>(&pkt->d[0]);
-					for (size_t i = 0; i < 1024 / sizeof(float); ++i) {
-						buf[i] = __builtin_bswap32(buf[i]);
+			// Grab data from the packets and write it to BULKIO stream. Based on the type of data in the packets write it to the correct stream type.
+			// If the payloads are contiguous they are collected into a payload run and pushed together, otherwise they are gathered, see writeGathered.
+			// Byte swapping is done on the way into the buffer that gets pushed, in one pass, see addToSwapRun
+			if (BPS != 8 && BPS != 16 && BPS != 32) {
+				RH_ERROR(_log, "Could not push packet, the bits per sample are non-standard and set to: " << m_bps);
+			} else if (SWAP || m_zero_copy) {
+				std::deque<SddsPacketPtr>::iterator it = pkt_it;
+				for (size_t i = 0; i < run_pkts; ++i, ++it) {
+					uint8_t *payload = m_pktbuffer->get_payload(*it);
+					const uint64_t received = (m_track_latency) ? m_pktbuffer->get_timestamp(*it) : 0;
+					if (SWAP) {
+						addToSwapRun(payload, received);
+					} else {
+						addToPayloadRun(payload, received);
 					}
 				}
+			} else {
+				writeGathered(pkt_it, run_pkts);
+			}
+			m_pkts_since_anchor += run_pkts;
 
-				floatStream.write((float*)&pkt->d[0],256,m_bulkio_time_stamp);
-				break;
+			// And we are done with these packets. Take them off the pktsToWork que and add them to the pktsToRecycle que.
+			for (size_t i = 0; i < run_pkts; ++i) {
+				pktsToRecycle.push_back(*pkt_it);
+				pkt_it = pktsToWork.erase(pkt_it);
+
+				// Now that we are officially done with the packet we can increment our packet counter
+				m_counters.expected_seq_number++;
+
+				// Adjust for the CRC packet
+				if (m_counters.expected_seq_number != 0 && m_counters.expected_seq_number % 32 == 31)
+					m_counters.expected_seq_number++;
 			}
-			default:{
-				RH_ERROR(_log, "Could not push packet, the bits per sample are non-standard and set to: " << m_bps);
+
+		}
+	}
+	return false;
+}
+
+/**
+ * Returns how many packets, starting with first which has just been worked in full, make up a run that can be written
+ * out along with it. A run has consecutive sequence numbers and the same TTV, rate, complex flag and bits per sample
+ * throughout, so no packet in it would change the SRI or the TTV state, and time steps that checkForTimeSlip would not
+ * count as a slip. Only the headers are looked at. The time slip state is moved on to the last packet of the run as if
+ * each packet had been checked, whatever packet ended the run is then worked in full. At most m_pkts_per_read packets.
+ */
+size_t SddsToBulkIOProcessor::scanRun(std::deque<SddsPacketPtr>::iterator first, std::deque<SddsPacketPtr>::iterator end) {
+	SddsPacketPtr head = *first;
+	const bool ttv = (head->get_ttv() != 0);
+	uint16_t expected_seq = head->get_seq();
+	SDDSTime last_time = m_last_sdds_time;
+	double time_error_accum = m_time_error_accum;
+
+	size_t run_pkts = 1;
+	for (std::deque<SddsPacketPtr>::iterator it = first + 1; it != end && run_pkts < m_pkts_per_read; ++it) {
+		SddsPacketPtr pkt = *it;
+		expected_seq++;
+		if (expected_seq != 0 && expected_seq % 32 == 31)
+			expected_seq++;
+
+		if (pkt->get_seq() != expected_seq || (pkt->get_ttv() != 0) != ttv || pkt->freq != head->freq || pkt->cx != head->cx || pkt->bps != head->bps) {
+			break;
+		}
+
+		if (ttv) {
+			SDDSTime curr_time = pkt->get_SDDSTime();
+			double deltaTime = curr_time.seconds() - last_time.seconds();
+			double accum = time_error_accum + deltaTime - m_ideal_time_step;
+			if (deltaTime > m_max_time_step || deltaTime < m_min_time_step || std::abs(accum) > m_accum_error_tolerance) {
 				break;
 			}
-			}
-
+			last_time = curr_time;
+			time_error_accum = accum;
+		}
 
+		run_pkts++;
+	}
 
-			// And we are done with this packet. Take it off the pktsToWork que and add it to the pktsToRecycle que.
-			pktsToRecycle.push_back(pkt);
-			pkt_it = pktsToWork.erase(pkt_it);
+	m_last_sdds_time = last_time;
+	m_time_error_accum = time_error_accum;
+	return run_pkts;
+}
 
-			// Now that we are officially done with the packet we can increment our packet counter
-			m_expected_seq_number++;
+/**
+ * Writes the payloads of a run of count packets starting at first, see scanRun, to the output stream matching m_bps
+ * with a single write stamped with the time of the first packet. The payloads are not back to back in memory so unless
+ * there is only the one they are gathered into m_bulkIO_data first.
+ */
+void SddsToBulkIOProcessor::writeGathered(std::deque<SddsPacketPtr>::iterator first, size_t count) {
+	uint8_t *data = m_pktbuffer->get_payload(*first);
+	const size_t num_bytes = count * SDDS_DATA_SIZE;
+	if (count > 1) {
+		m_bulkIO_data.resize(num_bytes);
+		std::deque<SddsPacketPtr>::iterator it = first;
+		for (size_t i = 0; i < count; ++i, ++it) {
+			memcpy(&m_bulkIO_data[i * SDDS_DATA_SIZE], m_pktbuffer->get_payload(*it), SDDS_DATA_SIZE);
+		}
+		data = &m_bulkIO_data[0];
+	}
 
-			// Adjust for the CRC packet
-			if (m_expected_seq_number != 0 && m_expected_seq_number % 32 == 31)
-				m_expected_seq_number++;
+	switch(m_bps) {
+	case 8:
+		octetStream.write(data, num_bytes, m_bulkio_time_stamp);
+		break;
+	case 16:
+		shortStream.write((short*)data, num_bytes / sizeof(short), m_bulkio_time_stamp);
+		break;
+	case 32:
+		floatStream.write((float*)data, num_bytes / sizeof(float), m_bulkio_time_stamp);
+		break;
+	default:
+		RH_ERROR(_log, "Could not write packets, the bits per sample are non-standard and set to: " << m_bps);
+		break;
+	}
 
+	// Written straight out, a payload run records its packets when it is pushed
+	if (m_track_latency) {
+		uint64_t now = realtimeNs();
+		std::deque<SddsPacketPtr>::iterator it = first;
+		for (size_t i = 0; i < count; ++i, ++it) {
+			uint64_t received = m_pktbuffer->get_timestamp(*it);
+			if (received && received <= now) {
+				m_push_latency.record(now - received);
+			}
 		}
 	}
 }
 
-
 /**
  * Pushes the current SRI to the appropriate port based on m_bps.
  */
 void SddsToBulkIOProcessor::pushSri() {
 	RH_DEBUG(_log, "Pushing SRI");
+	// Data already collected belongs to the old SRI
+	pushPayloadRun();
 	switch(m_bps) {
 	case 8:
 		octetStream.sri(m_sri);
@@ -464,6 +1068,7 @@ void SddsToBulkIOProcessor::pushSri() {
 }
 
 void SddsToBulkIOProcessor::createOutputStreams() {
+	pushPayloadRun();
 
 	if (octetStream)
 		octetStream.close();
@@ -476,9 +1081,148 @@ void SddsToBulkIOProcessor::createOutputStreams() {
 	shortStream = m_short_out->createStream(m_sri);
 	floatStream = m_float_out->createStream(m_sri);
 
-	octetStream.setBufferSize(m_pkts_per_read*1024);
-	shortStream.setBufferSize(m_pkts_per_read*1024/2);
-	floatStream.setBufferSize(m_pkts_per_read*1024/4);
+	// When pushing payload runs the processor does its own batching, anything buffered by the stream would be a copy.
+	if (m_zero_copy) {
+		octetStream.setBufferSize(0);
+		shortStream.setBufferSize(0);
+		floatStream.setBufferSize(0);
+	} else {
+		octetStream.setBufferSize(m_pkts_per_read*1024);
+		shortStream.setBufferSize(m_pkts_per_read*1024/2);
+		floatStream.setBufferSize(m_pkts_per_read*1024/4);
+	}
+}
+
+/**
+ * Pushes any pending payload run and then flushes whatever data the output streams have buffered.
+ */
+void SddsToBulkIOProcessor::flushStreams() {
+	pushPayloadRun();
+	if (octetStream) {
+		octetStream.flush();
+		shortStream.flush();
+		floatStream.flush();
+	}
+}
+
+/**
+ * Adds the payload of the packet currently being processed to the payload run. A run is a set of payloads that
+ * are back to back in memory, if this payload does not directly follow the run or the run has already reached
+ * the number of packets per push, the current run is pushed first and a new run is started with this payload.
+ * The time stamp of the run is the time stamp of its first packet. A non-zero received time is kept so the packet's
+ * push latency can be recorded once the run goes out.
+ */
+void SddsToBulkIOProcessor::addToPayloadRun(uint8_t *payload, uint64_t received) {
+	if (m_run_pkts != 0 && (m_run_swapped || payload != m_run_start + m_run_pkts * SDDS_DATA_SIZE || m_run_pkts >= m_pkts_per_read)) {
+		pushPayloadRun();
+	}
+
+	if (received) {
+		m_run_received.push_back(received);
+	}
+
+	if (m_run_pkts == 0) {
+		m_run_start = payload;
+		m_run_swapped = false;
+		m_run_time_stamp = m_bulkio_time_stamp;
+	}
+
+	m_run_pkts++;
+}
+
+/**
+ * Byte swaps the payload of the packet currently being processed into the next slot of the swap buffer, which is
+ * then pushed as a payload run. Swapping in place and letting the stream copy the payload would take two passes over
+ * it, this takes one and the stream takes the buffer over rather than copying it. Each push hands its buffer to the
+ * stream so the next run takes another, sized for a full push, from the swap pool, which gets the buffers back once
+ * the stream lets go of them so no allocation is made once it holds enough. The buffers are cache line aligned so
+ * that they can be written with non temporal stores, see startRun.
+ */
+void SddsToBulkIOProcessor::addToSwapRun(const uint8_t *payload, uint64_t received) {
+	if (m_run_pkts != 0 && (not m_run_swapped || m_run_pkts >= m_pkts_per_read)) {
+		pushPayloadRun();
+	}
+
+	if (not m_swap_buffer) {
+		m_swap_buffer = m_swap_pool->acquire();
+	}
+
+	if (received) {
+		m_run_received.push_back(received);
+	}
+
+	if (m_run_pkts == 0) {
+		m_run_start = m_swap_buffer;
+		m_run_swapped = true;
+		m_run_time_stamp = m_bulkio_time_stamp;
+	}
+
+	uint8_t *dst = m_swap_buffer + m_run_pkts * SDDS_DATA_SIZE;
+	if (m_bps == 16) {
+		byteSwap16(dst, payload, SDDS_DATA_SIZE, m_swap_non_temporal);
+	} else {
+		byteSwap32(dst, payload, SDDS_DATA_SIZE, m_swap_non_temporal);
+	}
+	m_run_pkts++;
+}
+
+/**
+ * Writes the current payload run, if there is one, to the output stream matching m_bps. The payloads are handed
+ * to the stream as a transient buffer which points directly into the packet buffer's payload block so no copy is
+ * made on our side; the stream will make its own copy if it ever needs to hold on to the data past the write.
+ * A run of swapped payloads is instead handed over along with the swap buffer it lives in, see addToSwapRun.
+ */
+void SddsToBulkIOProcessor::pushPayloadRun() {
+	if (m_run_pkts == 0) {
+		return;
+	}
+
+	size_t num_bytes = m_run_pkts * SDDS_DATA_SIZE;
+	m_run_pkts = 0;
+	if (m_run_swapped) {
+		m_swap_buffer = NULL;
+	}
+	bool handed_over = false;
+
+	switch(m_bps) {
+	case 8:
+		octetStream.write(redhawk::shared_buffer<unsigned char>::make_transient(m_run_start, num_bytes), m_run_time_stamp);
+		break;
+	case 16:
+		if (m_run_swapped) {
+			shortStream.write(redhawk::buffer<short>(reinterpret_cast<short*>(m_run_start), num_bytes / sizeof(short), SwapBufferRecycler(m_swap_pool)), m_run_time_stamp);
+			handed_over = true;
+		} else {
+			shortStream.write(redhawk::shared_buffer<short>::make_transient(reinterpret_cast<short*>(m_run_start), num_bytes / sizeof(short)), m_run_time_stamp);
+		}
+		break;
+	case 32:
+		if (m_run_swapped) {
+			floatStream.write(redhawk::buffer<float>(reinterpret_cast<float*>(m_run_start), num_bytes / sizeof(float), SwapBufferRecycler(m_swap_pool)), m_run_time_stamp);
+			handed_over = true;
+		} else {
+			floatStream.write(redhawk::shared_buffer<float>::make_transient(reinterpret_cast<float*>(m_run_start), num_bytes / sizeof(float)), m_run_time_stamp);
+		}
+		break;
+	default:
+		RH_ERROR(_log, "Could not push payload run, the bits per sample are non-standard and set to: " << m_bps);
+		break;
+	}
+
+	// The swap buffer is still ours if the bits per sample changed under the run
+	if (m_run_swapped && not handed_over) {
+		m_swap_pool->release(m_run_start);
+	}
+
+	if (not m_run_received.empty()) {
+		uint64_t now = realtimeNs();
+		for (size_t i = 0; i < m_run_received.size(); ++i) {
+			if (m_run_received[i] <= now) {
+				m_push_latency.record(now - m_run_received[i]);
+			}
+		}
+		m_run_received.clear();
+	}
 }
 /**
  * Returns whether the processor is set to push on a time tag valid flag change.
@@ -509,17 +1253,18 @@ unsigned short SddsToBulkIOProcessor::getBps() {
  * The number of lost SDDS packets. For simplicity, the calculation includes the
  * optional checksum packets in the lost SDDS packet count (sent every 32 packets)
  * so it may not reflect the exact number of dropped packets if checksum packets are not used (and they never are).
+ * Returns the count as last published, see getMetrics.
  */
 unsigned long long SddsToBulkIOProcessor::getNumDropped() {
-	return m_pkts_dropped;
+	return getMetrics().dropped_packets;
 }
 
 /**
- * Returns the expected SDDS sequence number. This processor assumes that
+ * Returns the expected SDDS sequence number as last published, see getMetrics. This processor assumes that
  * the checksum packet will never be sent.
  */
 uint16_t SddsToBulkIOProcessor::getExpectedSequenceNumber() {
-	return m_expected_seq_number;
+	return getMetrics().expected_sequence_number;
 }
 
 /**
@@ -549,15 +1294,25 @@ void SddsToBulkIOProcessor::unsetUpstreamSri() {
 	m_use_upstream_sri = false;
 	m_upstream_sri_set = false;
 	m_endianness = ENDIANNESS::ENDIAN_DEFAULT; // Default to big endian
-	m_sri.streamID = "DEFAULT_SDDS_STREAM_ID";
+	m_sri.streamID = m_default_stream_id.c_str();
+	m_new_upstream_sri = true; // So the processing thread picks the packet kernel for the default endianness
+	if (not m_running) {
+		selectPacketKernel();
+	}
+	lock.unlock();
+
+	// Otherwise the processing thread publishes the change
+	if (not m_running) {
+		publishMetrics(true);
+	}
 }
 
 /**
  * Returns the current stream ID which is derived from
- * the upstream SRI or created if none is provided.
+ * the upstream SRI or created if none is provided, as last published, see getMetrics.
  */
 std::string SddsToBulkIOProcessor::getStreamId() {
-	return CORBA::string_dup(m_sri.streamID);
+	return getMetrics().stream_id;
 }
 
 /**
@@ -572,11 +1327,11 @@ double SddsToBulkIOProcessor::getSampleRate() {
 
 /**
  * Returns the currently set assumed engianness of the
- * data portion of the SDDS packet. Valid strings are
+ * data portion of the SDDS packet, as last published, see getMetrics. Valid strings are
  * definied in the header file.
  */
 std::string SddsToBulkIOProcessor::getEndianness() {
-	return m_endianness;
+	return getMetrics().endianness;
 }
 
 /**
@@ -596,13 +1351,15 @@ void SddsToBulkIOProcessor::setEndianness(std::string endianness) {
 	}
 
 	m_endianness = endianness;
+	selectPacketKernel();
+	publishMetrics(true);
 }
 
 /**
  * Returns the total number of timeslips where a time slip
  * can either be an accumulated time slip or a time slip between
- * packets. See the documentation for more details.
+ * packets, as last published, see getMetrics. See the documentation for more details.
  */
 long SddsToBulkIOProcessor::getTimeSlips() {
-	return m_num_time_slips;
+	return getMetrics().time_slips;
 }
@@ -27,11 +27,13 @@
 #ifndef SDDSTOBULKIOPROCESSOR_H_
 #define SDDSTOBULKIOPROCESSOR_H_
 
-#include <boost/shared_ptr.hpp>
 #include <deque>
 #include <vector>
 
 #include "SmartPacketBuffer.h"
+#include "LatencyHistogram.h"
+#include "SeqLock.h"
+#include "SwapBufferPool.h"
 #include "ossie/debug.h"
 #include "sddspacket.h"
 #include "bulkio.h"
@@ -40,14 +42,53 @@
 #define SDDS_DATA_SIZE 1024
 #define DEFAULT_PKTS_PER_READ 500
 #define CORBA_MAX_XFER_BYTES omniORB::giopMaxMsgSize() - 2048
+#define DEFAULT_SDDS_STREAM_ID "DEFAULT_SDDS_STREAM_ID"
+#define DEFAULT_STATUS_INTERVAL_MS 100
+#define MERGE_HOLD_TIMEOUT_NS 1000000ULL
+#define SWAP_POOL_MAX_FREE 4 // Byte swapped pushes whose buffers are kept for reuse once the stream lets go of them
 
-typedef boost::shared_ptr<SDDSpacket> SddsPacketPtr;
+typedef SmartPacketBuffer<SDDSheader>::TypePtr SddsPacketPtr;
+
+class SddsToBulkIOProcessorSet;
+
+/**
+ * The processor's counters. Only the processing thread writes them and they sit on cache lines of their own, see
+ * SddsToBulkIOProcessor::m_counters, other threads only see them through the published metrics. The buffer wait is
+ * the time spent blocked waiting for full buffers, that is for the socket reader.
+ */
+typedef struct {
+	unsigned long long pkts_dropped;
+	long num_time_slips;
+	uint64_t buffer_wait_ns;
+	uint16_t expected_seq_number;
+} processor_counters_t;
+
+/**
+ * The processor's status, published by the processing thread, see publishMetrics. The latencies are the 50th, 99th
+ * and 99.9th percentiles and the maximum, in microseconds. The stream ID and endianness are copied in as fixed size,
+ * nul terminated, strings so the snapshot stays plain old data, a longer stream ID is cut short.
+ */
+typedef struct {
+	unsigned short bps;
+	char stream_id[256];
+	char endianness[8];
+	unsigned long long dropped_packets;
+	uint16_t expected_sequence_number;
+	double sample_rate;
+	long time_slips;
+	double buffer_wait_time;
+	double dequeue_latency[4];
+	double push_latency[4];
+} processor_metrics_t;
 
 class SddsToBulkIOProcessor {
 public:
 	SddsToBulkIOProcessor(bulkio::OutOctetPort *octet_out, bulkio::OutShortPort *short_out, bulkio::OutFloatPort *float_out);
 	virtual ~SddsToBulkIOProcessor();
-	void run(SmartPacketBuffer<SDDSpacket> *pktbuffer);
+	void run(SmartPacketBuffer<SDDSheader> *pktbuffer);
+	static void runStreams(SddsToBulkIOProcessorSet *set, SmartPacketBuffer<SDDSheader> *pktbuffer);
+	void setLane(size_t lane);
+	void setStreamId(std::string stream_id);
 	void setPktsPerRead(size_t pkts_per_read);
 	void shutDown();
 	void setWaitForTTV(bool wait_for_ttv);
@@ -65,6 +106,11 @@ public:
 	std::string getEndianness();
 	void setEndianness(std::string endianness);
 	long getTimeSlips();
+	void setLatencyTracking(bool track_latency);
+	double getDequeueLatency(double fraction);
+	double getPushLatency(double fraction);
+	void setStatusInterval(unsigned int interval_ms);
+	processor_metrics_t getMetrics();
 	void setLogger(LOGGER log);
 private:
 	LOGGER _log;
@@ -75,14 +121,14 @@ private:
 	bool m_push_on_ttv;
 	bool m_first_packet;
 	bool m_current_ttv_flag;
-	uint16_t m_expected_seq_number;
-	std::vector<uint8_t> m_bulkIO_data;
+	std::vector<uint8_t> m_bulkIO_data; // Payloads gathered for a single write, see writeGathered
 	SDDSTime m_last_sdds_time;
-	unsigned long long m_pkts_dropped;
 	time_t m_start_of_year;
 	unsigned short m_bps;
 	BULKIO::StreamSRI m_sri;
 	BULKIO::PrecisionUTCTime m_bulkio_time_stamp;
+	BULKIO::PrecisionUTCTime m_time_anchor; // The time stamp the current contiguous stretch started with, see updateTimeStamp
+	size_t m_pkts_since_anchor;
 	bulkio::OutOctetPort *m_octet_out;
 	bulkio::OutShortPort *m_short_out;
 	bulkio::OutFloatPort *m_float_out;
@@ -91,7 +137,6 @@ private:
 	std::string m_endianness;
 	bool m_new_upstream_sri;
 	bool m_use_upstream_sri;
-	long m_num_time_slips;
 	double m_current_sample_rate;
 	double m_max_time_step, m_min_time_step, m_ideal_time_step, m_time_error_accum, m_accum_error_tolerance;
 	bool m_non_conforming_device;
@@ -100,12 +145,106 @@ private:
     bulkio::OutShortStream shortStream;
     bulkio::OutOctetStream octetStream;
 
+	// Zero copy pushes out of the packet buffer's payload block, only used when the payloads are split from the headers
+	SmartPacketBuffer<SDDSheader> *m_pktbuffer;
+	bool m_zero_copy;
+	uint8_t *m_run_start;
+	size_t m_run_pkts;
+	BULKIO::PrecisionUTCTime m_run_time_stamp;
+
+	// Payloads that need swapping are swapped straight into a buffer of our own which is handed to the stream as is
+	// and comes back to the pool once the stream is done with it
+	bool m_run_swapped;
+	uint8_t *m_swap_buffer;
+	boost::shared_ptr<SwapBufferPool> m_swap_pool;
+	bool m_swap_non_temporal;
+
+	// Packets popped from each lane of the packet buffer but not yet merged, only used with more than one socket reader
+	std::vector<std::deque<SddsPacketPtr> > m_lane_pending;
+	uint16_t m_merge_seq;
+	bool m_merge_started;
+	uint64_t m_merge_hold_start;
+
+	// Kernel receive to dequeue and to push latencies, only recorded if the socket reader time stamps the packets
+	bool m_track_latency;
+	LatencyHistogram m_dequeue_latency;
+	LatencyHistogram m_push_latency;
+	std::vector<uint64_t> m_run_received;
+
+	// With more than one attached stream each stream's processor only works the packets of its own lane, see runStreams
+	size_t m_lane;
+	std::string m_default_stream_id;
+	std::deque<SddsPacketPtr> m_pkts_to_process;
+	std::deque<SddsPacketPtr> m_pkts_to_recycle;
+
+	// The packet processing kernel for the current stream parameters, see selectPacketKernel
+	typedef bool (SddsToBulkIOProcessor::*PacketKernel)(std::deque<SddsPacketPtr> &pktsToWork, std::deque<SddsPacketPtr> &pktsToRecycle);
+	PacketKernel m_packet_kernel;
+
+	// The status snapshot, see publishMetrics
+	unsigned int m_status_interval_ms;
+	uint64_t m_next_publish;
+	SeqLock<processor_metrics_t> m_metrics;
+	boost::mutex m_publish_lock;
+
+	// Written by the processing thread alone, padded so no other member shares their cache lines
+	char m_counters_pad0[SPSC_CACHE_LINE_SIZE];
+	processor_counters_t m_counters;
+	char m_counters_pad1[SPSC_CACHE_LINE_SIZE];
+
+	void startRun(SmartPacketBuffer<SDDSheader> *pktbuffer);
+	static void updateProcessors(SddsToBulkIOProcessorSet *set, std::vector<SddsToBulkIOProcessor*> &processors, SmartPacketBuffer<SDDSheader> *pktbuffer);
+	bool processLane();
+	void finishRun();
+	void publishMetrics(bool idle);
+	void popMergedBuffers(SmartPacketBuffer<SDDSheader> *pktbuffer, std::deque<SddsPacketPtr> &pktsToWork);
 	void processPackets(std::deque<SddsPacketPtr> &pktsToWork, std::deque<SddsPacketPtr> &pktsToRecycle);
-	bool orderIsValid(SddsPacketPtr &pkt);
+	template <unsigned short BPS, bool SWAP, bool WAIT_FOR_TTV, bool PUSH_ON_TTV>
+	bool processPacketsAs(std::deque<SddsPacketPtr> &pktsToWork, std::deque<SddsPacketPtr> &pktsToRecycle);
+	template <unsigned short BPS, bool SWAP>
+	PacketKernel packetKernel();
+	void selectPacketKernel();
+	bool orderIsValid(SddsPacketPtr pkt);
+	size_t scanRun(std::deque<SddsPacketPtr>::iterator first, std::deque<SddsPacketPtr>::iterator end);
+	void writeGathered(std::deque<SddsPacketPtr>::iterator first, size_t count);
 	void pushSri();
-	void checkForTimeSlip(SddsPacketPtr &pkt);
+	bool checkForTimeSlip(SddsPacketPtr pkt);
+	void updateTimeStamp(SddsPacketPtr pkt);
 	void updateExpectedXdelta(double rate, bool complex);
 	void createOutputStreams();
+	void flushStreams();
+	void recordDequeueLatency(const std::deque<SddsPacketPtr> &pkts, size_t first);
+	void addToPayloadRun(uint8_t *payload, uint64_t received);
+	void addToSwapRun(const uint8_t *payload, uint64_t received);
+	void pushPayloadRun();
+};
+
+/**
+ * The processors worked by SddsToBulkIOProcessor::runStreams, at most one per lane of the packet buffer. Processors can
+ * be added and removed while runStreams is working the set and it picks the change up at the top of its next pass. An
+ * added processor is started. A removed one works what is left in its lane, pushes it out and closes its stream. The
+ * other processors carry on undisturbed.
+ */
+class SddsToBulkIOProcessorSet {
+public:
+	SddsToBulkIOProcessorSet();
+	void assign(size_t num_lanes);
+	void add(size_t lane, SddsToBulkIOProcessor *processor);
+	void remove(size_t lane);
+	void shutDown();
+private:
+	friend class SddsToBulkIOProcessor;
+	SddsToBulkIOProcessorSet(const SddsToBulkIOProcessorSet&);              // Disabled copy constructor
+	SddsToBulkIOProcessorSet& operator = (const SddsToBulkIOProcessorSet&); // Disabled assign operator
+
+	boost::mutex m_lock;
+	boost::condition_variable m_updated;
+	std::vector<SddsToBulkIOProcessor*> m_processors;
+	volatile bool m_changed;
+	volatile bool m_shuttingDown;
+	bool m_running;
+	uint64_t m_requested;
+	uint64_t m_applied;
 };
 
 #endif /* SDDSTOBULKIOPROCESSOR_H_ */
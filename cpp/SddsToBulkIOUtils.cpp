@@ -55,12 +55,10 @@ time_t getStartOfYear() {
  * startOfYear is the value calculated from the getStartOfYear function and is updated if the year has rolled over.
  * lastWSec is the last whole number of seconds from the SDDS Packet and is updated each time. It is used to determine if the year has rolled over.
  */
-BULKIO::PrecisionUTCTime getBulkIOTimeStamp(SDDSpacket* sdds_pkt, const SDDSTime &last_sdds_time, time_t &startOfYear, LOGGER _log) {
+BULKIO::PrecisionUTCTime getBulkIOTimeStamp(SDDSheader* sdds_pkt, const SDDSTime &last_sdds_time, time_t &startOfYear, LOGGER _log) {
+    // Called for every discontinuity in the packet stream, so nothing is logged unless the year rolls over
     if (!_log) {
         _log = rh_logger::Logger::getLogger("SourceSDDS_utils");
-        RH_DEBUG(_log, "getBulkIOTimeStamp method passed null logger; creating logger "<<_log->getName());
-    } else {
-        RH_DEBUG(_log, "getBulkIOTimeStamp method passed valid logger "<<_log->getName());
     }
 	BULKIO::PrecisionUTCTime T;
 
@@ -99,7 +97,7 @@ BULKIO::PrecisionUTCTime getBulkIOTimeStamp(SDDSpacket* sdds_pkt, const SDDSTime
 	return T;
 }
 
-void getWholeAndFracSec(SDDSpacket* sdds_pkt, uint64_t &whole_sec, uint64_t &frac_sec, time_t &startOfYear) {
+void getWholeAndFracSec(SDDSheader* sdds_pkt, uint64_t &whole_sec, uint64_t &frac_sec, time_t &startOfYear) {
 	SDDSTime t = sdds_pkt->get_SDDSTime();
 	unsigned long long frac_int = t.ps250() % 4000000000UL;
 	unsigned long long secs_int = t.ps250() - frac_int;
@@ -120,7 +118,7 @@ void getWholeAndFracSec(SDDSpacket* sdds_pkt, uint64_t &whole_sec, uint64_t &fra
  * Returns the bits per sample.
  * The SDDS packet only has 5 bits for this field so a value of 31 is equivalent to 32 bits.
  */
-unsigned short getBps(SDDSpacket* sdds_pkt) {
+unsigned short getBps(SDDSheader* sdds_pkt) {
 	return (sdds_pkt->bps == 31) ? (32) : (sdds_pkt->bps);
 }
 
@@ -130,7 +128,7 @@ unsigned short getBps(SDDSpacket* sdds_pkt) {
  * If values within the SRI object are changed, the changed boolean is set to true.
  * If no values within the SRI object is changed the boolean is set to false.
  */
-void mergeSddsSRI(SDDSpacket* sdds_pkt, BULKIO::StreamSRI &sri, bool &changed, bool non_conforming_device) {
+void mergeSddsSRI(SDDSheader* sdds_pkt, BULKIO::StreamSRI &sri, bool &changed, bool non_conforming_device) {
 
 	CORBA::Double recXdelta = (CORBA::Double)(1.0 / sdds_pkt->get_rate());
 
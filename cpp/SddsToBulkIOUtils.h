@@ -30,9 +30,9 @@ namespace ENDIANNESS {
 }
 
 time_t getStartOfYear();
-BULKIO::PrecisionUTCTime getBulkIOTimeStamp(SDDSpacket* sdds_pkt, const SDDSTime &last_sdds_time, time_t &startOfYear, LOGGER _log=LOGGER());
-unsigned short getBps(SDDSpacket* sdds_pkt);
-void mergeSddsSRI(SDDSpacket* sdds_pkt, BULKIO::StreamSRI &sri, bool &changed, bool non_conforming_device);
+BULKIO::PrecisionUTCTime getBulkIOTimeStamp(SDDSheader* sdds_pkt, const SDDSTime &last_sdds_time, time_t &startOfYear, LOGGER _log=LOGGER());
+unsigned short getBps(SDDSheader* sdds_pkt);
+void mergeSddsSRI(SDDSheader* sdds_pkt, BULKIO::StreamSRI &sri, bool &changed, bool non_conforming_device);
 void mergeUpstreamSRI(BULKIO::StreamSRI &currSRI, BULKIO::StreamSRI &upstreamSRI, bool &useUpstream, bool &changed,bool &streamIDChanged, std::string &endianness, LOGGER _log=LOGGER());
 
 
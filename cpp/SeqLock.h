@@ -0,0 +1,90 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * SeqLock.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author:
+ */
+
+#ifndef SEQLOCK_H_
+#define SEQLOCK_H_
+
+#include <string.h>
+#include <stdint.h>
+
+/**
+ * Holds the latest copy of a plain old data struct published by a single writer for any number of readers.
+ *
+ * The writer never waits: it bumps the sequence number to odd, copies the value in and bumps it back to even. A
+ * reader copies the value out between two reads of the sequence number and tries again if the writer was part way
+ * through, so a reader can never see half of one publish and half of another. Readers only spin while a publish is
+ * in progress, which is a copy of a few hundred bytes at most. As with SpscRing.h the ordering is done with the GCC
+ * __sync builtins.
+ */
+template <class T>
+class SeqLock {
+public:
+	SeqLock(): m_seq(0) {
+		memset((void*) &m_value, 0, sizeof(m_value));
+	}
+
+	/**
+	 * Writer side. Replaces the published value with value. Must only be called by one thread at a time.
+	 */
+	void publish(const T &value) {
+		uint32_t seq = m_seq;
+		m_seq = seq + 1;
+		__sync_synchronize();
+		memcpy((void*) &m_value, &value, sizeof(m_value));
+		__sync_synchronize();
+		m_seq = seq + 2;
+	}
+
+	/**
+	 * Reader side. Returns the last published value, or a zeroed value if nothing has been published yet.
+	 */
+	T read() const {
+		T value;
+		while (true) {
+			uint32_t before = m_seq;
+			__sync_synchronize();
+			if (not (before & 1)) {
+				memcpy(&value, (const void*) &m_value, sizeof(value));
+				__sync_synchronize();
+				if (m_seq == before) {
+					return value;
+				}
+			}
+#if defined(__i386__) || defined(__x86_64__)
+			__asm__ __volatile__("pause");
+#endif
+		}
+	}
+
+private:
+	SeqLock(const SeqLock&);              // Disabled copy constructor
+	SeqLock& operator = (const SeqLock&); // Disabled assign operator
+
+	volatile uint32_t m_seq;
+	volatile T m_value;
+};
+
+#endif /* SEQLOCK_H_ */
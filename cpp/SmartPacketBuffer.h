@@ -32,84 +32,171 @@
 #include <boost/thread/condition_variable.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/call_traits.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
 #include <string>
 #include <stdio.h>
 #include <iostream>
 #include <deque>
+#include <algorithm>
+#include "SpscRing.h"
+#include "PacketArena.h"
 
 
 /**
- * Two deques of boost smart pointers
- * One deque full of empty buffers to be used
- * One deque where filled buffers are placed.
- * You MUST follow this cycle: pop_empty_buffer -> push_full_buffer -> pop_full_buffer -> recycle_buffer
- * Memory is only allocated at construction so if you do not follow the above cycle and a smart pointer goes
- * out of scope it will free itself.
+ * Hands packet buffers back and forth between the threads filling them (the socket readers) and the thread working
+ * them (the SDDS to BulkIO processor). The buffers are plain pointers to the slots of a single contiguous arena that
+ * is only allocated at initialization, see PacketArena.h. The SmartPacketBuffer owns the arena, the pointers handed
+ * out are only borrowed and are not reference counted so passing them around costs nothing. The flip side is that
+ * every pointer handed out is invalidated by the next call to initialize or by destroying the SmartPacketBuffer; the
+ * threads using the buffer must be joined first.
  *
- * The locking here is done with conditional variables so that it should be quick however if this ends up being
- * a point of thread contention it could be reimplemented using a no-wait no-locking queue. I've tested it at
- * 3Gbps so I do not think that will become an issue but see this post if someone in the future wants to go
- * down that path: http://www.drdobbs.com/parallel/writing-lock-free-code-a-corrected-queue/210604448?pgno=2
- * There are better options than drdobbs example however most require C++11 and his example only requires c++0x
- * There is no license or copyright shown however after emailing him regarding use he responded with
- * "Hi Youssef, it’s “as is” for you to use. Thanks,"
+ * The buffer is split into lanes, one per filling thread or per attached stream, one lane if not asked for more. Each
+ * lane owns capacity / num_lanes of the arena's slots, any remainder is left unused, and has a container of empty
+ * buffers and a container of full buffers of its own so the lanes never contend with each other. Every buffer must
+ * go round the cycle pop_empty -> push_full -> pop_full -> recycle; the filling and working sides name their lane
+ * and recycled buffers always go back to the lane that owns their slot. A single lane can be reset with reset_lane,
+ * refilling it with all of its slots, once neither side is using it while the other lanes carry on.
  *
+ * By default the two containers of a lane are deques guarded by a mutex each with a condition variable to wait on.
+ * At rates above about 3Gbps the lock hand off between the socket reader and the SDDS to BulkIO processor becomes the
+ * point of contention, so if initialized with lock_free set they are replaced by two wait free single producer single
+ * consumer rings, see SpscRing.h. In that mode each lane must have exactly one thread filling buffers (pop_empty ->
+ * push_full) and exactly one thread working them (pop_full -> recycle), and waiting for buffers is done by spinning
+ * then backing off rather than on a condition variable.
+ *
+ * Two calls let the filling side put buffers back other than through the working side. reclaim_full_buffers takes
+ * back the oldest full buffers of a lane that have not been popped yet, dropping their packets, so the filling side
+ * can keep going when it is out of empty buffers. release_buffers hands back empty buffers the filling side popped
+ * but never filled when it is done with the lane. Only the working side may pop from the full ring and push to the
+ * empty ring, so in lock free mode reclaim_full_buffers takes nothing back and release_buffers simply forgets the
+ * buffers, which are lost to the lane until the next initialize or reset_lane. A pointer that is dropped rather than
+ * recycled is lost in the same way.
  */
 template <class T >
 class SmartPacketBuffer {
 public:
 
-	typedef boost::shared_ptr<T> TypePtr;
+	typedef T* TypePtr;
     typedef std::deque<TypePtr> container_type;
     typedef typename container_type::size_type size_type;
     typedef typename container_type::value_type value_type;
 
-    explicit SmartPacketBuffer():m_shuttingDown(false) {}
+    /**
+     * @param payload_size The number of payload bytes that follow each T, see PacketArena.h
+     */
+    explicit SmartPacketBuffer(size_t payload_size = 0):m_shuttingDown(false), m_lock_free(false), m_payload_size(payload_size),
+    	m_num_lanes(0), m_lane_size(0) {}
 
     /**
      * Initializes the empty buffers container with capacity
-     * new Boost shared pointers of the templated type provided.
+     * pointers to the slots of the packet arena. The arena is only
+     * reallocated if the capacity has changed since the last call.
      * If this Smart Packet Buffer was previously initialized,
-     * one should call destroy buffers before the call to initialize.
-     * Only the empty buffer container is cleared prior to initialization.
+     * one should call shutDown before the call to initialize.
+     * Must not be called while other threads are using the buffer,
+     * any buffer they still hold is invalid afterwards.
      *
      * @param capacity The size of the emtpy buffers container after initialization
+     * @param lock_free If true the wait free single producer single consumer rings are used in place of the locked deques
+     * @param split_payload If true the payloads are kept apart from the T's in one contiguous block, see PacketArena.h
+     * @param headroom The number of bytes reserved in front of every T, see PacketArena.h
+     * @param num_lanes The number of lanes to split the buffers between, any remainder of capacity / num_lanes is unused
+     * @param numa_node The NUMA node to place the buffers on, -1 for wherever the kernel likes, see PacketArena.h
+     * @param pages What kind of pages to back the buffers with, see PacketArena.h
+     * @param lock If true the buffers are faulted in and locked into memory, see PacketArena.h
      */
-    void initialize(size_type capacity) {
-    	boost::unique_lock<boost::mutex> lock(m_empty_buffer_mutex);
+    void initialize(size_type capacity, bool lock_free = false, bool split_payload = false, size_t headroom = 0, size_t num_lanes = 1, int numa_node = -1,
+    		arena_pages_t pages = ARENA_PAGES_DEFAULT, bool lock = false) {
 		m_shuttingDown = false;
-    	m_empty_buffers.clear();
+		m_lock_free = lock_free;
+
+    	// Allocate the memory in one shot and fill the empty buffers with the arena's slots.
+    	if (not m_arena || m_arena->capacity() != capacity || m_arena->is_split() != split_payload || m_arena->headroom() != headroom ||
+    			m_arena->numa_node() != numa_node || m_arena->pages() != pages || m_arena->lock() != lock) {
+    		m_arena.reset();
+    		m_arena.reset(new PacketArena<T>(capacity, m_payload_size, split_payload, headroom, numa_node, pages, lock));
+    		m_timestamps.reset();
+    		m_timestamps.reset(new uint64_t[capacity]);
+    	}
+    	std::fill(m_timestamps.get(), m_timestamps.get() + capacity, 0);
 
-    	// Allocate the memory and fill the empty buffers
-    	for (size_t i = 0; i < capacity; ++i) {
-    		m_empty_buffers.push_back(TypePtr(new T()));
+    	if (num_lanes == 0) {
+    		num_lanes = 1;
+    	}
+    	if (num_lanes != m_num_lanes) {
+    		m_lanes.reset();
+    		m_lanes.reset(new Lane[num_lanes]);
+    		m_num_lanes = num_lanes;
+    	}
+    	m_lane_size = capacity / m_num_lanes;
+
+    	for (size_t lane = 0; lane < m_num_lanes; ++lane) {
+    		reset_lane(lane);
+    	}
+    }
+
+    /**
+     * Forgets every buffer the lane's containers hold and refills its empty buffers with all of the lane's slots, so a
+     * lane that has been let go of can be used again without initializing the whole buffer. Any buffer of the lane
+     * still held by a thread is invalid afterwards; neither the filling nor the working thread of the lane may be
+     * using it, the other lanes are not touched and their threads can carry on.
+     */
+    void reset_lane(size_t lane) {
+    	Lane &l = m_lanes[lane];
+    	boost::unique_lock<boost::mutex> lock1(l.full_buffer_mutex);
+    	boost::unique_lock<boost::mutex> lock2(l.empty_buffer_mutex);
+    	l.empty_buffers.clear();
+    	l.full_buffers.clear();
+
+    	for (size_t i = lane * m_lane_size; i < (lane + 1) * m_lane_size; ++i) {
+    		l.empty_buffers.push_back(m_arena->slot(i));
+    	}
+
+    	if (m_lock_free) {
+    		// Both rings have room for every buffer so a push can never fail
+    		l.full_ring.reset(m_lane_size);
+    		l.empty_ring.reset(m_lane_size);
+    		l.empty_ring.push(l.empty_buffers.begin(), l.empty_buffers.size());
+    		l.empty_buffers.clear();
     	}
-    	lock.unlock();
     }
 
     /**
      * Notifies any waiting thread that the packet buffer is shutting down and
-     * frees all the memory that the smart buffer currently is keeping track of.
-     * This does not include any buffers currently held by other threads which
-     * would need to be recycled or returned prior to calling destroyBuffers.
+     * forgets all the buffers that the smart buffer currently is keeping track of.
+     * The memory itself is owned by the arena and is not freed here since other
+     * threads may still be holding buffers until they are joined.
      * There is no harm in calling shutDown more than once if one needs
      * to free the thread holding the data to recycle it.
      *
      * After a call to shutDown, you will need to call initialize again before
      * using this class
+     *
+     * In lock free mode the rings cannot be safely emptied while the producer or consumer
+     * may still be inside them, the buffers they hold are released on the next call to initialize.
      */
     void shutDown() {
     	m_shuttingDown = true;
-    	m_no_empty_buffers.notify_all();
-    	m_no_full_buffers.notify_all();
-
-		boost::unique_lock<boost::mutex> lock1(m_full_buffer_mutex);
-    	m_full_buffers.clear();
-    	lock1.unlock();
-
-    	boost::unique_lock<boost::mutex> lock2(m_empty_buffer_mutex);
-    	m_empty_buffers.clear();
-		lock2.unlock();
+    	for (size_t lane = 0; lane < m_num_lanes; ++lane) {
+    		Lane &l = m_lanes[lane];
+        	l.no_empty_buffers.notify_all();
+        	l.no_full_buffers.notify_all();
+
+        	if (m_lock_free) {
+        		continue;
+        	}
+
+    		boost::unique_lock<boost::mutex> lock1(l.full_buffer_mutex);
+        	l.full_buffers.clear();
+        	lock1.unlock();
+
+        	boost::unique_lock<boost::mutex> lock2(l.empty_buffer_mutex);
+        	l.empty_buffers.clear();
+    		lock2.unlock();
+    	}
     }
 
 
@@ -118,23 +205,30 @@ public:
      * if no empty buffers are available.
      * NOTE: Not as well tested as pop_empty_buffers but included for completness.
      */
-    TypePtr pop_empty_buffer() {
+    TypePtr pop_empty_buffer(size_t lane = 0) {
     	if (m_shuttingDown) {return NULL;}
-    	boost::unique_lock<boost::mutex> lock(m_empty_buffer_mutex);
-    	m_no_empty_buffers.wait(lock, boost::bind(&SmartPacketBuffer<T>::empties_available, this));
+    	Lane &l = m_lanes[lane];
+    	if (m_lock_free) {
+    		std::deque<TypePtr> que;
+    		if (!wait_and_pop(l.empty_ring, que, 1)) {return NULL;}
+    		return que.front();
+    	}
+    	boost::unique_lock<boost::mutex> lock(l.empty_buffer_mutex);
+    	l.no_empty_buffers.wait(lock, boost::bind(&SmartPacketBuffer<T>::empties_available, this, boost::cref(l), 1));
     	if (m_shuttingDown) {return NULL;}
-    	TypePtr retVal = *m_empty_buffers.begin();
-    	m_empty_buffers.pop_front();
+    	TypePtr retVal = *l.empty_buffers.begin();
+    	l.empty_buffers.pop_front();
     	lock.unlock();
     	return retVal;
     }
 
     /**
      * Fill the provided container until it is len in size of empty buffers.
+     * The new buffers are added to the end of the container, in the order they were recycled.
      * Will block until the request can be satisified (ie. there are len buffers available)
      */
     template<typename Container>
-    void pop_empty_buffers(Container &que, size_t len) {
+    void pop_empty_buffers(Container &que, size_t len, size_t lane = 0) {
     		if (m_shuttingDown) {return;}
 
     		// Maybe they have what they want already
@@ -142,30 +236,66 @@ public:
         		return;
 
         	size_t request = len - que.size();
+        	Lane &l = m_lanes[lane];
+
+        	if (m_lock_free) {
+        		wait_and_pop(l.empty_ring, que, request);
+        		return;
+        	}
 
-        	boost::unique_lock<boost::mutex> lock(m_empty_buffer_mutex);
-        	m_no_empty_buffers.wait(lock, boost::bind(&SmartPacketBuffer<T>::empties_available, this, request));
+        	boost::unique_lock<boost::mutex> lock(l.empty_buffer_mutex);
+        	l.no_empty_buffers.wait(lock, boost::bind(&SmartPacketBuffer<T>::empties_available, this, boost::cref(l), request));
         	if (m_shuttingDown) {return;}
 
         	// Really wish we could use c++11 and just use move :-p
         	// Or more boost::move but that is 1.49
-        	que.insert(que.begin(), m_empty_buffers.begin(), m_empty_buffers.begin() + request);
-        	m_empty_buffers.erase(m_empty_buffers.begin(), m_empty_buffers.begin() + request);
+        	que.insert(que.end(), l.empty_buffers.begin(), l.empty_buffers.begin() + request);
+        	l.empty_buffers.erase(l.empty_buffers.begin(), l.empty_buffers.begin() + request);
 
         	lock.unlock();
         }
 
+    /**
+     * Tops the provided container up towards len empty buffers with whatever the lane has available without blocking.
+     * Returns the number of buffers added. Used when filling more than one lane from the same thread so that a lane
+     * which has run dry cannot hold up the others.
+     */
+    template<typename Container>
+    size_t try_pop_empty_buffers(Container &que, size_t len, size_t lane) {
+    	if (m_shuttingDown || que.size() >= len) {return 0;}
+
+    	size_t request = len - que.size();
+    	Lane &l = m_lanes[lane];
+
+    	if (m_lock_free) {
+    		size_t available = std::min(l.empty_ring.size(), request);
+    		return (available && l.empty_ring.pop(que, available)) ? available : 0;
+    	}
+
+    	boost::unique_lock<boost::mutex> lock(l.empty_buffer_mutex);
+    	size_t available = std::min(l.empty_buffers.size(), request);
+    	que.insert(que.end(), l.empty_buffers.begin(), l.empty_buffers.begin() + available);
+    	l.empty_buffers.erase(l.empty_buffers.begin(), l.empty_buffers.begin() + available);
+    	lock.unlock();
+    	return available;
+    }
+
     /**
      * Pushes a single full buffer on to the full buffer container. Will block
      * if anther thread has the full buffer container lock.
      * NOTE: Not as well tested as push_full_buffers but included for completness.
      */
-    void push_full_buffer(TypePtr b) {
+    void push_full_buffer(TypePtr b, size_t lane = 0) {
     	if (m_shuttingDown) {return;}
-    	boost::unique_lock<boost::mutex> lock(m_full_buffer_mutex);
-    	m_full_buffers.push_back(b);
+    	Lane &l = m_lanes[lane];
+    	if (m_lock_free) {
+    		l.full_ring.push(&b, 1);
+    		return;
+    	}
+    	boost::unique_lock<boost::mutex> lock(l.full_buffer_mutex);
+    	l.full_buffers.push_back(b);
     	lock.unlock();
-    	m_no_full_buffers.notify_one();
+    	l.no_full_buffers.notify_one();
     }
 
     /**
@@ -173,30 +303,43 @@ public:
      * and clears the povided container. Will block if another thread has the full buffer lock.
      */
     template<typename Container>
-    void push_full_buffers(Container &que, size_t num) {
+    void push_full_buffers(Container &que, size_t num, size_t lane = 0) {
     	if (m_shuttingDown) {
     		que.erase(que.begin(), que.begin() + num);
     		return;
     	}
 
-    	boost::unique_lock<boost::mutex> lock(m_full_buffer_mutex);
-		m_full_buffers.insert(m_full_buffers.end(), que.begin(), que.begin() + num);
+    	Lane &l = m_lanes[lane];
+    	if (m_lock_free) {
+    		l.full_ring.push(que.begin(), num);
+    		que.erase(que.begin(), que.begin() + num);
+    		return;
+    	}
+
+    	boost::unique_lock<boost::mutex> lock(l.full_buffer_mutex);
+		l.full_buffers.insert(l.full_buffers.end(), que.begin(), que.begin() + num);
 		que.erase(que.begin(), que.begin() + num);
     	lock.unlock();
-		m_no_full_buffers.notify_one();
+		l.no_full_buffers.notify_one();
     }
 
     /**
      * Returns a single full buffer. Will block if a full buffer is not available.
      * NOTE: Not as well tested as pop_full_buffers but included for completness.
      */
-    TypePtr pop_full_buffer() {
+    TypePtr pop_full_buffer(size_t lane = 0) {
     	if (m_shuttingDown) {return NULL;}
-    	boost::unique_lock<boost::mutex> lock(m_full_buffer_mutex);
-		m_no_full_buffers.wait(lock, boost::bind(&SmartPacketBuffer<T>::full_available, this));
+    	Lane &l = m_lanes[lane];
+    	if (m_lock_free) {
+    		std::deque<TypePtr> que;
+    		if (!wait_and_pop(l.full_ring, que, 1)) {return NULL;}
+    		return que.front();
+    	}
+    	boost::unique_lock<boost::mutex> lock(l.full_buffer_mutex);
+		l.no_full_buffers.wait(lock, boost::bind(&SmartPacketBuffer<T>::full_available, this, boost::cref(l), 1));
 		if (m_shuttingDown) {return NULL;}
-		TypePtr retVal = *m_full_buffers.begin();
-		m_full_buffers.pop_front();
+		TypePtr retVal = *l.full_buffers.begin();
+		l.full_buffers.pop_front();
 		lock.unlock();
 		return retVal;
 	}
@@ -207,24 +350,70 @@ public:
      * Will block until len buffers are available.
      */
     template<typename Container>
-    void pop_full_buffers(Container &que, size_t len) {
+    void pop_full_buffers(Container &que, size_t len, size_t lane = 0) {
     	if (m_shuttingDown) {return;}
 		// Maybe they have what they want already
     	if (que.size() >= len)
     		return;
 
     	size_t request = len - que.size();
+    	Lane &l = m_lanes[lane];
+
+    	if (m_lock_free) {
+    		wait_and_pop(l.full_ring, que, request);
+    		return;
+    	}
 
-    	boost::unique_lock<boost::mutex> lock(m_full_buffer_mutex);
-		m_no_full_buffers.wait(lock, boost::bind(&SmartPacketBuffer<T>::full_available, this, request));
+    	boost::unique_lock<boost::mutex> lock(l.full_buffer_mutex);
+		l.no_full_buffers.wait(lock, boost::bind(&SmartPacketBuffer<T>::full_available, this, boost::cref(l), request));
 		if (m_shuttingDown) {return;}
 
-		que.insert(que.end(), m_full_buffers.begin(), m_full_buffers.begin() + request);
-		m_full_buffers.erase(m_full_buffers.begin(), m_full_buffers.begin() + request);
+		que.insert(que.end(), l.full_buffers.begin(), l.full_buffers.begin() + request);
+		l.full_buffers.erase(l.full_buffers.begin(), l.full_buffers.begin() + request);
 
 		lock.unlock();
 	}
 
+    /**
+     * Moves every full buffer currently in the lane onto the end of the provided container without blocking.
+     * Returns the number of buffers moved. Used when working buffers from more than one lane at a time.
+     */
+    template<typename Container>
+    size_t try_pop_full_buffers(Container &que, size_t lane) {
+    	if (m_shuttingDown) {return 0;}
+    	Lane &l = m_lanes[lane];
+
+    	if (m_lock_free) {
+    		size_t available = l.full_ring.size();
+    		return (available && l.full_ring.pop(que, available)) ? available : 0;
+    	}
+
+    	boost::unique_lock<boost::mutex> lock(l.full_buffer_mutex);
+    	size_t available = l.full_buffers.size();
+    	que.insert(que.end(), l.full_buffers.begin(), l.full_buffers.end());
+    	l.full_buffers.clear();
+    	lock.unlock();
+    	return available;
+    }
+
+    /**
+     * Moves up to len of the oldest full buffers in the lane onto the end of the provided container without blocking so
+     * the filling thread can reuse them as empty buffers once it has run out; their packets are lost. Returns the number
+     * of buffers moved. Only the working thread may pop the full ring so nothing is reclaimed in lock free mode.
+     */
+    template<typename Container>
+    size_t reclaim_full_buffers(Container &que, size_t len, size_t lane) {
+    	if (m_shuttingDown || m_lock_free) {return 0;}
+    	Lane &l = m_lanes[lane];
+
+    	boost::unique_lock<boost::mutex> lock(l.full_buffer_mutex);
+    	size_t available = std::min(l.full_buffers.size(), len);
+    	que.insert(que.end(), l.full_buffers.begin(), l.full_buffers.begin() + available);
+    	l.full_buffers.erase(l.full_buffers.begin(), l.full_buffers.begin() + available);
+    	lock.unlock();
+    	return available;
+    }
+
     /**
      * Returns a single buffer to the internal empty buffer container.
      * Will block if a nother thread holds the empty buffer lock.
@@ -232,10 +421,15 @@ public:
      */
     void recycle_buffer(TypePtr b) {
     	if (m_shuttingDown) {return;}
-    	boost::unique_lock<boost::mutex> lock(m_empty_buffer_mutex);
-    	m_empty_buffers.push_back(b);
+    	Lane &l = m_lanes[lane_of(b)];
+    	if (m_lock_free) {
+    		l.empty_ring.push(&b, 1);
+    		return;
+    	}
+    	boost::unique_lock<boost::mutex> lock(l.empty_buffer_mutex);
+    	l.empty_buffers.push_back(b);
     	lock.unlock();
-    	m_no_empty_buffers.notify_one();
+    	l.no_empty_buffers.notify_one();
     }
 
     /**
@@ -249,48 +443,232 @@ public:
     		return;
     	}
 
-    	boost::unique_lock<boost::mutex> lock(m_empty_buffer_mutex);
-    	m_empty_buffers.insert(m_empty_buffers.end(), que.begin(), que.end());
+    	if (m_num_lanes == 1) {
+    		recycle_to_lane(m_lanes[0], que.begin(), que.end());
+    		que.clear();
+    		return;
+    	}
+
+    	// Hand back each run of buffers belonging to the same lane in one go
+    	typename Container::iterator first = que.begin();
+    	while (first != que.end()) {
+    		size_t lane = lane_of(*first);
+    		typename Container::iterator last = first + 1;
+    		while (last != que.end() && lane_of(*last) == lane) {
+    			++last;
+    		}
+    		recycle_to_lane(m_lanes[lane], first, last);
+    		first = last;
+    	}
     	que.clear();
-    	lock.unlock();
-    	m_no_empty_buffers.notify_one();
     }
 
     /**
-     * Returns the number of buffers in the internal full buffers container.
+     * Returns empty buffers that were popped by the filling thread but never pushed as full buffers.
+     * In the locked mode this is the same as recycle_buffers. In lock free mode only the working thread
+     * may put buffers back into the empty ring, so the buffers are dropped here and reclaimed by the
+     * next call to initialize. This should only be used when the filling thread is exiting.
+     */
+    template<typename Container>
+    void release_buffers(Container &que) {
+    	if (m_lock_free) {
+    		que.clear();
+    		return;
+    	}
+
+    	recycle_buffers(que);
+    }
+
+    /**
+     * Returns the number of buffers in the internal full buffers containers of every lane.
      */
     size_t get_num_full_buffers() {
-    	return m_full_buffers.size();
+    	size_t num = 0;
+    	for (size_t lane = 0; lane < m_num_lanes; ++lane) {
+    		num += (m_lock_free) ? m_lanes[lane].full_ring.size() : m_lanes[lane].full_buffers.size();
+    	}
+    	return num;
     }
 
     /**
-     * Returns the number of buffers in the internal empty buffers container.
+     * Returns the number of buffers in the internal empty buffers containers of every lane.
      */
     size_t get_num_empty_buffers() {
-    	return m_empty_buffers.size();
+    	size_t num = 0;
+    	for (size_t lane = 0; lane < m_num_lanes; ++lane) {
+    		num += (m_lock_free) ? m_lanes[lane].empty_ring.size() : m_lanes[lane].empty_buffers.size();
+    	}
+    	return num;
+    }
+
+    /**
+     * Returns the number of lanes the buffers are split between.
+     */
+    size_t get_num_lanes() const {
+    	return m_num_lanes;
+    }
+
+    /**
+     * Returns the number of buffers owned by each lane.
+     */
+    size_t get_lane_size() const {
+    	return m_lane_size;
+    }
+
+    /**
+     * Returns the slot index of a buffer handed out by this SmartPacketBuffer.
+     */
+    size_t get_index(const T* buffer) const {
+    	return m_arena->index_of(buffer);
+    }
+
+    /**
+     * Returns the buffer living in the provided arena slot index.
+     */
+    TypePtr get_buffer(size_t index) const {
+    	return m_arena->slot(index);
+    }
+
+    /**
+     * Returns the start of the payload belonging to a buffer handed out by this SmartPacketBuffer.
+     */
+    uint8_t* get_payload(const T* buffer) const {
+    	return m_arena->payload_of(buffer);
+    }
+
+    /**
+     * Sets the time, in nanoseconds since the epoch, a buffer's packet was received. Each slot keeps its own
+     * time stamp which travels with the buffer from the filling thread to the working thread.
+     */
+    void set_timestamp(const T* buffer, uint64_t ns) {
+    	m_timestamps[m_arena->index_of(buffer)] = ns;
+    }
+
+    /**
+     * Returns the time, in nanoseconds since the epoch, a buffer's packet was received. Only meaningful if the
+     * filling thread sets it.
+     */
+    uint64_t get_timestamp(const T* buffer) const {
+    	return m_timestamps[m_arena->index_of(buffer)];
+    }
+
+    /**
+     * Returns true if the payloads are kept in their own contiguous block.
+     */
+    bool is_split_payload() const {
+    	return m_arena && m_arena->is_split();
+    }
+
+    /**
+     * Returns the number of bytes reserved in front of every buffer.
+     */
+    size_t get_headroom() const {
+    	return (m_arena) ? m_arena->headroom() : 0;
+    }
+
+    /**
+     * Returns the number of buffers in the pool.
+     */
+    size_t get_capacity() const {
+    	return (m_arena) ? m_arena->capacity() : 0;
+    }
+
+    /**
+     * Returns the NUMA node the buffers were placed on, or -1 if they were not placed, see PacketArena.h
+     */
+    int get_numa_node() const {
+    	return (m_arena) ? m_arena->bound_node() : -1;
+    }
+
+    /**
+     * Returns the size in bytes of the pages backing the buffers, or 0 if not initialized, see PacketArena.h
+     */
+    size_t get_page_size() const {
+    	return (m_arena) ? m_arena->page_size() : 0;
+    }
+
+    /**
+     * Returns true if the buffers are locked into memory, see PacketArena.h
+     */
+    bool is_locked() const {
+    	return (m_arena) ? m_arena->locked() : false;
+    }
+
+    /**
+     * Returns true if the buffer was initialized to use the wait free rings.
+     */
+    bool is_lock_free() {
+    	return m_lock_free;
     }
 
 private:
     SmartPacketBuffer(const SmartPacketBuffer&);              // Disabled copy constructor
     SmartPacketBuffer& operator = (const SmartPacketBuffer&); // Disabled assign operator
-    bool m_shuttingDown;
+    /**
+     * Everything needed to pass buffers between one filling thread and the working thread.
+     */
+    struct Lane {
+    	container_type empty_buffers;
+    	container_type full_buffers;
+    	boost::mutex empty_buffer_mutex;
+    	boost::mutex full_buffer_mutex;
+    	boost::condition_variable no_empty_buffers;
+    	boost::condition_variable no_full_buffers;
+    	SpscRing<TypePtr> empty_ring;
+    	SpscRing<TypePtr> full_ring;
+    };
+
+    volatile bool m_shuttingDown;
+    bool m_lock_free;
+    size_t m_payload_size;
+    size_t m_num_lanes;
+    size_t m_lane_size;
+
+    /**
+     * Returns the lane that owns the slot of the provided buffer.
+     */
+    size_t lane_of(const T* buffer) const {
+    	return (m_num_lanes == 1) ? 0 : m_arena->index_of(buffer) / m_lane_size;
+    }
+
+    template<typename Iterator>
+    void recycle_to_lane(Lane &l, Iterator first, Iterator last) {
+    	if (m_lock_free) {
+    		l.empty_ring.push(first, last - first);
+    		return;
+    	}
+
+    	boost::unique_lock<boost::mutex> lock(l.empty_buffer_mutex);
+    	l.empty_buffers.insert(l.empty_buffers.end(), first, last);
+    	lock.unlock();
+    	l.no_empty_buffers.notify_one();
+    }
+
+    /**
+     * Lock free replacement for the condition variable wait. Spins, then backs off, until num buffers can be
+     * popped off the ring or we are shutting down. Returns false if we are shutting down.
+     */
+    template<typename Container>
+    bool wait_and_pop(SpscRing<TypePtr> &ring, Container &que, size_t num) {
+    	unsigned int attempt = 0;
+    	while (not ring.pop(que, num)) {
+    		if (m_shuttingDown) {return false;}
+    		SpscRing<TypePtr>::backoff(attempt);
+    	}
+    	return true;
+    }
 
     /**
      * If we are shutting down we need to just open the gates up and let the threads run.
      * If not we'll have folks blocking on us
      */
-    bool empties_available() const { return m_empty_buffers.size() > 0 					|| m_shuttingDown; }
-    bool empties_available(size_t num) const { return m_empty_buffers.size() >= num 	|| m_shuttingDown; }
-    bool full_available() const { return m_full_buffers.size() > 0 						|| m_shuttingDown; }
-    bool full_available(size_t num) const { return m_full_buffers.size() >= num 		|| m_shuttingDown; }
+    bool empties_available(const Lane &l, size_t num) const { return l.empty_buffers.size() >= num 	|| m_shuttingDown; }
+    bool full_available(const Lane &l, size_t num) const { return l.full_buffers.size() >= num 		|| m_shuttingDown; }
 
 
-    container_type m_empty_buffers;
-    container_type m_full_buffers;
-    boost::mutex m_empty_buffer_mutex;
-    boost::mutex m_full_buffer_mutex;
-    boost::condition_variable m_no_empty_buffers;
-    boost::condition_variable m_no_full_buffers;
+    boost::scoped_array<Lane> m_lanes;
+    boost::scoped_ptr<PacketArena<T> > m_arena;
+    boost::scoped_array<uint64_t> m_timestamps;
 };
 
 #endif /* PACKETBUFFER_H_ */
@@ -34,26 +34,141 @@
 #include <sys/ioctl.h>
 #include <linux/sockios.h>
 #include <fcntl.h>
+#include <unistd.h>
 #include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include <linux/filter.h>
+#include <time.h>
+#include <algorithm>
+#include <vector>
+#include "socketUtils/udp_diag.h"
 
+// The TPACKET_V3 ring is made up of blocks of this size, the number of blocks is based on the socket buffer size.
+#define PACKET_RING_BLOCK_SIZE (1 << 20)
+#define PACKET_RING_MIN_BLOCKS 8
+#define PACKET_RING_BLOCK_TIMEOUT_MS 10
+
+// Not defined by older C libraries (linux 3.11 and 5.11)
+#ifndef SO_BUSY_POLL
+#define SO_BUSY_POLL 46
+#endif
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL 69
+#endif
+
+// Reports the socket's drop count with each datagram (linux 2.6.33), also not defined by older C libraries
+#ifndef SO_RXQ_OVFL
+#define SO_RXQ_OVFL 40
+#endif
+#define RXQ_OVFL_CONTROL_SIZE CMSG_SPACE(sizeof(uint32_t))
+
+// Reports the time each datagram was received in nanoseconds (linux 2.6.22)
+#ifndef SO_TIMESTAMPNS
+#define SO_TIMESTAMPNS 35
+#endif
+#ifndef SCM_TIMESTAMPNS
+#define SCM_TIMESTAMPNS SO_TIMESTAMPNS
+#endif
+#define TIMESTAMP_CONTROL_SIZE CMSG_SPACE(sizeof(struct timespec))
+
+// UDP generic receive offload (linux 5.0), also not defined by older C libraries
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+// The epoll data of the event that wakes runStreams to pick up added and removed streams, the others carry their lane
+#define STREAMS_WAKE_EVENT 0xffffffff
+
+// A coalesced datagram is at most 64KB, each recvmmsg call reads up to this many of them
+#define UDP_GRO_BUFFER_SIZE 65536
+#define UDP_GRO_MAX_MSGS 64
+
+/**
+ * Returns the monotonic clock in nanoseconds, used to time the socket reader's waits.
+ */
+static inline uint64_t monotonicNs() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+
+/**
+ * Returns the number of packets the interface has dropped, read from sysfs, or -1 if it could not be read.
+ */
+static int64_t get_rx_dropped(std::string interface, LOGGER _log=LOGGER()) {
+    if (!_log) {
+        _log = rh_logger::Logger::getLogger("SourceSDDS_utils");
+        RH_DEBUG(_log, "get_rx_dropped method passed null logger; creating logger "<<_log->getName());
+    } else {
+        RH_DEBUG(_log, "get_rx_dropped method passed valid logger "<<_log->getName());
+    }
+
+	if (interface.empty()) {
+		RH_DEBUG(_log, "get_rx_dropped: Interface provided is empty, cannot get rx_dropped statistics");
+		return 0;
+	}
+
+	FILE* fp;
+	char buffer[1024];
+	size_t bytes_read;
+
+	std::stringstream ss;
+	ss << "/sys/class/net/" << interface << "/statistics/rx_dropped";
+
+	fp = fopen(ss.str().c_str(), "r");
+	if (!fp) {
+		RH_DEBUG(_log, "get_rx_dropped: Failed to open " << ss.str());
+		return -1;
+	}
+	bytes_read = fread(buffer, 1, sizeof (buffer), fp);
+	fclose (fp);
+
+	/* Bail if read failed or if buffer isn't big enough.  */
+	if (bytes_read == 0 || bytes_read == sizeof (buffer)) {
+	 return -1;
+	}
+
+	/* NUL-terminate the text.  */
+	buffer[bytes_read] = '\0';
+
+	return atol(buffer);
+}
 
 /**
  * Creates the socket reader with default options set. You must set the connection info prior to starting the run
  * method.
  */
-SocketReader::SocketReader(): m_shuttingDown(false), m_running(false), m_timeout(1), m_pkts_per_read(1), m_socket_buffer_size(-1) {
+SocketReader::SocketReader(): m_shuttingDown(false), m_running(false), m_timeout(1), m_pkts_per_read(1), m_socket_buffer_size(-1),
+	m_port(0), m_read_backend(READ_BACKEND::RECVMMSG), m_active_read_backend(READ_BACKEND::RECVMMSG), m_lane(0), m_num_lanes(1),
+	m_udp_gro(false), m_active_udp_gro(false), m_wait_strategy(WAIT_STRATEGY::POLL), m_spin_budget_us(50), m_overflow_policy(OVERFLOW_POLICY::BLOCK), m_active_overflow_policy(OVERFLOW_POLICY::BLOCK),
+	m_packet_filter(false), m_filter_attached(false), m_rxq_ovfl(false), m_socket_inode(0),
+	m_status_interval_ms(DEFAULT_STATUS_INTERVAL_MS), m_next_publish(0), m_pktbuffer(NULL),
+	m_timestamps(false), m_active_timestamps(false), m_streams_changed(false), m_streams_requested(0), m_streams_applied(0),
+	m_epoll_fd(-1), m_wake_fd(-1), m_next_diag(0), m_diag_rx_queue(0), m_diag_listeners(0), m_diag_nic_rx_dropped(0) {
 	_log = rh_logger::Logger::getLogger("SocketReader");
 	RH_DEBUG(_log,"SocketReader constructor - Set logger to "<< _log->getName());
 	memset(&m_multicast_connection, 0, sizeof(m_multicast_connection));
 	memset(&m_unicast_connection, 0, sizeof(m_unicast_connection));
 	m_host_addr.s_addr = 0;
+	memset(&m_filter, 0, sizeof(m_filter));
+	m_filter.complex = -1;
+	memset(&m_counters, 0, sizeof(m_counters));
 }
 
 /**
- * Calls the shutdown method and exits.
+ * Calls the shutdown method and closes the socket if the run method never got the chance to.
  */
 SocketReader::~SocketReader() {
 	shutDown();
+	if (m_multicast_connection.sock) { multicast_close(m_multicast_connection); }
+	if (m_unicast_connection.sock) { unicast_close(m_unicast_connection); }
+	clearStreams();
 }
 
 void SocketReader::setLogger(LOGGER log) {
@@ -95,6 +210,317 @@ size_t SocketReader::getPktsPerRead() {
 	return m_pkts_per_read;
 }
 
+/**
+ * Sets the method used to pull packets off of the network, either recvmmsg on the UDP socket (the default),
+ * a PACKET_MMAP TPACKET_V3 ring or an io_uring multishot recvmsg. This cannot be changed once the thread is up and running.
+ */
+void SocketReader::setReadBackend(std::string backend) {
+	if (m_running) {
+		RH_WARN(_log, "Cannot change the read backend while the socket reader thread is running");
+		return;
+	}
+
+	if (backend != READ_BACKEND::RECVMMSG && backend != READ_BACKEND::PACKET_MMAP && backend != READ_BACKEND::IO_URING) {
+		RH_WARN(_log, "Unknown socket read backend: " << backend << " using " << READ_BACKEND::RECVMMSG);
+		backend = READ_BACKEND::RECVMMSG;
+	}
+
+	m_read_backend = backend;
+}
+
+/**
+ * Returns the read backend actually in use. This may differ from the requested backend if the
+ * requested backend could not be setup and the socket reader fell back to recvmmsg.
+ */
+std::string SocketReader::getReadBackend() {
+	return (m_running) ? m_active_read_backend : m_read_backend;
+}
+
+/**
+ * Enables UDP generic receive offload on the recvmmsg backend, see runUdpGro. If the kernel does not support
+ * UDP_GRO the plain recvmmsg loop is used. This cannot be changed once the thread is up and running.
+ */
+void SocketReader::setUdpGro(bool udp_gro) {
+	if (m_running) {
+		RH_WARN(_log, "Cannot change UDP GRO while the socket reader thread is running");
+		return;
+	}
+	m_udp_gro = udp_gro;
+}
+
+/**
+ * Returns true if UDP GRO is requested or, while running, if it is actually in use.
+ */
+bool SocketReader::getUdpGro() {
+	return (m_running) ? m_active_udp_gro : m_udp_gro;
+}
+
+/**
+ * Sets how the recvmmsg backend waits when a read finds the socket empty, see waitForData. The spin budget is
+ * how long the spin_then_poll and busy_poll strategies keep reading before sleeping in poll.
+ * This cannot be changed once the thread is up and running.
+ */
+void SocketReader::setWaitStrategy(std::string strategy, unsigned int spin_budget_us) {
+	if (m_running) {
+		RH_WARN(_log, "Cannot change the wait strategy while the socket reader thread is running");
+		return;
+	}
+
+	if (strategy != WAIT_STRATEGY::POLL && strategy != WAIT_STRATEGY::SPIN && strategy != WAIT_STRATEGY::SPIN_THEN_POLL && strategy != WAIT_STRATEGY::BUSY_POLL) {
+		RH_WARN(_log, "Unknown socket wait strategy: " << strategy << " using " << WAIT_STRATEGY::POLL);
+		strategy = WAIT_STRATEGY::POLL;
+	}
+
+	m_wait_strategy = strategy;
+	m_spin_budget_us = spin_budget_us;
+}
+
+/**
+ * Returns the wait strategy used by the recvmmsg backend.
+ */
+std::string SocketReader::getWaitStrategy() {
+	return m_wait_strategy;
+}
+
+/**
+ * Sets what the socket reader does when the SDDS to BulkIO thread has fallen behind and there are no empty buffers
+ * left to read into. block waits for the SDDS to BulkIO thread to recycle some, meanwhile the packets queue up in the
+ * socket buffer and, once that is full, are dropped by the kernel. drop_newest keeps reading and throws away the
+ * packets just read, reusing their buffers. drop_oldest takes back the oldest full buffers the SDDS to BulkIO thread
+ * has not started on yet, throwing away their packets, which cannot be done with the lock free buffer so it drops the
+ * newest there instead, see getOverflowPolicy. Neither drop policy ever blocks the socket reader and the packets they
+ * throw away are counted. This cannot be changed once the thread is up and running.
+ */
+void SocketReader::setOverflowPolicy(std::string policy) {
+	if (m_running) {
+		RH_WARN(_log, "Cannot change the overflow policy while the socket reader thread is running");
+		return;
+	}
+
+	if (policy != OVERFLOW_POLICY::BLOCK && policy != OVERFLOW_POLICY::DROP_NEWEST && policy != OVERFLOW_POLICY::DROP_OLDEST) {
+		RH_WARN(_log, "Unknown overflow policy: " << policy << " using " << OVERFLOW_POLICY::BLOCK);
+		policy = OVERFLOW_POLICY::BLOCK;
+	}
+
+	m_overflow_policy = policy;
+}
+
+/**
+ * Returns the overflow policy actually in use. While running this is drop_newest if drop_oldest was requested with the
+ * lock free buffer, whose full buffers cannot be taken back.
+ */
+std::string SocketReader::getOverflowPolicy() {
+	return (m_running) ? m_active_overflow_policy : m_overflow_policy;
+}
+
+/**
+ * Returns the total time, in seconds, spent spinning on an empty socket as last published, see getMetrics.
+ */
+double SocketReader::getSpinTime() {
+	return getMetrics().spin_time;
+}
+
+/**
+ * Returns the total time, in seconds, spent sleeping in poll as last published, see getMetrics.
+ */
+double SocketReader::getPollTime() {
+	return getMetrics().poll_time;
+}
+
+/**
+ * Returns the number of times the socket reader has slept in poll as last published, see getMetrics.
+ */
+uint64_t SocketReader::getNumPolls() {
+	return getMetrics().num_polls;
+}
+
+/**
+ * Screens the packets on the socket with a kernel socket filter, see sdds_filter.h. Packets that are not SDDS sized,
+ * that do not come from sender or whose header does not match the bits per sample or complex setting are turned away
+ * before they are copied to user space. An empty sender, a bps of zero and a complex setting of any accept everything
+ * in that field. The rejected packets still arrive as empty datagrams which are counted and skipped.
+ * Must be called before setConnectionInfo and cannot be called after the socket reader has started.
+ */
+void SocketReader::setPacketFilter(bool enabled, std::string sender, unsigned int bps, std::string complex) {
+	if (m_running) {
+		RH_WARN(_log, "Cannot change the packet filter while the socket reader thread is running");
+		return;
+	}
+
+	m_packet_filter = enabled;
+	memset(&m_filter, 0, sizeof(m_filter));
+	m_filter.length = SDDS_PACKET_SIZE;
+
+	if (not sender.empty() && inet_aton(sender.c_str(), &m_filter.source) == 0) {
+		RH_WARN(_log, "Could not parse the packet filter sender: " << sender << " packets from any sender will be accepted");
+		m_filter.source.s_addr = INADDR_ANY;
+	}
+
+	// The header field only has five bits, 32 bits per sample is sent as 31
+	if (bps != 0 && bps != 8 && bps != 16 && bps != 32) {
+		RH_WARN(_log, "The packet filter bits per sample must be 8, 16, 32 or 0 for any, got: " << bps << " packets of any bits per sample will be accepted");
+		bps = 0;
+	}
+	m_filter.bps = (bps == 32) ? 31 : bps;
+
+	if (complex == PACKET_FILTER_COMPLEX::REAL) {
+		m_filter.complex = 0;
+	} else if (complex == PACKET_FILTER_COMPLEX::COMPLEX) {
+		m_filter.complex = 1;
+	} else {
+		if (complex != PACKET_FILTER_COMPLEX::ANY) {
+			RH_WARN(_log, "Unknown packet filter complex setting: " << complex << " using " << PACKET_FILTER_COMPLEX::ANY);
+		}
+		m_filter.complex = -1;
+	}
+}
+
+/**
+ * Returns the number of packets turned away by the packet filter since the socket reader started as last published,
+ * see getMetrics.
+ */
+uint64_t SocketReader::getNumRejected() {
+	return getMetrics().num_rejected;
+}
+
+/**
+ * Records the time each packet was received by the kernel with the packet's buffer, see
+ * SmartPacketBuffer::set_timestamp. The io_uring backend does not support this.
+ * This cannot be changed once the thread is up and running.
+ */
+void SocketReader::setReceiveTimestamps(bool timestamps) {
+	if (m_running) {
+		RH_WARN(_log, "Cannot change receive time stamps while the socket reader thread is running");
+		return;
+	}
+	m_timestamps = timestamps;
+}
+
+/**
+ * Returns true if receive time stamps are requested.
+ */
+bool SocketReader::getReceiveTimestamps() {
+	return m_timestamps;
+}
+
+/**
+ * Returns the number of packets the kernel dropped because the socket buffer was full, as last reported with a received
+ * packet and then published, see getMetrics. Only the recvmmsg backend, with or without UDP GRO, keeps track of this.
+ */
+uint64_t SocketReader::getSocketDrops() {
+	return getMetrics().socket_drops;
+}
+
+/**
+ * Returns the inode of the socket this reader reads, or of the first stream's socket, which identifies it among the
+ * sockets bound to the same address and port, see udp_diag.h. Zero if no socket has been opened.
+ */
+uint64_t SocketReader::getSocketInode() {
+	return m_socket_inode;
+}
+
+uint64_t SocketReader::socketInode(int socket) {
+	struct stat st;
+	if (fstat(socket, &st) != 0) {
+		return 0;
+	}
+	return st.st_ino;
+}
+
+/**
+ * Sets how often, in milliseconds, the reader thread publishes its status, see getMetrics. An idle reader still
+ * wakes up to publish at least every 100 ms. Can be changed while running.
+ */
+void SocketReader::setStatusInterval(unsigned int interval_ms) {
+	m_status_interval_ms = interval_ms;
+}
+
+/**
+ * Returns the status last published by the reader thread. Never touches anything the reader thread is working on so
+ * it is safe to call from any thread. The socket's queue, sampled with sock_diag, and the NIC's drop count, read from
+ * sysfs, are sampled here by the reader of lane 0 rather than on the reader thread, at most once a status interval
+ * whatever the rate of calls, so polling the status often costs no more than copying the last samples.
+ */
+socket_reader_metrics_t SocketReader::getMetrics() {
+	socket_reader_metrics_t metrics = m_metrics.read();
+	if (m_lane != 0) {
+		return metrics;
+	}
+
+	boost::unique_lock<boost::mutex> lock(m_diag_lock);
+	uint64_t now = monotonicNs();
+	if (now >= m_next_diag && not m_ip.empty()) {
+		m_next_diag = now + m_status_interval_ms * 1000000ULL;
+		udp_diag_t diag;
+		udp_diag_query(m_ip.c_str(), m_port, m_socket_inode, diag, _log);
+		m_diag_rx_queue = diag.rx_queue;
+		m_diag_listeners = diag.listeners;
+		m_diag_nic_rx_dropped = get_rx_dropped(m_interface, _log);
+	}
+	metrics.rx_queue = m_diag_rx_queue;
+	metrics.listeners = m_diag_listeners;
+	metrics.nic_rx_dropped = m_diag_nic_rx_dropped;
+	return metrics;
+}
+
+/**
+ * Publishes the reader's status once the status interval has passed since the last time, or straight away if idle
+ * is set which is done just before the reader blocks waiting for packets so the status is current while nothing is
+ * arriving. Only copies the reader's own counters and the packet buffer occupancy, see getMetrics for the rest.
+ */
+void SocketReader::publishMetrics(bool idle) {
+	uint64_t now = monotonicNs();
+	bool due = (now >= m_next_publish);
+	if (not due && not idle) {
+		return;
+	}
+
+	if (due) {
+		m_next_publish = now + m_status_interval_ms * 1000000ULL;
+	}
+
+	m_sampled.packets = m_counters.packets;
+	m_sampled.bytes = m_counters.bytes;
+	m_sampled.reads = m_counters.reads;
+	m_sampled.empty_reads = m_counters.empty_reads;
+	m_sampled.buffer_wait_time = m_counters.buffer_wait_ns / 1e9;
+	m_sampled.overflow_drops = m_counters.overflow_drops;
+	m_sampled.spin_time = m_counters.spin_ns / 1e9;
+	m_sampled.poll_time = m_counters.poll_ns / 1e9;
+	m_sampled.num_polls = m_counters.num_polls;
+	m_sampled.num_rejected = m_counters.num_rejected;
+	m_sampled.socket_drops = m_counters.socket_drops;
+	if (m_pktbuffer) {
+		m_sampled.full_buffers = m_pktbuffer->get_num_full_buffers();
+		m_sampled.empty_buffers = m_pktbuffer->get_num_empty_buffers();
+	}
+	m_metrics.publish(m_sampled);
+}
+
+/**
+ * Sets which of num_lanes socket readers this is. When there is more than one, every reader opens its own socket on
+ * the same address and port with SO_REUSEPORT and the packets are split between the sockets by the CPU that received
+ * them, see reuseport.h. The packets received on cpus[lane] are read by this reader so it should be pinned to that CPU.
+ * Full buffers are pushed to, and empty buffers taken from, this reader's lane of the packet buffer.
+ * Must be called before setConnectionInfo and cannot be called after the socket reader has started.
+ */
+void SocketReader::setLane(size_t lane, size_t num_lanes, const std::vector<int> &cpus) {
+	if (m_running) {
+		RH_WARN(_log, "Cannot change the socket reader lane while the socket reader thread is running");
+		return;
+	}
+	m_num_lanes = (num_lanes) ? num_lanes : 1;
+	m_lane = (lane < m_num_lanes) ? lane : 0;
+	m_lane_cpus = cpus;
+}
+
+/**
+ * Returns the lane of the packet buffer this socket reader fills.
+ */
+size_t SocketReader::getLane() {
+	return m_lane;
+}
+
 /**
  * Sets up and opens the socket based on the provided interfance, IP, vlan, and port. If there are issues
  * setting up the socket a BadParameterError is thrown and the problem logged.
@@ -117,6 +543,76 @@ void SocketReader::setConnectionInfo(std::string interface, std::string ip, uint
 	if (m_multicast_connection.sock) { multicast_close(m_multicast_connection); 	memset(&m_multicast_connection, 0, sizeof(m_multicast_connection)); }
 	if (m_unicast_connection.sock) { unicast_close(m_unicast_connection); 			memset(&m_unicast_connection, 0, sizeof(m_unicast_connection)); }
 
+	std::string requested_interface = interface;
+	int socket = openSocket(interface, ip, vlan, port, m_multicast_connection, m_unicast_connection, m_num_lanes > 1);
+
+	// A coalesced UDP GRO buffer is longer than a packet so only the sender and header can be screened
+	sdds_filter_t filter = m_filter;
+	if (m_udp_gro) {
+		filter.length = 0;
+	}
+	struct sock_filter screen[SDDS_FILTER_MAX_LEN];
+	struct sock_fprog screen_prog;
+	screen_prog.len = sdds_filter_program(&filter, screen);
+	screen_prog.filter = screen;
+	m_filter_attached = false;
+
+	if (m_num_lanes > 1) {
+		const int *cpus = (m_lane_cpus.empty()) ? NULL : &m_lane_cpus[0];
+		if (m_multicast_connection.sock) {
+			// Every socket gets a copy of each multicast packet, without the filter each would be read num_lanes times.
+			// A socket only has one filter so the packet filter, if any, runs on the packets the CPU filter lets through.
+			try {
+				reuseport_filter_by_cpu(socket, cpus, m_lane_cpus.size(), m_num_lanes, m_lane, (m_packet_filter) ? &screen_prog : NULL, _log);
+				m_filter_attached = m_packet_filter;
+			} catch (BadParameterError &e) {
+				multicast_close(m_multicast_connection);
+				memset(&m_multicast_connection, 0, sizeof(m_multicast_connection));
+				throw;
+			}
+		} else if (m_lane == 0) {
+			try {
+				reuseport_steer_by_cpu(socket, cpus, m_lane_cpus.size(), m_num_lanes, _log);
+			} catch (BadParameterError &e) {
+				RH_WARN(_log, "Could not steer packets by CPU, the kernel will spread them across the socket readers by flow instead");
+			}
+		}
+	}
+
+	if (m_packet_filter && not m_filter_attached) {
+		try {
+			sdds_filter_attach(socket, &filter, _log);
+			m_filter_attached = true;
+		} catch (BadParameterError &e) {
+			RH_WARN(_log, "Could not attach the packet filter, packets will not be screened " << e.what());
+		}
+	}
+
+	RH_INFO(_log, "Set connection interface: " << interface << " IP: " << ip << " Port: " << port << " VLAN: " << vlan);
+	boost::unique_lock<boost::mutex> diag_lock(m_diag_lock);
+	m_interface = interface;
+	m_ip = ip;
+	m_port = port;
+	m_socket_inode = socketInode(socket);
+	m_next_diag = 0;
+	diag_lock.unlock();
+
+	// The chosen interface has the vlan stripped off, the packet ring needs to capture on the vlan interface itself.
+	if (vlan) {
+		std::stringstream ss;
+		ss << requested_interface << "." << vlan;
+		m_capture_interface = ss.str();
+	} else {
+		m_capture_interface = interface;
+	}
+}
+
+/**
+ * Opens the multicast or unicast socket, depending on the address, for the given connection info into the provided
+ * connection structs and returns it. If the interface is empty, or a vlan is given, it is updated to the interface
+ * that was actually chosen. Throws a BadParameterError if the socket could not be created.
+ */
+int SocketReader::openSocket(std::string &interface, std::string ip, uint16_t vlan, uint16_t port, multicast_t &multicast, unicast_t &unicast, bool reuse_port) throw (BadParameterError) {
 	in_addr_t lowMulti = inet_network("224.0.0.0");
 	in_addr_t highMulti = inet_network("239.255.255.255");
 
@@ -132,24 +628,139 @@ void SocketReader::setConnectionInfo(std::string interface, std::string ip, uint
 		if (interface.empty()) {
 			interface = getMcastIfaceFromRoutes(ip);
 		}
-		m_multicast_connection = multicast_client(interface.c_str(), ip.c_str(), port, interface, _log);
+		multicast = multicast_client(interface.c_str(), ip.c_str(), port, interface, _log, reuse_port);
 	} else {
-		m_unicast_connection = unicast_client(interface.c_str(), ip.c_str(), port, interface, _log);
+		unicast = unicast_client(interface.c_str(), ip.c_str(), port, interface, _log, reuse_port);
 	}
 
-	int socket = (m_multicast_connection.sock != 0) ? (m_multicast_connection.sock) : (m_unicast_connection.sock);
+	int socket = (multicast.sock != 0) ? (multicast.sock) : (unicast.sock);
 
 	if (socket < 0) {
-		memset(&m_multicast_connection, 0, sizeof(m_multicast_connection));
-		memset(&m_unicast_connection, 0, sizeof(m_unicast_connection));
+		memset(&multicast, 0, sizeof(multicast));
+		memset(&unicast, 0, sizeof(unicast));
 
 		std::stringstream ss;
 		ss << "Could not create socket, please check the parameters provided: Interface: " << interface << " IP: " << ip << " Port: " << port << " VLAN: " << vlan;
 		RH_ERROR(_log, ss.str());
 		throw BadParameterError(ss.str());
 	}
-	RH_INFO(_log, "Set connection interface: " << interface << " IP: " << ip << " Port: " << port << " VLAN: " << vlan);
-	m_interface = interface;
+
+	return socket;
+}
+
+/**
+ * Adds an attached stream to be read by this socket reader into the given lane of the packet buffer. Once any stream
+ * has been added the run method serves the sockets of all of the added streams from a single epoll loop rather than
+ * the socket set by setConnectionInfo, this is only supported with the recvmmsg backend. The packet filter, if any,
+ * is attached to each stream's socket. The socket is opened here, on the calling thread, so a stream added while
+ * runStreams is serving is simply handed over and picked up on its next pass without disturbing the other streams.
+ */
+void SocketReader::addStream(std::string interface, std::string ip, uint16_t vlan, uint16_t port, size_t lane) throw (BadParameterError) {
+	if (ip.empty()) {
+		std::stringstream ss;
+		ss << "IP address is empty, it must be provided.";
+		RH_ERROR(_log, ss.str());
+		throw BadParameterError(ss.str());
+	}
+
+	StreamSocket stream;
+	memset(&stream.multicast, 0, sizeof(stream.multicast));
+	memset(&stream.unicast, 0, sizeof(stream.unicast));
+	stream.sock = openSocket(interface, ip, vlan, port, stream.multicast, stream.unicast, false);
+	stream.lane = lane;
+	stream.filter_attached = false;
+	stream.host_addr.s_addr = 0;
+
+	if (m_packet_filter) {
+		try {
+			sdds_filter_attach(stream.sock, &m_filter, _log);
+			stream.filter_attached = true;
+		} catch (BadParameterError &e) {
+			RH_WARN(_log, "Could not attach the packet filter, packets will not be screened " << e.what());
+		}
+	}
+
+	RH_INFO(_log, "Added stream interface: " << interface << " IP: " << ip << " Port: " << port << " VLAN: " << vlan << " on lane: " << lane);
+	boost::unique_lock<boost::mutex> lock(m_streams_lock);
+	if (m_epoll_fd >= 0) {
+		m_added_streams.push_back(stream);
+		m_streams_changed = true;
+		++m_streams_requested;
+		wakeStreams();
+		return;
+	}
+
+	if (m_streams.empty()) {
+		boost::unique_lock<boost::mutex> diag_lock(m_diag_lock);
+		m_interface = interface;
+		m_ip = ip;
+		m_port = port;
+		m_socket_inode = socketInode(stream.sock);
+		m_next_diag = 0;
+	}
+	m_streams.push_back(stream);
+}
+
+/**
+ * Removes the stream read into the given lane and closes its socket. While runStreams is serving the streams this
+ * waits for it to take the socket out of its epoll set and let go of the stream's buffers, from then on the reader
+ * never touches the lane so it can be reset and handed to another stream. The other streams are not disturbed.
+ */
+void SocketReader::removeStream(size_t lane) {
+	boost::unique_lock<boost::mutex> lock(m_streams_lock);
+	if (m_epoll_fd >= 0) {
+		m_removed_lanes.push_back(lane);
+		m_streams_changed = true;
+		uint64_t request = ++m_streams_requested;
+		wakeStreams();
+		while (m_epoll_fd >= 0 && m_streams_applied < request) {
+			m_streams_updated.wait(lock);
+		}
+	}
+
+	// Not being served, or runStreams returned before it got to the stream
+	for (size_t i = 0; i < m_streams.size(); ++i) {
+		if (m_streams[i].lane == lane) {
+			closeStream(m_streams[i]);
+			m_streams.erase(m_streams.begin() + i);
+			break;
+		}
+	}
+}
+
+/**
+ * Closes the sockets of any streams added with addStream, the run method goes back to reading the socket set by
+ * setConnectionInfo. This method cannot be called after the socket reader has started.
+ */
+void SocketReader::clearStreams() {
+	if (m_running) {
+		RH_WARN(_log, "Cannot remove the streams while the socket reader thread is running");
+		return;
+	}
+
+	boost::unique_lock<boost::mutex> lock(m_streams_lock);
+	for (size_t i = 0; i < m_streams.size(); ++i) {
+		closeStream(m_streams[i]);
+	}
+	m_streams.clear();
+}
+
+/**
+ * Closes a stream's socket.
+ */
+void SocketReader::closeStream(StreamSocket &stream) {
+	if (stream.multicast.sock) { multicast_close(stream.multicast); }
+	if (stream.unicast.sock) { unicast_close(stream.unicast); }
+	memset(&stream.multicast, 0, sizeof(stream.multicast));
+	memset(&stream.unicast, 0, sizeof(stream.unicast));
+}
+
+/**
+ * Returns the number of streams added with addStream.
+ */
+size_t SocketReader::getNumStreams() {
+	boost::unique_lock<boost::mutex> lock(m_streams_lock);
+	return m_streams.size() + m_added_streams.size();
 }
 
 /**
@@ -191,33 +802,135 @@ std::string SocketReader::getInterface() {
  * Full packet buffers will be placed back into the pktbuffer's full buffer container for the SDDS to BulkIO
  * processor to consume.
  */
-void SocketReader::run(SmartPacketBuffer<SDDSpacket> *pktbuffer, const bool confirmHosts) {
+void SocketReader::run(SmartPacketBuffer<SDDSheader> *pktbuffer, const bool confirmHosts) {
 	RH_DEBUG(_log, "Starting to run");
 	pthread_setname_np(pthread_self(), "SocketReader");
+	m_active_overflow_policy = m_overflow_policy;
+	if (m_overflow_policy == OVERFLOW_POLICY::DROP_OLDEST && pktbuffer->is_lock_free()) {
+		RH_WARN(_log, "Full buffers cannot be taken back from the lock free buffer, using the " << OVERFLOW_POLICY::DROP_NEWEST << " overflow policy rather than " << OVERFLOW_POLICY::DROP_OLDEST);
+		m_active_overflow_policy = OVERFLOW_POLICY::DROP_NEWEST;
+	}
 	m_shuttingDown = false;
 	m_running = true;
-	struct pollfd poll_struct[1];
-	errno = 0;
+	memset(&m_counters, 0, sizeof(m_counters));
+	m_pktbuffer = (m_lane == 0) ? pktbuffer : NULL;
+	memset(&m_sampled, 0, sizeof(m_sampled));
+	m_next_publish = 0;
+	publishMetrics(true);
 
 	int socket = (m_multicast_connection.sock != 0) ? (m_multicast_connection.sock) : (m_unicast_connection.sock);
+	bool done = false;
 
-	poll_struct[0].events = POLLIN | POLLERR | POLLHUP;
-	poll_struct[0].fd = socket;
+	boost::unique_lock<boost::mutex> streams_lock(m_streams_lock);
+	const bool serve_streams = not m_streams.empty();
+	streams_lock.unlock();
 
-	// While a blocking socket is more simple / nicer, it forces the thread into a sleep state which can
-	// cause a thread context switch. This thread has a need for speed!
-	if (not setSocketBlockingEnabled(socket, false)) {
-		RH_ERROR(_log, "Error when setting the socket to non-blocking");
+	if (serve_streams) {
+		if (m_read_backend != READ_BACKEND::RECVMMSG || m_udp_gro) {
+			RH_WARN(_log, "Only the " << READ_BACKEND::RECVMMSG << " backend without UDP GRO can serve more than one attached stream, using it");
+		}
+		m_active_read_backend = READ_BACKEND::RECVMMSG;
+		m_active_udp_gro = false;
+		runStreams(pktbuffer, confirmHosts);
+		done = true;
+	} else if (m_read_backend == READ_BACKEND::PACKET_MMAP) {
+		done = runPacketRing(pktbuffer, confirmHosts, socket);
+	} else if (m_read_backend == READ_BACKEND::IO_URING) {
+		done = runIoUring(pktbuffer, confirmHosts, socket);
 	}
 
-    std::deque<SddsPacketPtr> bufQue;
-    int pktsReadThisPass = 0;
-    size_t i;
+	if (not done) {
+		if (m_read_backend != READ_BACKEND::RECVMMSG) {
+			RH_WARN(_log, "Could not setup the " << m_read_backend << " backend, falling back to " << READ_BACKEND::RECVMMSG);
+		}
+		m_active_read_backend = READ_BACKEND::RECVMMSG;
+		m_active_udp_gro = false;
+		if (not m_udp_gro || not runUdpGro(pktbuffer, confirmHosts, socket)) {
+			runRecvmmsg(pktbuffer, confirmHosts, socket);
+		}
+	}
 
-    struct mmsghdr msgs[m_pkts_per_read];
-    struct iovec iovecs[m_pkts_per_read];
-	sockaddr_in source_addrs[m_pkts_per_read];
+	publishMetrics(true);
+	m_running = false;
+
+	RH_DEBUG(_log, "Closing socket");
+	if (m_multicast_connection.sock) { multicast_close(m_multicast_connection); 	memset(&m_multicast_connection, 0, sizeof(m_multicast_connection)); }
+	if (m_unicast_connection.sock) { unicast_close(m_unicast_connection); 			memset(&m_unicast_connection, 0, sizeof(m_unicast_connection)); }
+	clearStreams();
+}
+
+/**
+ * Sets SO_RXQ_OVFL on the UDP socket so every datagram comes with a control message holding the number of packets the
+ * socket has dropped so far, see readControl. The per CPU filter of a multicast socket reader discards packets which
+ * the kernel counts as drops too so it is left off when there is more than one multicast socket reader.
+ */
+void SocketReader::applyRxqOvfl(int socket) {
+	m_rxq_ovfl = false;
+	if (m_num_lanes > 1 && m_multicast_connection.sock) {
+		return;
+	}
+
+	int one = 1;
+	if (setsockopt(socket, SOL_SOCKET, SO_RXQ_OVFL, &one, sizeof(one)) != 0) {
+		RH_WARN(_log, "Failed to set SO_RXQ_OVFL on the socket, errno: " << errno << " the socket buffer drops will not be counted");
+		errno = 0;
+		return;
+	}
+	m_rxq_ovfl = true;
+}
+
+/**
+ * Sets SO_TIMESTAMPNS on the UDP socket, if receive time stamps were requested, so every datagram comes with a control
+ * message holding the time the kernel received it.
+ */
+void SocketReader::applyTimestamps(int socket) {
+	m_active_timestamps = false;
+	if (not m_timestamps) {
+		return;
+	}
+
+	int one = 1;
+	if (setsockopt(socket, SOL_SOCKET, SO_TIMESTAMPNS, &one, sizeof(one)) != 0) {
+		RH_WARN(_log, "Failed to set SO_TIMESTAMPNS on the socket, errno: " << errno << " packets will not be time stamped");
+		errno = 0;
+		return;
+	}
+	m_active_timestamps = true;
+}
 
+/**
+ * Reads the control messages of the first len messages of a recvmmsg batch and gives the space back to them, the
+ * kernel shrinks each control length to what it used. Each receive time stamp is stored with the packet's buffer.
+ * The kernel only adds the drop count once the socket has dropped something and the count is cumulative so without
+ * time stamps only the last message needs to be looked at.
+ */
+void SocketReader::readControl(SmartPacketBuffer<SDDSheader> *pktbuffer, std::deque<SddsPacketPtr> &bufQue, struct mmsghdr msgs[], size_t len, size_t control_size) {
+	for (size_t i = (m_active_timestamps) ? 0 : len - 1; i < len; ++i) {
+		for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg)) {
+			if (cmsg->cmsg_level != SOL_SOCKET) {
+				continue;
+			}
+			if (cmsg->cmsg_type == SO_RXQ_OVFL) {
+				uint32_t drops;
+				memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+				m_counters.socket_drops = drops;
+			} else if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+				struct timespec ts;
+				memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+				pktbuffer->set_timestamp(bufQue[i], (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+			}
+		}
+	}
+
+	for (size_t i = 0; i < len; ++i) {
+		msgs[i].msg_hdr.msg_controllen = control_size;
+	}
+}
+
+/**
+ * Applies the requested socket buffer size to the UDP socket and reads back the size the kernel actually gave us.
+ */
+void SocketReader::applySocketBufferSize(int socket) {
     if (m_socket_buffer_size) {
     	if (setsockopt(socket, SOL_SOCKET, SO_RCVBUF, &m_socket_buffer_size, sizeof(m_socket_buffer_size)) != 0) {
     		RH_WARN(_log, "Failed to set socket buffer size to the requested size: " << m_socket_buffer_size);
@@ -226,45 +939,230 @@ void SocketReader::run(SmartPacketBuffer<SDDSpacket> *pktbuffer, const bool conf
 
     socklen_t optlen = sizeof(m_socket_buffer_size);
     getsockopt(socket, SOL_SOCKET, SO_RCVBUF, &m_socket_buffer_size, &optlen);
+}
+
+/**
+ * Asks the kernel to busy poll the NIC receive queue for up to the spin budget on each read of the socket, preferring
+ * busy polling over interrupts while we keep reading. Raising SO_BUSY_POLL above net.core.busy_read needs CAP_NET_ADMIN.
+ */
+void SocketReader::applyBusyPoll(int socket) {
+	int busy_poll = m_spin_budget_us;
+	if (setsockopt(socket, SOL_SOCKET, SO_BUSY_POLL, &busy_poll, sizeof(busy_poll)) != 0) {
+		RH_WARN(_log, "Failed to set SO_BUSY_POLL to " << busy_poll << "us, errno: " << errno << " reads will not busy poll the NIC");
+	}
+
+	int prefer = 1;
+	if (setsockopt(socket, SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer, sizeof(prefer)) != 0) {
+		RH_DEBUG(_log, "Failed to set SO_PREFER_BUSY_POLL, errno: " << errno);
+	}
+	errno = 0;
+}
+
+/**
+ * Called each time a read finds the socket empty, the caller tries reading again as soon as this returns.
+ * With the poll strategy we sleep in poll for up to 100ms until data arrives. With spin we return straight
+ * away so the caller keeps reading forever. With spin_then_poll and busy_poll we return straight away until
+ * we have been spinning for the spin budget and then sleep in poll. spin_start is when we started spinning and
+ * spin_last the time of the previous empty read while spinning, or zero if we were not spinning; the caller must
+ * add the time since spin_last to the spin time and reset it when data arrives.
+ */
+void SocketReader::waitForData(struct pollfd *poll_struct, uint64_t &spin_start, uint64_t &spin_last) {
+	if (m_wait_strategy != WAIT_STRATEGY::POLL) {
+		uint64_t now = monotonicNs();
+		if (spin_last) {
+			m_counters.spin_ns += now - spin_last;
+		} else {
+			spin_start = now;
+		}
+		spin_last = now;
+
+		if (m_wait_strategy == WAIT_STRATEGY::SPIN || now - spin_start < m_spin_budget_us * 1000ULL) {
+#if defined(__i386__) || defined(__x86_64__)
+			__asm__ __volatile__("pause");
+#endif
+			return;
+		}
+		spin_last = 0;
+	}
+
+	// Whatever was read before the socket ran dry goes out now rather than once the wait is over
+	publishMetrics(true);
+	uint64_t start = monotonicNs();
+	poll(poll_struct, 1, 100); // 100 ms max wait poll if no data is available.
+	m_counters.poll_ns += monotonicNs() - start;
+	++m_counters.num_polls;
+}
+
+/**
+ * Tops bufQue up to len empty buffers from this reader's lane of the packet buffer. Usually the lane has them to spare,
+ * otherwise the SDDS to BulkIO thread has fallen behind and we block until it recycles enough; that time is counted as
+ * buffer wait time and the status is published first so it does not go stale for as long as we are blocked.
+ */
+void SocketReader::popEmptyBuffers(SmartPacketBuffer<SDDSheader> *pktbuffer, std::deque<SddsPacketPtr> &bufQue, size_t len) {
+	pktbuffer->try_pop_empty_buffers(bufQue, len, m_lane);
+	if (bufQue.size() >= len) {
+		return;
+	}
+
+	publishMetrics(true);
+	uint64_t start = monotonicNs();
+	pktbuffer->pop_empty_buffers(bufQue, len, m_lane);
+	m_counters.buffer_wait_ns += monotonicNs() - start;
+}
+
+/**
+ * Tops bufQue up to len empty buffers from the lane without blocking, with the drop_oldest overflow policy taking back
+ * the lane's oldest full buffers if there are not enough empty ones. Returns true if bufQue now holds len buffers.
+ */
+bool SocketReader::reserveEmptyBuffers(SmartPacketBuffer<SDDSheader> *pktbuffer, std::deque<SddsPacketPtr> &bufQue, size_t len, size_t lane) {
+	pktbuffer->try_pop_empty_buffers(bufQue, len, lane);
+	if (bufQue.size() < len && m_active_overflow_policy == OVERFLOW_POLICY::DROP_OLDEST) {
+		m_counters.overflow_drops += pktbuffer->reclaim_full_buffers(bufQue, len - bufQue.size(), lane);
+	}
+	return bufQue.size() >= len;
+}
+
+/**
+ * Pushes the first num buffers of bufQue, which have just been filled, as full buffers and tops bufQue back up to
+ * m_pkts_per_read empty buffers, as set by the overflow policy. With block we wait for empty buffers once the full
+ * ones have been handed over. Otherwise the buffers to read into next are secured first and if there are not enough
+ * the newest of the packets just read are dropped, and their buffers read into again, so the socket reader never
+ * stalls. Either way bufQue is left holding exactly m_pkts_per_read buffers.
+ */
+void SocketReader::pushFullBuffers(SmartPacketBuffer<SDDSheader> *pktbuffer, std::deque<SddsPacketPtr> &bufQue, size_t num) {
+	if (m_active_overflow_policy == OVERFLOW_POLICY::BLOCK) {
+		pktbuffer->push_full_buffers(bufQue, num, m_lane);
+		popEmptyBuffers(pktbuffer, bufQue, m_pkts_per_read);
+		return;
+	}
+
+	if (not reserveEmptyBuffers(pktbuffer, bufQue, m_pkts_per_read + num, m_lane)) {
+		size_t keep = bufQue.size() - m_pkts_per_read;
+		std::rotate(bufQue.begin() + keep, bufQue.begin() + num, bufQue.end());
+		m_counters.overflow_drops += num - keep;
+		num = keep;
+	}
+	pktbuffer->push_full_buffers(bufQue, num, m_lane);
+}
+
+/**
+ * Counts a recvmmsg call that returned len messages, or failed if len is negative.
+ */
+void SocketReader::countReads(struct mmsghdr msgs[], int len) {
+	++m_counters.reads;
+	if (len <= 0) {
+		++m_counters.empty_reads;
+		return;
+	}
+
+	m_counters.packets += len;
+	for (int i = 0; i < len; ++i) {
+		m_counters.bytes += msgs[i].msg_len;
+	}
+}
+
+/**
+ * The default recvmmsg backend. The socket is non-blocking and read m_pkts_per_read packets at a time with recvmmsg,
+ * when no data is available we wait as set by the wait strategy before trying again.
+ */
+void SocketReader::runRecvmmsg(SmartPacketBuffer<SDDSheader> *pktbuffer, const bool confirmHosts, int socket) {
+	struct pollfd poll_struct[1];
+	errno = 0;
+
+	poll_struct[0].events = POLLIN | POLLERR | POLLHUP;
+	poll_struct[0].fd = socket;
+
+	// While a blocking socket is more simple / nicer, it forces the thread into a sleep state which can
+	// cause a thread context switch. This thread has a need for speed!
+	if (not setSocketBlockingEnabled(socket, false)) {
+		RH_ERROR(_log, "Error when setting the socket to non-blocking");
+	}
+
+    std::deque<SddsPacketPtr> bufQue;
+    int pktsReadThisPass = 0;
+    size_t i;
+
+    // If the payloads are split from the headers each message gets two iovecs, one for the header and one for the payload
+    const bool split = pktbuffer->is_split_payload();
+    const size_t iovs_per_msg = (split) ? 2 : 1;
+
+    struct mmsghdr msgs[m_pkts_per_read];
+    struct iovec iovecs[m_pkts_per_read * iovs_per_msg];
+	sockaddr_in source_addrs[m_pkts_per_read];
+
+	applySocketBufferSize(socket);
+	applyRxqOvfl(socket);
+	applyTimestamps(socket);
+	if (m_wait_strategy == WAIT_STRATEGY::BUSY_POLL) {
+		applyBusyPoll(socket);
+	}
+
+	// Room for the drop count and receive time each datagram may carry
+	const size_t control_size = ((m_rxq_ovfl) ? RXQ_OVFL_CONTROL_SIZE : 0) + ((m_active_timestamps) ? TIMESTAMP_CONTROL_SIZE : 0);
+	std::vector<uint8_t> control(m_pkts_per_read * control_size);
+
+	// When we started spinning on an empty socket and the time of the last empty read, zero when not spinning
+	uint64_t spin_start = 0, spin_last = 0;
 
 	memset(msgs, 0, sizeof(msgs));
 
 	// Fill our buffer with free packets
-	pktbuffer->pop_empty_buffers(bufQue, m_pkts_per_read);
+	popEmptyBuffers(pktbuffer, bufQue, m_pkts_per_read);
 
 	for (i = 0; i < m_pkts_per_read; i++) {
-		iovecs[i].iov_len          = SDDS_PACKET_SIZE;
-		iovecs[i].iov_base         = bufQue[i].get();
-		msgs[i].msg_hdr.msg_iov    = &iovecs[i];
-		msgs[i].msg_hdr.msg_iovlen = 1;
+		if (split) {
+			iovecs[2*i].iov_len        = SDDS_HEADER_SIZE;
+			iovecs[2*i+1].iov_len      = SDDS_DATA_SIZE;
+		} else {
+			iovecs[i].iov_len          = SDDS_PACKET_SIZE;
+		}
+		msgs[i].msg_hdr.msg_iov    = &iovecs[i * iovs_per_msg];
+		msgs[i].msg_hdr.msg_iovlen = iovs_per_msg;
 
 		if (confirmHosts) {
 			msgs[i].msg_hdr.msg_name = &source_addrs[i];
 			msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
 		}
+
+		if (control_size) {
+			msgs[i].msg_hdr.msg_control = &control[i * control_size];
+			msgs[i].msg_hdr.msg_controllen = control_size;
+		}
 	}
 
+	pointIovecs(pktbuffer, bufQue, iovecs, split);
+
 	RH_DEBUG(_log, "Entering socket read while loop");
     while (not m_shuttingDown) {
+		publishMetrics(false);
 
 		// Get packets, the MSG_DONTWAIT does nothing since we already set this to non-blocking socket. Same with the timeout.
 		pktsReadThisPass = recvmmsg(socket, msgs, m_pkts_per_read, MSG_DONTWAIT, NULL);
+		countReads(msgs, pktsReadThisPass);
 
 		switch(errno) {
 		case 0: // This is the happy path, things went really well.
+			if (spin_last) {
+				m_counters.spin_ns += monotonicNs() - spin_last;
+				spin_last = 0;
+			}
 
-			// I don't think doing this in a single call would help any, we still need to protect two queues.
-			// Push the packets onto the queue that we've received.
-			pktbuffer->push_full_buffers(bufQue, pktsReadThisPass);
+			if (control_size && pktsReadThisPass > 0) {
+				readControl(pktbuffer, bufQue, msgs, pktsReadThisPass, control_size);
+			}
 
-			// Fill our buffer with free packets
-			pktbuffer->pop_empty_buffers(bufQue, m_pkts_per_read);
+			// I don't think doing this in a single call would help any, we still need to protect two queues.
+			// Push the packets onto the queue that we've received and fill our buffer with free packets.
+			if (m_filter_attached) {
+				pushFullBuffers(pktbuffer, bufQue, dropRejected(bufQue, msgs, pktsReadThisPass));
+			} else {
+				pushFullBuffers(pktbuffer, bufQue, pktsReadThisPass);
+			}
 
 			// Re-point the iovecs to the new buffers
-			// Note that we've added pktsReadThisPass to the top of the bufQue so we only have to repoint the new buffers
-			for (i = 0; i < (size_t) pktsReadThisPass; ++i) {
-				iovecs[i].iov_base = bufQue[i].get();
-			}
+			// The new buffers were added to the end of bufQue so every iovec moves down, this keeps the buffers being
+			// filled in the same order they were recycled in which, in split mode, keeps consecutive payloads contiguous.
+			pointIovecs(pktbuffer, bufQue, iovecs, split);
 
 			// Its possible that you have two different hosts sending multicast to the same address. This feature was added to
 			// aid in debugging situations where you want to know who is missconfigured.
@@ -275,7 +1173,7 @@ void SocketReader::run(SmartPacketBuffer<SDDSpacket> *pktbuffer, const bool conf
 
 		// Same value as EAGAIN
 		case EWOULDBLOCK: // No data was available. Wait for data.
-			poll(poll_struct, 1, 100); // 100 ms max wait poll if no data is available.
+			waitForData(poll_struct, spin_start, spin_last);
 			errno = 0;
 			break;
 		case EINTR:
@@ -294,13 +1192,180 @@ void SocketReader::run(SmartPacketBuffer<SDDSpacket> *pktbuffer, const bool conf
 
     // Shutting down
 	// Don't drop the buffers! Put them back where you found them.
-	// XXX If we ever switch to a single producer single consumer no-lock no-wait data structure this may mess things up.
-	pktbuffer->recycle_buffers(bufQue);
-	m_running = false;
+	// In lock free mode we are not allowed to put them back (we are not the recycling thread) so they are
+	// reclaimed the next time the buffer is initialized.
+	pktbuffer->release_buffers(bufQue);
+}
 
-	RH_DEBUG(_log, "Closing socket");
-	if (m_multicast_connection.sock) { multicast_close(m_multicast_connection); 	memset(&m_multicast_connection, 0, sizeof(m_multicast_connection)); }
-	if (m_unicast_connection.sock) { unicast_close(m_unicast_connection); 			memset(&m_unicast_connection, 0, sizeof(m_unicast_connection)); }
+/**
+ * The recvmmsg backend with UDP_GRO set on the socket. The kernel coalesces back to back datagrams of the same flow
+ * into a single buffer of up to 64KB and reports the size of the original datagrams in a control message, so each
+ * recvmmsg call hands us up to UDP_GRO_MAX_MSGS such buffers for far less per packet work in the kernel. The buffers
+ * are read into a staging area and split back into SDDS packets which are copied into the packet buffer, header and
+ * payload separately so this works with scatter receive. Runts and anything else that is not SDDS sized are skipped.
+ * Waits on an empty socket as set by the wait strategy.
+ *
+ * Returns false, having touched nothing, if the kernel does not support UDP_GRO so the caller can fall back to the
+ * plain recvmmsg loop.
+ */
+bool SocketReader::runUdpGro(SmartPacketBuffer<SDDSheader> *pktbuffer, const bool confirmHosts, int socket) {
+	int one = 1;
+	if (setsockopt(socket, SOL_UDP, UDP_GRO, &one, sizeof(one)) != 0) {
+		RH_WARN(_log, "Failed to enable UDP_GRO on the socket, errno: " << errno << " falling back to plain recvmmsg");
+		errno = 0;
+		return false;
+	}
+
+	if (not setSocketBlockingEnabled(socket, false)) {
+		RH_ERROR(_log, "Error when setting the socket to non-blocking");
+	}
+
+	applySocketBufferSize(socket);
+	applyRxqOvfl(socket);
+	applyTimestamps(socket);
+	if (m_wait_strategy == WAIT_STRATEGY::BUSY_POLL) {
+		applyBusyPoll(socket);
+	}
+
+	RH_INFO(_log, "Reading packets with UDP_GRO");
+	m_active_udp_gro = true;
+
+	struct pollfd poll_struct[1];
+	poll_struct[0].events = POLLIN | POLLERR | POLLHUP;
+	poll_struct[0].fd = socket;
+
+	// Every coalesced buffer holds at least one packet so there is no point reading more of them than a socket read
+	const size_t num_msgs = std::max((size_t) 1, std::min(m_pkts_per_read, (size_t) UDP_GRO_MAX_MSGS));
+	const size_t control_size = CMSG_SPACE(sizeof(int)) + ((m_rxq_ovfl) ? RXQ_OVFL_CONTROL_SIZE : 0) + ((m_active_timestamps) ? TIMESTAMP_CONTROL_SIZE : 0);
+
+	std::vector<uint8_t> staging(num_msgs * UDP_GRO_BUFFER_SIZE);
+	std::vector<uint8_t> control(num_msgs * control_size);
+	std::vector<struct mmsghdr> msgs(num_msgs);
+	std::vector<struct iovec> iovecs(num_msgs);
+	std::vector<sockaddr_in> source_addrs(num_msgs);
+
+	for (size_t i = 0; i < num_msgs; ++i) {
+		memset(&msgs[i], 0, sizeof(msgs[i]));
+		iovecs[i].iov_base = &staging[i * UDP_GRO_BUFFER_SIZE];
+		iovecs[i].iov_len = UDP_GRO_BUFFER_SIZE;
+		msgs[i].msg_hdr.msg_iov = &iovecs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_name = &source_addrs[i];
+	}
+
+	std::deque<SddsPacketPtr> bufQue;
+	size_t filled = 0;
+	uint64_t spin_start = 0, spin_last = 0;
+
+	// Fill our buffer with free packets
+	popEmptyBuffers(pktbuffer, bufQue, m_pkts_per_read);
+
+	while (not m_shuttingDown) {
+		publishMetrics(false);
+		// The kernel shrinks these to what it used, give the full space back each time
+		for (size_t i = 0; i < num_msgs; ++i) {
+			msgs[i].msg_hdr.msg_control = &control[i * control_size];
+			msgs[i].msg_hdr.msg_controllen = control_size;
+			msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+		}
+
+		int msgsRead = recvmmsg(socket, &msgs[0], num_msgs, MSG_DONTWAIT, NULL);
+		++m_counters.reads;
+
+		if (msgsRead <= 0) {
+			++m_counters.empty_reads;
+		}
+
+		if (msgsRead < 0) {
+			if (errno == EWOULDBLOCK) {
+				waitForData(poll_struct, spin_start, spin_last);
+				errno = 0;
+				continue;
+			}
+
+			if (errno == EINTR) {
+				RH_ERROR(_log, "Socket read was killed by an interrupt. Will stop reading.");
+			} else {
+				RH_ERROR(_log, "Received unexpected errno from socket read: " << errno);
+			}
+			m_shuttingDown = true;
+			m_running = false;
+			break;
+		}
+
+		if (spin_last) {
+			m_counters.spin_ns += monotonicNs() - spin_last;
+			spin_last = 0;
+		}
+
+		for (int i = 0; i < msgsRead; ++i) {
+			const uint8_t *data = reinterpret_cast<const uint8_t*>(iovecs[i].iov_base);
+			size_t len = msgs[i].msg_len;
+
+			// Without the control message the buffer holds a single datagram
+			size_t segment = len;
+			uint64_t received = 0;
+			for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg)) {
+				if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+					int gso_size;
+					memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+					segment = gso_size;
+				} else if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+					uint32_t drops;
+					memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+					m_counters.socket_drops = drops;
+				} else if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+					struct timespec ts;
+					memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+					received = (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+				}
+			}
+
+			// Each coalesced buffer holds its datagrams back to back, all of them segment long bar the last
+			m_counters.packets += (segment) ? (len + segment - 1) / segment : 1;
+			m_counters.bytes += len;
+
+			if (len == 0 && m_filter_attached) {
+				++m_counters.num_rejected;
+				continue;
+			}
+
+			if (__builtin_expect(confirmHosts,false)) {
+				confirmHost(source_addrs[i].sin_addr);
+			}
+
+			for (size_t offset = 0; segment && offset + SDDS_PACKET_SIZE <= len && filled < bufQue.size(); offset += segment) {
+				if (std::min(segment, len - offset) != SDDS_PACKET_SIZE) {
+					continue;
+				}
+
+				SddsPacketPtr pkt = bufQue[filled];
+				memcpy(pkt, data + offset, SDDS_HEADER_SIZE);
+				memcpy(pktbuffer->get_payload(pkt), data + offset + SDDS_HEADER_SIZE, SDDS_DATA_SIZE);
+				if (received) {
+					pktbuffer->set_timestamp(pkt, received);
+				}
+
+				if (++filled == bufQue.size()) {
+					pushFullBuffers(pktbuffer, bufQue, filled);
+					filled = 0;
+				}
+			}
+		}
+
+		// Every socket read is pushed as one batch
+		if (filled) {
+			pushFullBuffers(pktbuffer, bufQue, filled);
+			filled = 0;
+		}
+	}
+
+	int zero = 0;
+	setsockopt(socket, SOL_UDP, UDP_GRO, &zero, sizeof(zero));
+
+	// Don't drop the buffers! Put them back where you found them.
+	pktbuffer->release_buffers(bufQue);
+	return true;
 }
 
 /**
@@ -328,80 +1393,644 @@ bool SocketReader::setSocketBlockingEnabled(int fd, bool blocking)
 void SocketReader::confirmSingleHost(struct mmsghdr msgs[], size_t len) {
 
 	for (size_t i = 0; i < len; ++i) {
+		// Empty datagrams are the packets the packet filter turned away
+		if (msgs[i].msg_len == 0) {
+			continue;
+		}
 		sockaddr_in * rcv_host_struct = reinterpret_cast<sockaddr_in *>(msgs[i].msg_hdr.msg_name);
+		confirmHost(rcv_host_struct->sin_addr);
+	}
+}
+
+/**
+ * Confirms a single received packet came from the expected host address, see confirmSingleHost.
+ */
+void SocketReader::confirmHost(struct in_addr host) {
+	if (host.s_addr != m_host_addr.s_addr) {
+		if (m_host_addr.s_addr != 0) {
+			//XXX: Do not combine these into a single log statement. The inet_ntoa returns a pointer to an internal array containing the string so if you call it twice
+			// on the same line it will overwrite itself, display the same value twice in the log statement, and cause the developer debugging to question their sanity.
+			RH_WARN(_log, "Expected packets to come from: " << inet_ntoa(m_host_addr));
+			RH_WARN(_log, "Received packet from: " << inet_ntoa(host));
+		}
+
+		m_host_addr = host;
+	}
+}
 
-		if (rcv_host_struct->sin_addr.s_addr != m_host_addr.s_addr) {
-			if (m_host_addr.s_addr != 0) {
-				//XXX: Do not combine these into a single log statement. The inet_ntoa returns a pointer to an internal array containing the string so if you call it twice
-				// on the same line it will overwrite itself, display the same value twice in the log statement, and cause the developer debugging to question their sanity.
-				RH_WARN(_log, "Expected packets to come from: " << inet_ntoa(m_host_addr));
-				RH_WARN(_log, "Received packet from: " << inet_ntoa(rcv_host_struct->sin_addr));
+/**
+ * Moves the buffers of the packets the packet filter turned away, which were received as empty datagrams, behind the
+ * accepted packets in bufQue so the accepted packets can be pushed as one batch; their order is kept. The rejected
+ * buffers are read into again. Returns the number of accepted packets.
+ */
+size_t SocketReader::dropRejected(std::deque<SddsPacketPtr> &bufQue, struct mmsghdr msgs[], size_t len) {
+	size_t accepted = 0;
+	for (size_t i = 0; i < len; ++i) {
+		if (msgs[i].msg_len == 0) {
+			++m_counters.num_rejected;
+		} else {
+			if (accepted != i) {
+				std::swap(bufQue[accepted], bufQue[i]);
 			}
+			++accepted;
+		}
+	}
+	return accepted;
+}
+
+/**
+ * The PACKET_MMAP backend. Packets are pulled out of a TPACKET_V3 ring shared with the kernel rather than read off of
+ * the UDP socket so no system call is needed per batch; we only poll when the kernel has not yet handed us the next block.
+ * The UDP and IP headers are parsed in place and the SDDS packet is copied straight from the ring into the packet buffer,
+ * every retired block is pushed as a single batch. The UDP socket stays open so that we remain joined to the multicast
+ * group but a filter is attached that discards everything so packets are not queued on it twice; it replaces the packet
+ * filter, which is applied to the ring's packets in user space instead.
+ *
+ * Returns false, having touched nothing, if the ring could not be setup so the caller can fall back to recvmmsg.
+ */
+bool SocketReader::runPacketRing(SmartPacketBuffer<SDDSheader> *pktbuffer, const bool confirmHosts, int udp_socket) {
+	size_t num_blocks = PACKET_RING_MIN_BLOCKS;
+	if (m_socket_buffer_size > 0 && m_socket_buffer_size / PACKET_RING_BLOCK_SIZE > num_blocks) {
+		num_blocks = m_socket_buffer_size / PACKET_RING_BLOCK_SIZE;
+	}
+
+	packet_ring_t ring;
+	try {
+		ring = packet_ring_open(m_capture_interface.c_str(), m_ip.c_str(), m_port, PACKET_RING_BLOCK_SIZE, num_blocks, PACKET_RING_BLOCK_TIMEOUT_MS, _log);
+	} catch (BadParameterError &e) {
+		RH_WARN(_log, "Failed to open the packet ring on interface: " << m_capture_interface << " " << e.what());
+		return false;
+	}
 
-			m_host_addr = rcv_host_struct->sin_addr;
+	RH_INFO(_log, "Reading packets from a " << num_blocks << " block PACKET_MMAP ring on interface: " << m_capture_interface);
+	m_active_read_backend = READ_BACKEND::PACKET_MMAP;
+
+	struct sock_filter drop_all = BPF_STMT(BPF_RET | BPF_K, 0);
+	struct sock_fprog drop_prog = {1, &drop_all};
+	if (setsockopt(udp_socket, SOL_SOCKET, SO_ATTACH_FILTER, &drop_prog, sizeof(drop_prog)) != 0) {
+		RH_WARN(_log, "Failed to attach the discard filter to the UDP socket, packets will also be queued on it");
+	}
+
+	std::deque<SddsPacketPtr> bufQue;
+	size_t filled = 0;
+
+	// Fill our buffer with free packets
+	popEmptyBuffers(pktbuffer, bufQue, m_pkts_per_read);
+
+	while (not m_shuttingDown) {
+		publishMetrics(false);
+		struct tpacket_block_desc *block = packet_ring_next_block(&ring, 100); // 100 ms max wait if no data is available.
+		++m_counters.reads;
+		if (block == NULL) {
+			++m_counters.empty_reads;
+			continue;
+		}
+
+		struct tpacket3_hdr *frame = reinterpret_cast<struct tpacket3_hdr*>(reinterpret_cast<uint8_t*>(block) + block->hdr.bh1.offset_to_first_pkt);
+
+		for (uint32_t i = 0; i < block->hdr.bh1.num_pkts && not bufQue.empty(); ++i) {
+			size_t len = 0;
+			struct in_addr source;
+			const uint8_t *sdds = packet_ring_udp_payload(&ring, frame, &len, &source);
+			if (sdds != NULL) {
+				++m_counters.packets;
+				m_counters.bytes += len;
+			}
+
+			// The UDP socket and its filter are bypassed so the packets are screened here instead
+			if (sdds != NULL && m_packet_filter && not sdds_filter_match(&m_filter, sdds, len, source)) {
+				++m_counters.num_rejected;
+			} else if (sdds != NULL && len == SDDS_PACKET_SIZE) {
+				if (__builtin_expect(confirmHosts,false)) {
+					confirmHost(source);
+				}
+
+				SddsPacketPtr pkt = bufQue[filled];
+				memcpy(pkt, sdds, SDDS_HEADER_SIZE);
+				memcpy(pktbuffer->get_payload(pkt), sdds + SDDS_HEADER_SIZE, SDDS_DATA_SIZE);
+				if (m_timestamps) {
+					pktbuffer->set_timestamp(pkt, (uint64_t) frame->tp_sec * 1000000000ULL + frame->tp_nsec);
+				}
+
+				if (++filled == bufQue.size()) {
+					pushFullBuffers(pktbuffer, bufQue, filled);
+					filled = 0;
+				}
+			}
+
+			frame = reinterpret_cast<struct tpacket3_hdr*>(reinterpret_cast<uint8_t*>(frame) + frame->tp_next_offset);
+		}
+
+		packet_ring_release_block(&ring, block);
+
+		// Every retired block is pushed as one batch
+		if (filled) {
+			pushFullBuffers(pktbuffer, bufQue, filled);
+			filled = 0;
 		}
 	}
+
+	unsigned int packets = 0, drops = 0;
+	if (packet_ring_stats(ring, &packets, &drops) == 0 && drops) {
+		RH_WARN(_log, "The packet ring dropped " << drops << " packets while it was open");
+	}
+
+	packet_ring_close(ring);
+	setsockopt(udp_socket, SOL_SOCKET, SO_DETACH_FILTER, NULL, 0);
+
+	// Don't drop the buffers! Put them back where you found them.
+	pktbuffer->release_buffers(bufQue);
+	return true;
 }
 
 /**
- * Selects a network interface that has a route for the multicast group passed in as
- * ac argument. If no multicast group is specified, 224.0.0.0 is used to select the
- * default multicast route. If no other routes match, the interface with the default
- * gateway will be selected. The selected interface is returned.
+ * The io_uring backend. A single multishot recvmsg stays armed against the UDP socket and the kernel receives each
+ * datagram straight into a packet buffer slot taken from a provided buffer ring, there is no copy and the only system
+ * call is the one that waits for completions. That wait blocks in the kernel until the first completion arrives (or
+ * 100 ms pass) so there is no EWOULDBLOCK and poll round trip before we see new data.
+ *
+ * Each slot is given to the kernel starting URING_RECV_HEADROOM bytes in front of the packet; the recvmsg header and
+ * the sender's address land in the headroom reserved by the packet buffer and the SDDS packet lands on the slot itself.
+ * The buffer id is the slot index so the pool can hold at most 65536 packets.
+ *
+ * Returns false, having touched nothing, if the packet buffer is not laid out for io_uring or the ring could not be
+ * setup so the caller can fall back to recvmmsg.
  */
-std::string SocketReader::getMcastIfaceFromRoutes(std::string group) {
+bool SocketReader::runIoUring(SmartPacketBuffer<SDDSheader> *pktbuffer, const bool confirmHosts, int socket) {
+	if (pktbuffer->is_split_payload()) {
+		RH_WARN(_log, "The " << READ_BACKEND::IO_URING << " backend receives each packet into a single buffer and cannot be used with scatter receive");
+		return false;
+	}
 
-	FILE* fp;
-	char buffer[1024*1024];  // Too big?
-	size_t bytes_read;
-	std::stringstream routes;
-	std::string iface, trash, iface_match = "";
-	in_addr_t dest, mask, mask_match = 0;
+	if (pktbuffer->get_headroom() < URING_RECV_HEADROOM || pktbuffer->get_capacity() > URING_RECV_MAX_BUFFER_ID + 1) {
+		RH_WARN(_log, "The packet buffer cannot be used by the " << READ_BACKEND::IO_URING << " backend, it supports at most " << URING_RECV_MAX_BUFFER_ID + 1 << " packets");
+		return false;
+	}
+
+	// The kernel holds one socket read worth of empty buffers at a time
+	const size_t num_provided = std::min(m_pkts_per_read, (size_t) URING_RECV_MAX_BUFFERS);
 
-	// Convert group to hex representation
-	in_addr_t group_hex = inet_addr(group.c_str());
+	applySocketBufferSize(socket);
 
-	// Read the entire contents of /proc/net/route into the buffer.
-	// Expects format: Iface	Destination	Gateway 	Flags	RefCnt	Use	Metric	Mask ...
-	fp = fopen ("/proc/net/route", "r");
-	if (fp == NULL) {
-		RH_NL_WARN("SourceSDDSUtils", "Failed to open /proc/net/route");
-		return "";
+	uring_recv_t ring;
+	try {
+		ring = uring_recv_open(socket, num_provided, _log);
+	} catch (BadParameterError &e) {
+		RH_WARN(_log, "Failed to setup io_uring on the UDP socket " << e.what());
+		return false;
 	}
-	bytes_read = fread (buffer, 1, sizeof (buffer), fp);
-	fclose (fp);
 
-	/* Bail if read failed.  */
-	if (bytes_read == 0) {
-		RH_NL_WARN("SourceSDDSUtils", "Failed to read /proc/net/route");
-		return "";
-	}
-
-	// write to stringstream
-	routes.write(buffer, bytes_read);
-	RH_NL_DEBUG("SourceSDDSUtils", "Routes: ["<<routes.str()<<"]");
-
-    // Parse the results, using format below:
-	//	Iface	Destination	Gateway 	Flags	RefCnt	Use	Metric	Mask		MTU	Window	IRTT
-	//	em2		000000E0	00000000	0001	0		0	0		000000F0	0	0		0 ## This is the default multicast route
-	//	em2		0067A8EA	00000000	0001	0		0	0		00FFFFFF	0	0		0 ## This is a class C multicast route
-	//	em4		0068A8EA	00000000	0001	0		0	0		00FFFFFF	0	0		0 ## This is another class C mcast route
-	// logic: bool match = (<Destination> == (inet_addr(ip.c_str()) & <Mask>))
-	// And matches with greater mask take priority
-
-	routes.ignore(bytes_read, '\n'); // skip title row
-	for (routes >> iface; !routes.eof(); routes >> iface ){
-		routes >> std::hex >> dest >> trash >> trash >> trash >> trash >> trash >> mask;
-	    RH_NL_DEBUG("SourceSDDSUtils", "iface="<<iface
-	    		<<"  dest=0x"<<std::hex<<std::setw(8)<<std::setfill('0')<<std::uppercase<<dest<<std::nouppercase
-				<<"  mask=0x"<<std::hex<<std::setw(8)<<std::setfill('0')<<std::uppercase<<mask<<std::nouppercase);
-		if (mask >= mask_match && (dest == (group_hex & mask))) {
-			RH_NL_DEBUG("SourceSDDSUtils", "Found match: iface="<<iface);
-			iface_match = iface;
-            mask_match = mask;
-		}
-		routes.ignore(bytes_read, '\n'); // skip remainder of row
-	}
-	RH_NL_DEBUG("SourceSDDSUtils", "Determined "<<iface_match<<" is used to route "<<group<<" using /proc/net/route");
-	return iface_match;
+	RH_INFO(_log, "Reading packets with an io_uring multishot recvmsg into " << num_provided << " provided buffers");
+	m_active_read_backend = READ_BACKEND::IO_URING;
+
+	// The buffers the kernel currently holds, it uses them in the order they were provided
+	std::deque<SddsPacketPtr> provided;
+	std::deque<SddsPacketPtr> bufQue;
+	std::vector<uring_recv_cqe_t> cqes(num_provided * 2);
+
+	// Fill the buffer ring with free packets
+	popEmptyBuffers(pktbuffer, provided, num_provided);
+	for (size_t i = 0; i < provided.size(); ++i) {
+		uring_recv_provide(&ring, reinterpret_cast<uint8_t*>(provided[i]) - URING_RECV_HEADROOM, URING_RECV_HEADROOM + SDDS_PACKET_SIZE, pktbuffer->get_index(provided[i]));
+	}
+	uring_recv_publish(&ring);
+
+	while (not m_shuttingDown) {
+		publishMetrics(false);
+		// The multishot recvmsg ends if the kernel ran out of buffers, they have been topped up by now
+		if (not ring.armed && uring_recv_arm(&ring) != 0) {
+			RH_ERROR(_log, "Failed to arm the io_uring recvmsg, errno: " << errno << " Will stop reading.");
+			break;
+		}
+
+		int ready = uring_recv_wait(&ring, 100); // 100 ms max wait if no data is available.
+		++m_counters.reads;
+		if (ready < 0) {
+			RH_ERROR(_log, "Received unexpected errno from io_uring wait: " << errno << " Will stop reading.");
+			break;
+		} else if (ready == 0) {
+			++m_counters.empty_reads;
+			continue;
+		}
+
+		unsigned completed = uring_recv_completions(&ring, &cqes[0], cqes.size());
+
+		for (unsigned i = 0; i < completed; ++i) {
+			if (cqes[i].bid < 0) {
+				if (cqes[i].res != -ENOBUFS) {
+					RH_WARN(_log, "The io_uring recvmsg failed with errno: " << -cqes[i].res);
+				}
+				continue;
+			}
+
+			SddsPacketPtr pkt = pktbuffer->get_buffer(cqes[i].bid);
+			provided.pop_front();
+
+			size_t len = 0;
+			struct in_addr source;
+			const uint8_t *sdds = uring_recv_payload(&ring, reinterpret_cast<uint8_t*>(pkt) - URING_RECV_HEADROOM, cqes[i].res, &len, &source);
+			if (sdds != NULL) {
+				++m_counters.packets;
+				m_counters.bytes += len;
+			}
+
+			if (sdds == reinterpret_cast<uint8_t*>(pkt) && len == SDDS_PACKET_SIZE) {
+				if (__builtin_expect(confirmHosts,false)) {
+					confirmHost(source);
+				}
+				bufQue.push_back(pkt);
+			} else {
+				if (sdds != NULL && len == 0 && m_filter_attached) {
+					++m_counters.num_rejected;
+				}
+
+				// Not an SDDS packet, hand the buffer straight back to the kernel
+				provided.push_back(pkt);
+				uring_recv_provide(&ring, reinterpret_cast<uint8_t*>(pkt) - URING_RECV_HEADROOM, URING_RECV_HEADROOM + SDDS_PACKET_SIZE, cqes[i].bid);
+			}
+		}
+
+		// Top the buffer ring back up with free packets, unless the packets just received have to make way for that
+		size_t have = provided.size();
+		if (m_active_overflow_policy == OVERFLOW_POLICY::BLOCK || reserveEmptyBuffers(pktbuffer, provided, num_provided, m_lane)) {
+			if (not bufQue.empty()) {
+				pktbuffer->push_full_buffers(bufQue, bufQue.size(), m_lane);
+			}
+			popEmptyBuffers(pktbuffer, provided, num_provided);
+		} else {
+			// The newest packets give their buffers straight back to the kernel, the rest still go out
+			size_t reuse = std::min(bufQue.size(), num_provided - provided.size());
+			provided.insert(provided.end(), bufQue.end() - reuse, bufQue.end());
+			bufQue.erase(bufQue.end() - reuse, bufQue.end());
+			m_counters.overflow_drops += reuse;
+			if (not bufQue.empty()) {
+				pktbuffer->push_full_buffers(bufQue, bufQue.size(), m_lane);
+			}
+		}
+		for (size_t i = have; i < provided.size(); ++i) {
+			uring_recv_provide(&ring, reinterpret_cast<uint8_t*>(provided[i]) - URING_RECV_HEADROOM, URING_RECV_HEADROOM + SDDS_PACKET_SIZE, pktbuffer->get_index(provided[i]));
+		}
+		uring_recv_publish(&ring);
+	}
+
+	// The kernel must be done with the buffers before we give them back
+	if (ring.armed && uring_recv_cancel(&ring, 1000) != 0) {
+		RH_WARN(_log, "Failed to cancel the io_uring recvmsg, closing the ring regardless");
+	}
+	uring_recv_close(ring);
+
+	// Don't drop the buffers! Put them back where you found them.
+	pktbuffer->release_buffers(provided);
+	return true;
+}
+
+/**
+ * Serves the sockets of every stream added with addStream from a single thread. The sockets are non-blocking and
+ * registered with an epoll instance, each pass reads up to m_pkts_per_read packets with recvmmsg from every socket
+ * epoll reports as readable into empty buffers of that stream's lane and pushes them as full buffers onto the same
+ * lane. Empty buffers are only taken if the lane has them to spare so a stream whose processing has fallen behind
+ * leaves its packets queued in its socket rather than stalling the other streams, or with drop_newest has its socket
+ * drained into a scratch buffer and the packets counted as overflow drops. When nothing is readable we wait
+ * in epoll_wait as set by the wait strategy, spinning means a zero timeout. Streams added or removed while we are
+ * serving wake the epoll_wait through an eventfd and are picked up at the top of the next pass, see updateStreams.
+ */
+void SocketReader::runStreams(SmartPacketBuffer<SDDSheader> *pktbuffer, const bool confirmHosts) {
+	// The drop count is per socket, with several sockets there is no single count to report
+	m_rxq_ovfl = false;
+
+	int epfd = epoll_create(pktbuffer->get_num_lanes() + 1);
+	if (epfd < 0) {
+		RH_ERROR(_log, "Failed to create the epoll instance for the attached streams, errno: " << errno);
+		errno = 0;
+		return;
+	}
+
+	int wake_fd = eventfd(0, EFD_NONBLOCK);
+	struct epoll_event wake_event;
+	memset(&wake_event, 0, sizeof(wake_event));
+	wake_event.events = EPOLLIN;
+	wake_event.data.u32 = STREAMS_WAKE_EVENT;
+	if (wake_fd < 0 || epoll_ctl(epfd, EPOLL_CTL_ADD, wake_fd, &wake_event) != 0) {
+		RH_ERROR(_log, "Failed to create the event that wakes the socket reader for added and removed streams, errno: " << errno);
+		errno = 0;
+		if (wake_fd >= 0) {
+			close(wake_fd);
+		}
+		close(epfd);
+		return;
+	}
+
+	boost::unique_lock<boost::mutex> lock(m_streams_lock);
+	for (size_t s = 0; s < m_streams.size(); ++s) {
+		if (not watchStream(epfd, m_streams[s])) {
+			lock.unlock();
+			close(wake_fd);
+			close(epfd);
+			return;
+		}
+	}
+	m_epoll_fd = epfd;
+	m_wake_fd = wake_fd;
+	lock.unlock();
+	m_streams_changed = true;
+
+	const bool split = pktbuffer->is_split_payload();
+	const size_t iovs_per_msg = (split) ? 2 : 1;
+
+	struct mmsghdr msgs[m_pkts_per_read];
+	struct iovec iovecs[m_pkts_per_read * iovs_per_msg];
+	sockaddr_in source_addrs[m_pkts_per_read];
+	std::vector<struct epoll_event> events(pktbuffer->get_num_lanes() + 1);
+
+	const size_t control_size = (m_active_timestamps) ? TIMESTAMP_CONTROL_SIZE : 0;
+	std::vector<uint8_t> control(m_pkts_per_read * control_size);
+
+	// A stream out of empty buffers under drop_newest is read into here so that it is its newest packets that are lost
+	const bool drop_newest = (m_active_overflow_policy == OVERFLOW_POLICY::DROP_NEWEST);
+	std::vector<uint8_t> scratch((drop_newest) ? m_pkts_per_read * SDDS_PACKET_SIZE : 0);
+	struct mmsghdr scratch_msgs[m_pkts_per_read];
+	struct iovec scratch_iovecs[m_pkts_per_read];
+	memset(scratch_msgs, 0, sizeof(scratch_msgs));
+	for (size_t i = 0; drop_newest && i < m_pkts_per_read; i++) {
+		scratch_iovecs[i].iov_base = &scratch[i * SDDS_PACKET_SIZE];
+		scratch_iovecs[i].iov_len = SDDS_PACKET_SIZE;
+		scratch_msgs[i].msg_hdr.msg_iov = &scratch_iovecs[i];
+		scratch_msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	memset(msgs, 0, sizeof(msgs));
+	for (size_t i = 0; i < m_pkts_per_read; i++) {
+		if (split) {
+			iovecs[2*i].iov_len        = SDDS_HEADER_SIZE;
+			iovecs[2*i+1].iov_len      = SDDS_DATA_SIZE;
+		} else {
+			iovecs[i].iov_len          = SDDS_PACKET_SIZE;
+		}
+		msgs[i].msg_hdr.msg_iov    = &iovecs[i * iovs_per_msg];
+		msgs[i].msg_hdr.msg_iovlen = iovs_per_msg;
+
+		if (confirmHosts) {
+			msgs[i].msg_hdr.msg_name = &source_addrs[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+		}
+
+		if (control_size) {
+			msgs[i].msg_hdr.msg_control = &control[i * control_size];
+			msgs[i].msg_hdr.msg_controllen = control_size;
+		}
+	}
+
+	// When we started spinning with nothing readable and the time of the last empty pass, zero when not spinning
+	uint64_t spin_start = 0, spin_last = 0;
+	// Backs off while every readable stream is out of empty buffers, epoll would otherwise keep reporting them at once
+	unsigned int attempt = 0;
+
+	RH_DEBUG(_log, "Entering epoll read loop for " << m_streams.size() << " streams");
+	while (not m_shuttingDown) {
+		if (m_streams_changed) {
+			updateStreams(pktbuffer, epfd);
+		}
+		publishMetrics(false);
+		int timeout = 100; // 100 ms max wait if no data is available.
+		if (m_wait_strategy != WAIT_STRATEGY::POLL) {
+			uint64_t now = monotonicNs();
+			if (spin_last) {
+				m_counters.spin_ns += now - spin_last;
+			} else {
+				spin_start = now;
+			}
+			spin_last = now;
+
+			if (m_wait_strategy == WAIT_STRATEGY::SPIN || now - spin_start < m_spin_budget_us * 1000ULL) {
+				timeout = 0;
+			} else {
+				spin_last = 0;
+			}
+		}
+
+		if (timeout) {
+			publishMetrics(true);
+		}
+		uint64_t start = (timeout) ? monotonicNs() : 0;
+		int ready = epoll_wait(epfd, &events[0], events.size(), timeout);
+		if (timeout) {
+			m_counters.poll_ns += monotonicNs() - start;
+			++m_counters.num_polls;
+		}
+
+		if (ready < 0) {
+			if (errno == EINTR) {
+				RH_ERROR(_log, "Socket read was killed by an interrupt. Will stop reading.");
+			} else {
+				RH_ERROR(_log, "Received unexpected errno from epoll_wait: " << errno);
+			}
+			m_shuttingDown = true;
+			break;
+		}
+
+		if (ready == 0) {
+			continue;
+		}
+
+		if (spin_last) {
+			m_counters.spin_ns += monotonicNs() - spin_last;
+			spin_last = 0;
+		}
+
+		bool starved = true;
+		for (int e = 0; e < ready; ++e) {
+			if (events[e].data.u32 == STREAMS_WAKE_EVENT) {
+				uint64_t count;
+				if (read(wake_fd, &count, sizeof(count)) < 0) {
+					errno = 0;
+				}
+				starved = false;
+				continue;
+			}
+
+			// Only the lanes with a stream are in the epoll set, checked all the same
+			size_t lane = events[e].data.u32;
+			if (lane >= m_stream_of_lane.size() || m_stream_of_lane[lane] >= m_streams.size()) {
+				continue;
+			}
+			StreamSocket &stream = m_streams[m_stream_of_lane[lane]];
+
+			reserveEmptyBuffers(pktbuffer, stream.bufQue, m_pkts_per_read, stream.lane);
+			if (stream.bufQue.empty()) {
+				if (drop_newest) {
+					int dropped = recvmmsg(stream.sock, scratch_msgs, m_pkts_per_read, MSG_DONTWAIT, NULL);
+					countReads(scratch_msgs, dropped);
+					if (dropped > 0) {
+						m_counters.overflow_drops += dropped;
+						starved = false;
+					}
+					errno = 0;
+				}
+				continue;
+			}
+			starved = false;
+
+			pointIovecs(pktbuffer, stream.bufQue, iovecs, split);
+			int pktsRead = recvmmsg(stream.sock, msgs, stream.bufQue.size(), MSG_DONTWAIT, NULL);
+			countReads(msgs, pktsRead);
+
+			if (pktsRead < 0) {
+				if (errno != EWOULDBLOCK) {
+					RH_ERROR(_log, "Received unexpected errno from socket read: " << errno);
+					m_shuttingDown = true;
+				}
+				errno = 0;
+				continue;
+			}
+
+			if (control_size) {
+				readControl(pktbuffer, stream.bufQue, msgs, pktsRead, control_size);
+			}
+
+			if (__builtin_expect(confirmHosts,false)) {
+				m_host_addr = stream.host_addr;
+				confirmSingleHost(msgs, (size_t) pktsRead);
+				stream.host_addr = m_host_addr;
+			}
+
+			if (stream.filter_attached) {
+				pktbuffer->push_full_buffers(stream.bufQue, dropRejected(stream.bufQue, msgs, pktsRead), stream.lane);
+			} else {
+				pktbuffer->push_full_buffers(stream.bufQue, pktsRead, stream.lane);
+			}
+		}
+
+		if (starved) {
+			uint64_t start = monotonicNs();
+			SpscRing<SddsPacketPtr>::backoff(attempt);
+			m_counters.buffer_wait_ns += monotonicNs() - start;
+		} else {
+			attempt = 0;
+		}
+	}
+
+	// Shutting down, put the buffers back where we found them, see runRecvmmsg. Streams added or removed from here on
+	// are handled by addStream and removeStream themselves.
+	lock.lock();
+	m_epoll_fd = -1;
+	m_wake_fd = -1;
+	m_streams.insert(m_streams.end(), m_added_streams.begin(), m_added_streams.end());
+	m_added_streams.clear();
+	m_removed_lanes.clear();
+	for (size_t s = 0; s < m_streams.size(); ++s) {
+		pktbuffer->release_buffers(m_streams[s].bufQue);
+	}
+	lock.unlock();
+	m_streams_updated.notify_all();
+	close(wake_fd);
+	close(epfd);
+}
+
+/**
+ * Sets up a stream's socket to be served by runStreams and adds it to the epoll instance, its events carry its lane.
+ * Returns false, having logged why, if the socket could not be added.
+ */
+bool SocketReader::watchStream(int epfd, StreamSocket &stream) {
+	if (not setSocketBlockingEnabled(stream.sock, false)) {
+		RH_ERROR(_log, "Error when setting the socket to non-blocking");
+	}
+	applySocketBufferSize(stream.sock);
+	applyTimestamps(stream.sock);
+	if (m_wait_strategy == WAIT_STRATEGY::BUSY_POLL) {
+		applyBusyPoll(stream.sock);
+	}
+
+	struct epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.u32 = stream.lane;
+	if (epoll_ctl(epfd, EPOLL_CTL_ADD, stream.sock, &event) != 0) {
+		RH_ERROR(_log, "Failed to add the socket of the stream on lane " << stream.lane << " to the epoll instance, errno: " << errno);
+		errno = 0;
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Applies the streams added and removed since the last pass of runStreams, see addStream and removeStream. Runs on the
+ * reader thread so the epoll set and the streams' buffers are only ever changed by the thread using them. A removed
+ * stream's socket is taken out of the epoll set and closed and the empty buffers it held are let go of; anyone waiting
+ * in removeStream is then woken. Also rebuilds the map from a lane to its stream which the epoll events are looked up in.
+ */
+void SocketReader::updateStreams(SmartPacketBuffer<SDDSheader> *pktbuffer, int epfd) {
+	boost::unique_lock<boost::mutex> lock(m_streams_lock);
+	for (size_t i = 0; i < m_added_streams.size(); ++i) {
+		if (watchStream(epfd, m_added_streams[i])) {
+			m_streams.push_back(m_added_streams[i]);
+		} else {
+			closeStream(m_added_streams[i]);
+		}
+	}
+	m_added_streams.clear();
+
+	for (size_t r = 0; r < m_removed_lanes.size(); ++r) {
+		for (size_t s = 0; s < m_streams.size(); ++s) {
+			if (m_streams[s].lane == m_removed_lanes[r]) {
+				epoll_ctl(epfd, EPOLL_CTL_DEL, m_streams[s].sock, NULL);
+				pktbuffer->release_buffers(m_streams[s].bufQue);
+				closeStream(m_streams[s]);
+				m_streams.erase(m_streams.begin() + s);
+				break;
+			}
+		}
+	}
+	m_removed_lanes.clear();
+
+	m_stream_of_lane.assign(pktbuffer->get_num_lanes(), m_streams.size());
+	for (size_t s = 0; s < m_streams.size(); ++s) {
+		if (m_streams[s].lane < m_stream_of_lane.size()) {
+			m_stream_of_lane[m_streams[s].lane] = s;
+		}
+	}
+
+	m_streams_changed = false;
+	m_streams_applied = m_streams_requested;
+	lock.unlock();
+	m_streams_updated.notify_all();
+}
+
+/**
+ * Wakes runStreams out of epoll_wait to pick up added and removed streams. The caller must hold m_streams_lock.
+ */
+void SocketReader::wakeStreams() {
+	uint64_t one = 1;
+	if (m_wake_fd >= 0 && write(m_wake_fd, &one, sizeof(one)) < 0) {
+		errno = 0;
+	}
+}
+
+/**
+ * Points the iovecs at the buffers in bufQue, one iovec per buffer or, if split is set, two iovecs per
+ * buffer; the first for the header and the second for the payload which lives in a separate block.
+ */
+void SocketReader::pointIovecs(SmartPacketBuffer<SDDSheader> *pktbuffer, std::deque<SddsPacketPtr> &bufQue, struct iovec iovecs[], bool split) {
+	if (split) {
+		for (size_t i = 0; i < bufQue.size(); ++i) {
+			iovecs[2*i].iov_base   = bufQue[i];
+			iovecs[2*i+1].iov_base = pktbuffer->get_payload(bufQue[i]);
+		}
+	} else {
+		for (size_t i = 0; i < bufQue.size(); ++i) {
+			iovecs[i].iov_base = bufQue[i];
+		}
+	}
+}
+
+/**
+ * Selects a network interface that has a route for the multicast group passed in as
+ * ac argument. If no multicast group is specified, 224.0.0.0 is used to select the
+ * default multicast route. If no other routes match, the interface with the default
+ * gateway will be selected. The selected interface is returned.
+ */
+std::string SocketReader::getMcastIfaceFromRoutes(std::string group) {
+	// Asks the kernel for the route it would use, so the longest prefix match, metrics and policy routing are all its own
+	std::string iface = netlink_route_iface(group.c_str(), _log);
+	RH_DEBUG(_log, "Determined "<<iface<<" is used to route "<<group<<" using rtnetlink");
+	return iface;
 }
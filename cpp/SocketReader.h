@@ -29,28 +29,134 @@
 
 #define MAX_ALLOWED_TIMEOUT 3
 
-#include <boost/shared_ptr.hpp>
+#include <poll.h>
+#include <vector>
 #include "sddspacket.h"
 #include "SmartPacketBuffer.h"
+#include "SeqLock.h"
 #include "ossie/debug.h"
 #include "socketUtils/multicast.h"
+#include "socketUtils/netlink_route.h"
 #include "socketUtils/unicast.h"
+#include "socketUtils/packet_ring.h"
+#include "socketUtils/uring_recv.h"
+#include "socketUtils/reuseport.h"
+#include "socketUtils/sdds_filter.h"
 #include "socketUtils/SourceNicUtils.h"
 
 #define SDDS_PACKET_SIZE 1080
+#define SDDS_HEADER_SIZE 56
+#define SDDS_DATA_SIZE 1024
 
-typedef boost::shared_ptr<SDDSpacket> SddsPacketPtr;
+typedef SmartPacketBuffer<SDDSheader>::TypePtr SddsPacketPtr;
+
+#define DEFAULT_STATUS_INTERVAL_MS 100
+
+/**
+ * The socket reader's counters. Only the reader thread writes them and they sit on cache lines of their own, see
+ * SocketReader::m_counters, so counting never shares a line with anything another thread writes. Other threads only
+ * see them through the published metrics. A read is a recvmmsg call, a packet ring block or an io_uring wait, empty
+ * if it came back with nothing. The buffer wait is the time spent taking empty buffers from the packet buffer, which
+ * only blocks when the SDDS to BulkIO thread has fallen behind and the overflow policy is block. The overflow drops
+ * are the packets thrown away instead by the other overflow policies.
+ */
+typedef struct {
+	uint64_t packets;
+	uint64_t bytes;
+	uint64_t reads;
+	uint64_t empty_reads;
+	uint64_t spin_ns;
+	uint64_t poll_ns;
+	uint64_t num_polls;
+	uint64_t num_rejected;
+	uint64_t buffer_wait_ns;
+	uint64_t overflow_drops;
+	uint32_t socket_drops;
+} socket_reader_counters_t;
+
+/**
+ * The socket reader's status, published by the reader thread, see publishMetrics. The socket's queue and the NIC drops
+ * are sampled by getMetrics, and with the packet buffer occupancy only for the reader of lane 0, zero for the others.
+ */
+typedef struct {
+	uint64_t packets;
+	uint64_t bytes;
+	uint64_t reads;
+	uint64_t empty_reads;
+	double buffer_wait_time;
+	uint64_t overflow_drops;
+	double spin_time;
+	double poll_time;
+	uint64_t num_polls;
+	uint64_t num_rejected;
+	uint64_t socket_drops;
+	uint64_t rx_queue;
+	int listeners;
+	int64_t nic_rx_dropped;
+	size_t full_buffers;
+	size_t empty_buffers;
+} socket_reader_metrics_t;
+
+namespace READ_BACKEND {
+	const std::string RECVMMSG = "recvmmsg";
+	const std::string PACKET_MMAP = "packet_mmap";
+	const std::string IO_URING = "io_uring";
+}
+
+namespace WAIT_STRATEGY {
+	const std::string POLL = "poll";
+	const std::string SPIN = "spin";
+	const std::string SPIN_THEN_POLL = "spin_then_poll";
+	const std::string BUSY_POLL = "busy_poll";
+}
+
+namespace OVERFLOW_POLICY {
+	const std::string BLOCK = "block";
+	const std::string DROP_NEWEST = "drop_newest";
+	const std::string DROP_OLDEST = "drop_oldest";
+}
+
+namespace PACKET_FILTER_COMPLEX {
+	const std::string ANY = "any";
+	const std::string REAL = "real";
+	const std::string COMPLEX = "complex";
+}
 
 class SocketReader {
 public:
 	SocketReader();
 	virtual ~SocketReader();
 
-    void run(SmartPacketBuffer<SDDSpacket> *pktbuffer, const bool confirmHosts);
+    void run(SmartPacketBuffer<SDDSheader> *pktbuffer, const bool confirmHosts);
     void shutDown();
     void setPktsPerRead(size_t pkts_per_read);
     size_t getPktsPerRead();
+    void setReadBackend(std::string backend);
+    std::string getReadBackend();
+    void setLane(size_t lane, size_t num_lanes, const std::vector<int> &cpus);
+    void setUdpGro(bool udp_gro);
+    bool getUdpGro();
+    void setWaitStrategy(std::string strategy, unsigned int spin_budget_us);
+    std::string getWaitStrategy();
+    void setOverflowPolicy(std::string policy);
+    std::string getOverflowPolicy();
+    double getSpinTime();
+    double getPollTime();
+    uint64_t getNumPolls();
+    void setPacketFilter(bool enabled, std::string sender, unsigned int bps, std::string complex);
+    uint64_t getNumRejected();
+    uint64_t getSocketDrops();
+    uint64_t getSocketInode();
+    void setStatusInterval(unsigned int interval_ms);
+    socket_reader_metrics_t getMetrics();
+    void setReceiveTimestamps(bool timestamps);
+    bool getReceiveTimestamps();
+    size_t getLane();
     void setConnectionInfo(std::string interface, std::string ip, uint16_t vlan, uint16_t port) throw (BadParameterError);
+    void addStream(std::string interface, std::string ip, uint16_t vlan, uint16_t port, size_t lane) throw (BadParameterError);
+    void removeStream(size_t lane);
+    void clearStreams();
+    size_t getNumStreams();
     void setSocketBufferSize(int socket_buffer_size);
     size_t getSocketBufferSize();
     std::string getInterface();
@@ -67,7 +173,97 @@ private:
     multicast_t m_multicast_connection;
     unicast_t m_unicast_connection;
     std::string m_interface;
+    std::string m_capture_interface;
+    std::string m_ip;
+    uint16_t m_port;
+    std::string m_read_backend;
+    std::string m_active_read_backend;
+    size_t m_lane;
+    size_t m_num_lanes;
+    std::vector<int> m_lane_cpus;
+    bool m_udp_gro;
+    bool m_active_udp_gro;
+    std::string m_wait_strategy;
+    unsigned int m_spin_budget_us;
+    std::string m_overflow_policy;
+    std::string m_active_overflow_policy;
+    bool m_packet_filter;
+    bool m_filter_attached;
+    sdds_filter_t m_filter;
+    bool m_rxq_ovfl;
+    uint64_t m_socket_inode;
+    unsigned int m_status_interval_ms;
+    uint64_t m_next_publish;
+    SmartPacketBuffer<SDDSheader> *m_pktbuffer;
+    socket_reader_metrics_t m_sampled;
+    SeqLock<socket_reader_metrics_t> m_metrics;
+    bool m_timestamps;
+    bool m_active_timestamps;
+
+    // Written by the reader thread alone, padded so no other member shares their cache lines
+    char m_counters_pad0[SPSC_CACHE_LINE_SIZE];
+    socket_reader_counters_t m_counters;
+    char m_counters_pad1[SPSC_CACHE_LINE_SIZE];
+
+    // Sockets of the attached streams when serving more than one, each feeds its own lane of the packet buffer, see addStream
+    struct StreamSocket {
+        multicast_t multicast;
+        unicast_t unicast;
+        int sock;
+        size_t lane;
+        bool filter_attached;
+        struct in_addr host_addr;
+        std::deque<SddsPacketPtr> bufQue;
+    };
+    std::vector<StreamSocket> m_streams;
+    std::vector<size_t> m_stream_of_lane;
+
+    // Streams added and removed while runStreams is serving them, which it applies on its next pass, see updateStreams.
+    // The lock guards these, m_streams and the two descriptors, which are only valid while runStreams is serving.
+    boost::mutex m_streams_lock;
+    boost::condition_variable m_streams_updated;
+    std::vector<StreamSocket> m_added_streams;
+    std::vector<size_t> m_removed_lanes;
+    volatile bool m_streams_changed;
+    uint64_t m_streams_requested;
+    uint64_t m_streams_applied;
+    int m_epoll_fd;
+    int m_wake_fd;
+
+    // The socket's queue and the NIC drops as last sampled by getMetrics, at most once a status interval. The lock
+    // guards these and the interface, address, port and inode they are sampled for.
+    boost::mutex m_diag_lock;
+    uint64_t m_next_diag;
+    uint64_t m_diag_rx_queue;
+    int m_diag_listeners;
+    int64_t m_diag_nic_rx_dropped;
+
+    int openSocket(std::string &interface, std::string ip, uint16_t vlan, uint16_t port, multicast_t &multicast, unicast_t &unicast, bool reuse_port) throw (BadParameterError);
+    static uint64_t socketInode(int socket);
+    void publishMetrics(bool idle);
     void confirmSingleHost(struct mmsghdr msgs[], size_t len);
+    void confirmHost(struct in_addr host);
+    size_t dropRejected(std::deque<SddsPacketPtr> &bufQue, struct mmsghdr msgs[], size_t len);
+    void applySocketBufferSize(int socket);
+    void applyBusyPoll(int socket);
+    void applyRxqOvfl(int socket);
+    void applyTimestamps(int socket);
+    void readControl(SmartPacketBuffer<SDDSheader> *pktbuffer, std::deque<SddsPacketPtr> &bufQue, struct mmsghdr msgs[], size_t len, size_t control_size);
+    void waitForData(struct pollfd *poll_struct, uint64_t &spin_start, uint64_t &spin_last);
+    void popEmptyBuffers(SmartPacketBuffer<SDDSheader> *pktbuffer, std::deque<SddsPacketPtr> &bufQue, size_t len);
+    bool reserveEmptyBuffers(SmartPacketBuffer<SDDSheader> *pktbuffer, std::deque<SddsPacketPtr> &bufQue, size_t len, size_t lane);
+    void pushFullBuffers(SmartPacketBuffer<SDDSheader> *pktbuffer, std::deque<SddsPacketPtr> &bufQue, size_t num);
+    void countReads(struct mmsghdr msgs[], int len);
+    void runRecvmmsg(SmartPacketBuffer<SDDSheader> *pktbuffer, const bool confirmHosts, int socket);
+    bool runUdpGro(SmartPacketBuffer<SDDSheader> *pktbuffer, const bool confirmHosts, int socket);
+    bool runPacketRing(SmartPacketBuffer<SDDSheader> *pktbuffer, const bool confirmHosts, int udp_socket);
+    bool runIoUring(SmartPacketBuffer<SDDSheader> *pktbuffer, const bool confirmHosts, int socket);
+    void runStreams(SmartPacketBuffer<SDDSheader> *pktbuffer, const bool confirmHosts);
+    bool watchStream(int epfd, StreamSocket &stream);
+    void updateStreams(SmartPacketBuffer<SDDSheader> *pktbuffer, int epfd);
+    void closeStream(StreamSocket &stream);
+    void wakeStreams();
+    void pointIovecs(SmartPacketBuffer<SDDSheader> *pktbuffer, std::deque<SddsPacketPtr> &bufQue, struct iovec iovecs[], bool split);
     std::string getMcastIfaceFromRoutes(std::string group="224.0.0.0");
 
 };
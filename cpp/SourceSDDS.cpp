@@ -28,7 +28,9 @@
 
 #include "SourceSDDS.h"
 #include <signal.h>
+#include <algorithm>
 #include "AffinityUtils.h"
+#include "ByteSwap.h"
 #include <ossie/CF/cf.h>
 
 /**
@@ -37,16 +39,19 @@
  */
 SourceSDDS_i::SourceSDDS_i(const char *uuid, const char *label) :
     SourceSDDS_base(uuid, label),
+	m_pktbuffer(SDDS_DATA_SIZE),
 	m_socketReaderThread(NULL),
 	m_sddsToBulkIOThread(NULL),
-	m_sddsToBulkIO(dataOctetOut, dataShortOut, dataFloatOut)
+	m_sddsToBulkIO(dataOctetOut, dataShortOut, dataFloatOut),
+	m_buffer_numa_node(-1),
+	m_buffer_page_size(0),
+	m_buffer_locked(false)
 {
 }
 
 /**
- * Nothing to tear down, data buffer is smart pointer based and will fall out of scope if
- * not already cleaned up. REDHAWK framework should handle lifecycle and the stop call will
- * close ports and cleanup.
+ * Nothing to tear down, the packet memory is owned by the packet buffer and is freed along with it.
+ * REDHAWK framework should handle lifecycle and the stop call will close ports and cleanup.
  */
 SourceSDDS_i::~SourceSDDS_i(){}
 
@@ -56,6 +61,26 @@ SourceSDDS_i::~SourceSDDS_i(){}
  */
 void SourceSDDS_i::newSriListener(const BULKIO::StreamSRI & newSri) {
 	RH_INFO(_baseLog, "Received new upstream SRI");
+
+	// With more than one attached stream the SRI goes to the stream whose attach ID matches its stream ID, SRI for a
+	// stream that is not attached (yet) is held until it is, see attach, and never handed to another stream.
+	if (multipleStreams()) {
+		boost::unique_lock<boost::mutex> lock(m_attach_lock);
+		const std::string stream_id(newSri.streamID);
+		for (size_t i = 0; i < m_attach_streams.size(); ++i) {
+			if (m_attach_streams[i].id == stream_id) {
+				m_attach_streams[i].sri = newSri;
+				m_attach_streams[i].sri_set = true;
+				if (m_attach_streams[i].processor) {
+					m_attach_streams[i].processor->setUpstreamSri(newSri);
+				}
+				return;
+			}
+		}
+		m_pending_sri[stream_id] = newSri;
+		return;
+	}
+
 	m_sddsToBulkIO.setUpstreamSri(newSri);
 }
 
@@ -66,47 +91,117 @@ void SourceSDDS_i::newSriListener(const BULKIO::StreamSRI & newSri) {
  */
 struct status_struct SourceSDDS_i::get_status_struct() {
 	struct status_struct retVal;
-	int num_listeners;
 
-	retVal.bits_per_sample = m_sddsToBulkIO.getBps();
+	// Only copies what the worker threads last published, see SocketReader::getMetrics and SddsToBulkIOProcessor::getMetrics.
+	// With more than one attached stream the processor's status is that of the first stream, other than the drops and time
+	// slips which are summed over every stream, and each stream's own state is listed in stream_status.
+	socket_reader_metrics_t reader = m_socketReader.getMetrics();
+	boost::unique_lock<boost::mutex> lock(m_attach_lock);
+	processor_metrics_t processor = (not m_attach_streams.empty() && m_attach_streams[0].processor) ?
+			m_attach_streams[0].processor->getMetrics() : m_sddsToBulkIO.getMetrics();
+	std::stringstream streams;
+	for (size_t i = 0; i < m_attach_streams.size(); ++i) {
+		if (not m_attach_streams[i].processor) {
+			continue;
+		}
+		processor_metrics_t stream = (i == 0) ? processor : m_attach_streams[i].processor->getMetrics();
+		if (i > 0) {
+			processor.dropped_packets += stream.dropped_packets;
+			processor.time_slips += stream.time_slips;
+			streams << "; ";
+		}
+		streams << m_attach_streams[i].id << ": lane " << m_attach_streams[i].lane << ", expected sequence number " <<
+				stream.expected_sequence_number << ", dropped packets " << stream.dropped_packets << ", time slips " << stream.time_slips;
+	}
+	retVal.stream_status = streams.str();
+	retVal.attached_streams = m_attach_streams.size();
+	if (attachment_override.enabled) {
+		retVal.input_address = attachment_override.ip_address;
+		retVal.input_port = attachment_override.port;
+		retVal.input_vlan = attachment_override.vlan;
+	} else if (not m_attach_streams.empty()) {
+		retVal.input_address = m_attach_streams[0].multicastAddress;
+		retVal.input_port = m_attach_streams[0].port;
+		retVal.input_vlan = m_attach_streams[0].vlan;
+	}
+	lock.unlock();
+
+	retVal.bits_per_sample = processor.bps;
 
-	float percent = 100*(float) m_pktbuffer.get_num_full_buffers() / (float) advanced_optimizations.buffer_size;
+	float percent = 100*(float) reader.full_buffers / (float) advanced_optimizations.buffer_size;
 	std::stringstream ss;
 	ss.precision(2);
-	ss << std::fixed << m_pktbuffer.get_num_full_buffers() << " (" << percent << "%)";
+	ss << std::fixed << reader.full_buffers << " (" << percent << "%)";
 	retVal.buffers_to_work = ss.str();
 	ss.str("");
 
-	percent = 100*(float) m_pktbuffer.get_num_empty_buffers() / (float) advanced_optimizations.buffer_size;
-	ss << std::fixed << m_pktbuffer.get_num_empty_buffers() << " (" << percent << "%)";
+	percent = 100*(float) reader.empty_buffers / (float) advanced_optimizations.buffer_size;
+	ss << std::fixed << reader.empty_buffers << " (" << percent << "%)";
 	retVal.empty_buffers_available = ss.str();
 	ss.str("");
 
-	retVal.dropped_packets = m_sddsToBulkIO.getNumDropped();
+	retVal.dropped_packets = processor.dropped_packets;
 
-	retVal.expected_sequence_number = m_sddsToBulkIO.getExpectedSequenceNumber();
-
-	retVal.input_address = (attachment_override.enabled) ? attachment_override.ip_address:m_attach_stream.multicastAddress;
-	retVal.input_port = (attachment_override.enabled) ? attachment_override.port:m_attach_stream.port;
-	retVal.input_vlan = (attachment_override.enabled) ? attachment_override.vlan:m_attach_stream.vlan;
+	retVal.expected_sequence_number = processor.expected_sequence_number;
 
 	// Not 100% sure why but the queue can actually get about 280 bytes larger than the set max. I guess linux gives 110% har har har (not actually 110%)
-	uint64_t rx_queue = get_rx_queue(retVal.input_address, retVal.input_port, num_listeners, _baseLog);
-	percent = 100*(float) rx_queue / (float) m_socketReader.getSocketBufferSize();
-	ss << std::fixed << rx_queue << " / " << m_socketReader.getSocketBufferSize() << " (" << percent << "%)";
+	percent = 100*(float) reader.rx_queue / (float) m_socketReader.getSocketBufferSize();
+	ss << std::fixed << reader.rx_queue << " / " << m_socketReader.getSocketBufferSize() << " (" << percent << "%)";
 	retVal.udp_socket_buffer_queue = ss.str();
-	retVal.num_udp_socket_readers = num_listeners;
+	retVal.num_udp_socket_readers = reader.listeners;
 	ss.str("");
 
-	retVal.input_stream_id = m_sddsToBulkIO.getStreamId();
-	retVal.input_samplerate = m_sddsToBulkIO.getSampleRate();
-	retVal.input_endianness = m_sddsToBulkIO.getEndianness();
-	retVal.time_slips = m_sddsToBulkIO.getTimeSlips();
+	retVal.input_stream_id = processor.stream_id;
+	retVal.input_samplerate = processor.sample_rate;
+	retVal.input_endianness = processor.endianness;
+	retVal.time_slips = processor.time_slips;
 
-	retVal.num_packets_dropped_by_nic = get_rx_dropped(status.interface, _baseLog);
+	retVal.num_packets_dropped_by_nic = reader.nic_rx_dropped;
 
 	retVal.interface = status.interface;
 
+	retVal.socket_wait_spin_time = reader.spin_time;
+	retVal.socket_wait_poll_time = reader.poll_time;
+	retVal.socket_wait_polls = reader.num_polls;
+	retVal.rejected_packets = reader.num_rejected;
+	retVal.socket_buffer_drops = reader.socket_drops;
+	retVal.dequeue_latency_p50 = processor.dequeue_latency[0];
+	retVal.dequeue_latency_p99 = processor.dequeue_latency[1];
+	retVal.dequeue_latency_p999 = processor.dequeue_latency[2];
+	retVal.dequeue_latency_max = processor.dequeue_latency[3];
+	retVal.push_latency_p50 = processor.push_latency[0];
+	retVal.push_latency_p99 = processor.push_latency[1];
+	retVal.push_latency_p999 = processor.push_latency[2];
+	retVal.push_latency_max = processor.push_latency[3];
+	retVal.packets_received = reader.packets;
+	retVal.bytes_received = reader.bytes;
+	retVal.socket_reads = reader.reads;
+	retVal.empty_socket_reads = reader.empty_reads;
+	retVal.socket_reader_buffer_wait = reader.buffer_wait_time;
+	retVal.processor_buffer_wait = processor.buffer_wait_time;
+	retVal.overflow_drops = reader.overflow_drops;
+	retVal.numa_node = m_buffer_numa_node;
+	retVal.buffer_page_size = m_buffer_page_size;
+	retVal.buffer_locked = m_buffer_locked;
+	retVal.byte_swap_kernel = byteSwapKernel();
+
+	boost::unique_lock<boost::mutex> readers_lock(m_readers_lock);
+	for (size_t i = 0; i < m_extraSocketReaders.size(); ++i) {
+		socket_reader_metrics_t extra = m_extraSocketReaders[i]->getMetrics();
+		retVal.packets_received += extra.packets;
+		retVal.bytes_received += extra.bytes;
+		retVal.socket_reads += extra.reads;
+		retVal.empty_socket_reads += extra.empty_reads;
+		retVal.socket_reader_buffer_wait += extra.buffer_wait_time;
+		retVal.overflow_drops += extra.overflow_drops;
+		retVal.socket_wait_spin_time += extra.spin_time;
+		retVal.socket_wait_poll_time += extra.poll_time;
+		retVal.socket_wait_polls += extra.num_polls;
+		retVal.rejected_packets += extra.num_rejected;
+		retVal.socket_buffer_drops += extra.socket_drops;
+	}
+	readers_lock.unlock();
+
 	return retVal;
 }
 
@@ -133,6 +228,7 @@ struct advanced_optimizations_struct SourceSDDS_i::get_advanced_optimizations_st
 	struct advanced_optimizations_struct retVal;
 	retVal.buffer_size = advanced_optimizations.buffer_size;
 	retVal.pkts_per_socket_read = m_socketReader.getPktsPerRead();
+	retVal.socket_read_backend = m_socketReader.getReadBackend();
 	retVal.sdds_pkts_per_bulkio_push = m_sddsToBulkIO.getPktsPerRead();
 	retVal.sdds_to_bulkio_thread_affinity = advanced_optimizations.sdds_to_bulkio_thread_affinity;
 	retVal.socket_read_thread_affinity = advanced_optimizations.socket_read_thread_affinity;
@@ -149,6 +245,24 @@ struct advanced_optimizations_struct SourceSDDS_i::get_advanced_optimizations_st
 	retVal.sdds_to_bulkio_thread_priority = advanced_optimizations.sdds_to_bulkio_thread_priority;
 	retVal.socket_read_thread_priority = advanced_optimizations.socket_read_thread_priority;
 	retVal.check_for_duplicate_sender = advanced_optimizations.check_for_duplicate_sender;
+	retVal.lock_free_buffer = advanced_optimizations.lock_free_buffer;
+	retVal.scatter_receive = advanced_optimizations.scatter_receive;
+	retVal.socket_readers = advanced_optimizations.socket_readers;
+	retVal.socket_reader_cpus = advanced_optimizations.socket_reader_cpus;
+	retVal.max_attached_streams = advanced_optimizations.max_attached_streams;
+	retVal.socket_wait_strategy = m_socketReader.getWaitStrategy();
+	retVal.socket_wait_spin_budget = advanced_optimizations.socket_wait_spin_budget;
+	retVal.udp_gro = m_socketReader.getUdpGro();
+	retVal.packet_filter = advanced_optimizations.packet_filter;
+	retVal.packet_filter_sender = advanced_optimizations.packet_filter_sender;
+	retVal.packet_filter_bps = advanced_optimizations.packet_filter_bps;
+	retVal.packet_filter_complex = advanced_optimizations.packet_filter_complex;
+	retVal.receive_timestamps = advanced_optimizations.receive_timestamps;
+	retVal.status_interval = advanced_optimizations.status_interval;
+	retVal.overflow_policy = m_socketReader.getOverflowPolicy();
+	retVal.numa_node = advanced_optimizations.numa_node;
+	retVal.huge_pages = advanced_optimizations.huge_pages;
+	retVal.lock_buffer = advanced_optimizations.lock_buffer;
 
 	return retVal;
 }
@@ -193,6 +307,13 @@ void SourceSDDS_i::set_advanced_optimization_struct(struct advanced_optimization
 		RH_WARN(_baseLog, "Cannot set packets per socket read size while the component is running");
 	}
 
+	if (not started()) {
+		m_socketReader.setReadBackend(request.socket_read_backend);
+		advanced_optimizations.socket_read_backend = m_socketReader.getReadBackend();
+	} else if (advanced_optimizations.socket_read_backend != request.socket_read_backend) {
+		RH_WARN(_baseLog, "Cannot change the socket read backend while the component is running");
+	}
+
 	if (not started()) {
 		advanced_optimizations.sdds_pkts_per_bulkio_push = request.sdds_pkts_per_bulkio_push;
 		m_sddsToBulkIO.setPktsPerRead(request.sdds_pkts_per_bulkio_push);
@@ -241,6 +362,123 @@ void SourceSDDS_i::set_advanced_optimization_struct(struct advanced_optimization
 	} else if (advanced_optimizations.check_for_duplicate_sender != request.check_for_duplicate_sender) {
 		RH_WARN(_baseLog, "Cannot change the check for single sender property while running");
 	}
+
+	if (not started()) {
+		advanced_optimizations.lock_free_buffer = request.lock_free_buffer;
+	} else if (advanced_optimizations.lock_free_buffer != request.lock_free_buffer) {
+		RH_WARN(_baseLog, "Cannot change the lock free buffer property while running");
+	}
+
+	if (not started()) {
+		advanced_optimizations.scatter_receive = request.scatter_receive;
+	} else if (advanced_optimizations.scatter_receive != request.scatter_receive) {
+		RH_WARN(_baseLog, "Cannot change the scatter receive property while running");
+	}
+
+	if (not started()) {
+		advanced_optimizations.socket_readers = request.socket_readers;
+	} else if (advanced_optimizations.socket_readers != request.socket_readers) {
+		RH_WARN(_baseLog, "Cannot change the number of socket readers while running");
+	}
+
+	if (not started()) {
+		advanced_optimizations.socket_reader_cpus = request.socket_reader_cpus;
+	} else if (advanced_optimizations.socket_reader_cpus != request.socket_reader_cpus) {
+		RH_WARN(_baseLog, "Cannot change the socket reader CPUs while running");
+	}
+
+	if (not started()) {
+		boost::unique_lock<boost::mutex> lock(m_attach_lock);
+		size_t max_streams = (request.max_attached_streams) ? request.max_attached_streams : 1;
+		if (max_streams < m_attach_streams.size()) {
+			RH_WARN(_baseLog, "Cannot lower the maximum number of attached streams below the " << m_attach_streams.size() << " streams currently attached");
+		} else {
+			advanced_optimizations.max_attached_streams = request.max_attached_streams;
+		}
+	} else if (advanced_optimizations.max_attached_streams != request.max_attached_streams) {
+		RH_WARN(_baseLog, "Cannot change the maximum number of attached streams while running");
+	}
+
+	if (not started()) {
+		m_socketReader.setWaitStrategy(request.socket_wait_strategy, request.socket_wait_spin_budget);
+		advanced_optimizations.socket_wait_strategy = m_socketReader.getWaitStrategy();
+		advanced_optimizations.socket_wait_spin_budget = request.socket_wait_spin_budget;
+	} else if (advanced_optimizations.socket_wait_strategy != request.socket_wait_strategy || advanced_optimizations.socket_wait_spin_budget != request.socket_wait_spin_budget) {
+		RH_WARN(_baseLog, "Cannot change the socket wait strategy while running");
+	}
+
+	if (not started()) {
+		advanced_optimizations.udp_gro = request.udp_gro;
+		m_socketReader.setUdpGro(request.udp_gro);
+	} else if (advanced_optimizations.udp_gro != request.udp_gro) {
+		RH_WARN(_baseLog, "Cannot change UDP GRO while running");
+	}
+
+	if (not started()) {
+		advanced_optimizations.packet_filter = request.packet_filter;
+		advanced_optimizations.packet_filter_sender = request.packet_filter_sender;
+		advanced_optimizations.packet_filter_bps = request.packet_filter_bps;
+		advanced_optimizations.packet_filter_complex = request.packet_filter_complex;
+		m_socketReader.setPacketFilter(request.packet_filter, request.packet_filter_sender, request.packet_filter_bps, request.packet_filter_complex);
+	} else if (advanced_optimizations.packet_filter != request.packet_filter || advanced_optimizations.packet_filter_sender != request.packet_filter_sender ||
+			advanced_optimizations.packet_filter_bps != request.packet_filter_bps || advanced_optimizations.packet_filter_complex != request.packet_filter_complex) {
+		RH_WARN(_baseLog, "Cannot change the packet filter while running");
+	}
+
+	if (not started()) {
+		advanced_optimizations.receive_timestamps = request.receive_timestamps;
+		m_socketReader.setReceiveTimestamps(request.receive_timestamps);
+		m_sddsToBulkIO.setLatencyTracking(request.receive_timestamps);
+	} else if (advanced_optimizations.receive_timestamps != request.receive_timestamps) {
+		RH_WARN(_baseLog, "Cannot change receive time stamps while running");
+	}
+
+	if (not started()) {
+		m_socketReader.setOverflowPolicy(request.overflow_policy);
+		advanced_optimizations.overflow_policy = m_socketReader.getOverflowPolicy();
+	} else if (advanced_optimizations.overflow_policy != request.overflow_policy) {
+		RH_WARN(_baseLog, "Cannot change the overflow policy while running");
+	}
+
+	if (not started()) {
+		advanced_optimizations.numa_node = request.numa_node;
+	} else if (advanced_optimizations.numa_node != request.numa_node) {
+		RH_WARN(_baseLog, "Cannot change the NUMA node while running");
+	}
+
+	if (not started()) {
+		if (request.huge_pages != HUGE_PAGES::NONE && request.huge_pages != HUGE_PAGES::TRANSPARENT && request.huge_pages != HUGE_PAGES::HUGETLB) {
+			RH_WARN(_baseLog, "Unknown huge pages setting: " << request.huge_pages << " using " << HUGE_PAGES::NONE);
+			advanced_optimizations.huge_pages = HUGE_PAGES::NONE;
+		} else {
+			advanced_optimizations.huge_pages = request.huge_pages;
+		}
+	} else if (advanced_optimizations.huge_pages != request.huge_pages) {
+		RH_WARN(_baseLog, "Cannot change the huge pages setting while running");
+	}
+
+	if (not started()) {
+		advanced_optimizations.lock_buffer = request.lock_buffer;
+	} else if (advanced_optimizations.lock_buffer != request.lock_buffer) {
+		RH_WARN(_baseLog, "Cannot change the buffer lock while running");
+	}
+
+	// Only read by the worker threads when they next publish so it can be changed at any time
+	advanced_optimizations.status_interval = request.status_interval;
+	m_socketReader.setStatusInterval(request.status_interval);
+	m_sddsToBulkIO.setStatusInterval(request.status_interval);
+	boost::unique_lock<boost::mutex> readers_lock(m_readers_lock);
+	for (size_t i = 0; i < m_extraSocketReaders.size(); ++i) {
+		m_extraSocketReaders[i]->setStatusInterval(request.status_interval);
+	}
+	readers_lock.unlock();
+	boost::unique_lock<boost::mutex> lock(m_attach_lock);
+	for (size_t i = 0; i < m_attach_streams.size(); ++i) {
+		if (m_attach_streams[i].processor) {
+			m_attach_streams[i].processor->setStatusInterval(request.status_interval);
+		}
+	}
+	lock.unlock();
 }
 
 /**
@@ -257,7 +495,7 @@ void SourceSDDS_i::start() throw (CORBA::SystemException, CF::Resource::StartErr
 	//////////////////////////////////////////
 	// Setup the socketReader
 	//////////////////////////////////////////
-	if (not m_attach_stream.attached && not attachment_override.enabled) {
+	if (m_attach_streams.empty() && not attachment_override.enabled) {
 		RH_INFO(_baseLog, "Cannot setup the socket reader without either a successful attach or attachment override set. "
 				"Component will start but will be in a holding pattern until attach override set or attach call made.");
 	} else {
@@ -274,36 +512,112 @@ void SourceSDDS_i::_start() throw (CF::Resource::StartError) {
 	// This also destroys all of our buffers
 	destroyBuffersAndJoinThreads();
 
-	// Initialize our buffer of packets
-	m_pktbuffer.initialize(advanced_optimizations.buffer_size);
+	// Initialize our buffer of packets, the io_uring backend needs room in front of each packet for the recvmsg header
+	// and each socket reader gets its own lane of the buffer. With more than one attached stream there is a lane for
+	// each stream that may be attached so streams can come and go while running, each attached stream takes one.
+	size_t headroom = (advanced_optimizations.socket_read_backend == READ_BACKEND::IO_URING) ? URING_RECV_HEADROOM : 0;
+	const bool multiple = multipleStreams();
+	size_t num_readers = (multiple) ? 1 : getNumSocketReaders();
+	size_t num_lanes = (multiple) ? advanced_optimizations.max_attached_streams : num_readers;
+	if (multiple && advanced_optimizations.buffer_size / num_lanes < advanced_optimizations.pkts_per_socket_read) {
+		RH_WARN(_baseLog, "The buffer size is too small to give each of the " << num_lanes << " attachable streams a full socket read of packets");
+	}
+	if (multiple) {
+		boost::unique_lock<boost::mutex> lock(m_attach_lock);
+		for (size_t i = 0; i < m_attach_streams.size(); ++i) {
+			m_attach_streams[i].lane = i;
+		}
+	}
 
 	try {
-		setupSocketReaderOptions();
+		setupSocketReaderOptions(num_readers);
 	} catch (BadParameterError &e) {
 		errorText << "Failed to setup socket reader options: " << e.what();
 		RH_ERROR(_baseLog, errorText.str());
 		throw CF::Resource::StartError(CF::CF_EINVAL, errorText.str().c_str());
 	}
 
+	// Done once the socket reader has picked the interface so the buffer can be placed on the interface's NUMA node,
+	// which is also when it is faulted in, and if asked locked, so the first bursts do not wait on page faults.
+	int numa_node = getNumaNode();
+	arena_pages_t pages = ARENA_PAGES_DEFAULT;
+	if (advanced_optimizations.huge_pages == HUGE_PAGES::TRANSPARENT) {
+		pages = ARENA_PAGES_TRANSPARENT;
+	} else if (advanced_optimizations.huge_pages == HUGE_PAGES::HUGETLB) {
+		pages = ARENA_PAGES_HUGETLB;
+	}
+
+	m_pktbuffer.initialize(advanced_optimizations.buffer_size, advanced_optimizations.lock_free_buffer, advanced_optimizations.scatter_receive, headroom, num_lanes, numa_node,
+			pages, advanced_optimizations.lock_buffer);
+	m_buffer_numa_node = m_pktbuffer.get_numa_node();
+	m_buffer_page_size = m_pktbuffer.get_page_size();
+	m_buffer_locked = m_pktbuffer.is_locked();
+	if (numa_node >= 0 && m_buffer_numa_node != numa_node) {
+		RH_WARN(_baseLog, "Could not place the packet buffer on NUMA node " << numa_node);
+	}
+	if (pages != ARENA_PAGES_DEFAULT && m_buffer_page_size == (size_t) sysconf(_SC_PAGESIZE)) {
+		RH_WARN(_baseLog, "Could not back the packet buffer with huge pages, check the huge page pool and /sys/kernel/mm/transparent_hugepage/enabled");
+	}
+	if (advanced_optimizations.lock_buffer && not m_buffer_locked) {
+		RH_WARN(_baseLog, "Could not lock the packet buffer into memory, check RLIMIT_MEMLOCK");
+	}
+
+	// Threads without an affinity of their own follow the buffer onto its node
+	std::vector<int> node_cpus;
+	if (numa_node >= 0 && not getNumaNodeCpus(numa_node, node_cpus)) {
+		RH_WARN(_baseLog, "Could not find the CPUs of NUMA node " << numa_node << " the threads will not be pinned to it");
+	}
+
 	m_socketReaderThread = new boost::thread(boost::bind(&SocketReader::run, boost::ref(m_socketReader), &m_pktbuffer, advanced_optimizations.check_for_duplicate_sender));
+	for (size_t i = 0; i < m_extraSocketReaders.size(); ++i) {
+		m_extraSocketReaderThreads.push_back(new boost::thread(boost::bind(&SocketReader::run, m_extraSocketReaders[i], &m_pktbuffer, advanced_optimizations.check_for_duplicate_sender)));
+	}
 
-	// Attempt to set the affinity of the socket reader thread if the user has told us to.
-	if (!advanced_optimizations.socket_read_thread_affinity.empty() && !(advanced_optimizations.socket_read_thread_affinity == "")) {
+	// Each of several socket readers is pinned to its own CPU if the user has listed them, otherwise
+	// attempt to set the affinity of the socket reader threads if the user has told us to.
+	std::vector<int> cpus;
+	if (num_readers > 1) {
+		parseCpuList(advanced_optimizations.socket_reader_cpus, cpus);
+	}
+
+	if (not cpus.empty()) {
+		setAffinityToCpu(m_socketReaderThread->native_handle(), cpus[0]);
+		for (size_t i = 0; i < m_extraSocketReaderThreads.size(); ++i) {
+			setAffinityToCpu(m_extraSocketReaderThreads[i]->native_handle(), cpus[(i + 1) % cpus.size()]);
+		}
+	} else if (!advanced_optimizations.socket_read_thread_affinity.empty() && !(advanced_optimizations.socket_read_thread_affinity == "")) {
 		setAffinity(m_socketReaderThread->native_handle(), advanced_optimizations.socket_read_thread_affinity);
+		for (size_t i = 0; i < m_extraSocketReaderThreads.size(); ++i) {
+			setAffinity(m_extraSocketReaderThreads[i]->native_handle(), advanced_optimizations.socket_read_thread_affinity);
+		}
+	} else if (not node_cpus.empty()) {
+		setAffinityToCpus(m_socketReaderThread->native_handle(), node_cpus);
+		for (size_t i = 0; i < m_extraSocketReaderThreads.size(); ++i) {
+			setAffinityToCpus(m_extraSocketReaderThreads[i]->native_handle(), node_cpus);
+		}
 	}
 
 	advanced_optimizations.socket_read_thread_affinity = getAffinity(m_socketReaderThread->native_handle(), _baseLog);
 	setPolicyAndPriority(m_socketReaderThread->native_handle(), advanced_optimizations.socket_read_thread_priority, "socket reader thread", _baseLog);
+	for (size_t i = 0; i < m_extraSocketReaderThreads.size(); ++i) {
+		setPolicyAndPriority(m_extraSocketReaderThreads[i]->native_handle(), advanced_optimizations.socket_read_thread_priority, "socket reader thread", _baseLog);
+	}
 
 	//////////////////////////////////////////
 	// Now setup the packet processor
 	//////////////////////////////////////////
 	setupSddsToBulkIOOptions();
-	m_sddsToBulkIOThread = new boost::thread(boost::bind(&SddsToBulkIOProcessor::run, boost::ref(m_sddsToBulkIO), &m_pktbuffer));
+	if (multiple) {
+		m_sddsToBulkIOThread = new boost::thread(boost::bind(&SddsToBulkIOProcessor::runStreams, &m_streamProcessors, &m_pktbuffer));
+	} else {
+		m_sddsToBulkIOThread = new boost::thread(boost::bind(&SddsToBulkIOProcessor::run, boost::ref(m_sddsToBulkIO), &m_pktbuffer));
+	}
 
 	// Attempt to set the affinity of the sdds to bulkio thread if the user has told us to.
 	if (!advanced_optimizations.sdds_to_bulkio_thread_affinity.empty() && !(advanced_optimizations.sdds_to_bulkio_thread_affinity== "")) {
 		setAffinity(m_sddsToBulkIOThread->native_handle(), advanced_optimizations.sdds_to_bulkio_thread_affinity);
+	} else if (not node_cpus.empty()) {
+		setAffinityToCpus(m_sddsToBulkIOThread->native_handle(), node_cpus);
 	}
 
 	advanced_optimizations.sdds_to_bulkio_thread_affinity = getAffinity(m_sddsToBulkIOThread->native_handle(), _baseLog);
@@ -323,19 +637,125 @@ void SourceSDDS_i::stop () throw (CF::Resource::StopError, CORBA::SystemExceptio
 	RH_DEBUG(_baseLog, "Finished stopping");
 }
 
+/**
+ * Returns whether more than one stream may be attached, in which case every attached stream gets its own socket, lane
+ * of the packet buffer and SDDS to BulkIO processor, all served by a single socket reader and a single processor thread.
+ */
+bool SourceSDDS_i::multipleStreams() {
+	return advanced_optimizations.max_attached_streams > 1 && not attachment_override.enabled;
+}
+
+/**
+ * Returns whether the threads serving more than one attached stream are running, in which case streams are attached
+ * and detached by handing their socket and processor to the running threads rather than by restarting.
+ */
+bool SourceSDDS_i::streamsRunning() {
+	return started() && multipleStreams() && m_sddsToBulkIOThread != NULL;
+}
+
+/**
+ * Returns the number of socket readers to start. This is the socket_readers property unless the packet_mmap backend
+ * is in use, which only supports a single reader, or the packet buffer is too small to give each reader a lane of at
+ * least one socket read plus one BulkIO push worth of packets.
+ */
+size_t SourceSDDS_i::getNumSocketReaders() {
+	size_t num_readers = (advanced_optimizations.socket_readers) ? advanced_optimizations.socket_readers : 1;
+
+	if (num_readers > 1 && advanced_optimizations.socket_read_backend == READ_BACKEND::PACKET_MMAP) {
+		RH_WARN(_baseLog, "The " << READ_BACKEND::PACKET_MMAP << " backend only supports a single socket reader");
+		return 1;
+	}
+
+	size_t lane_minimum = advanced_optimizations.pkts_per_socket_read + advanced_optimizations.sdds_pkts_per_bulkio_push;
+	if (num_readers > 1 && advanced_optimizations.buffer_size / num_readers < lane_minimum) {
+		num_readers = std::max((size_t) advanced_optimizations.buffer_size / lane_minimum, (size_t) 1);
+		RH_WARN(_baseLog, "The buffer size is too small for " << advanced_optimizations.socket_readers << " socket readers, using " << num_readers);
+	}
+
+	return num_readers;
+}
+
+/**
+ * Returns the NUMA node the packet buffer should be placed on from the numa_node property, which is either empty for
+ * no placement, interface for the node the socket reader's interface is attached to, or a node number. Returns -1
+ * for no placement, including when the interface's node is unknown or the property could not be parsed.
+ */
+int SourceSDDS_i::getNumaNode() {
+	const std::string &numa_node = advanced_optimizations.numa_node;
+	if (numa_node.empty()) {
+		return -1;
+	}
+
+	if (numa_node == "interface") {
+		int node = getInterfaceNumaNode(m_socketReader.getInterface(), _baseLog);
+		if (node < 0) {
+			RH_INFO(_baseLog, "The NUMA node of interface " << m_socketReader.getInterface() << " is not known, the packet buffer will not be placed");
+		}
+		return node;
+	}
+
+	try {
+		return std::max(boost::lexical_cast<int>(numa_node), -1);
+	} catch (boost::bad_lexical_cast &e) {
+		RH_WARN(_baseLog, "Could not parse the NUMA node: " << numa_node << " the packet buffer will not be placed");
+		return -1;
+	}
+}
+
 /**
  * Sets the IP and port on the class socket reader from either the SDDS port or the properties depending on
  * override settings. If there is an issue with setting up the network parameters a Bad Parameter Error is thrown
+ * With more than one socket reader the additional readers are created here and set up the same way. When more than
+ * one stream may be attached the single socket reader is given a socket for each attached stream instead.
  *
  * @throws BadParameterError is thrown by the underlying setConnectionInfo call in the socketReader class for a number of reasons
  */
-void SourceSDDS_i::setupSocketReaderOptions() throw (BadParameterError) {
-	if (attachment_override.enabled) {
-		m_socketReader.setConnectionInfo(interface, attachment_override.ip_address, attachment_override.vlan, attachment_override.port);
-	} else {
-		m_socketReader.setConnectionInfo(interface, m_attach_stream.multicastAddress, m_attach_stream.vlan, m_attach_stream.port);
+void SourceSDDS_i::setupSocketReaderOptions(size_t num_readers) throw (BadParameterError) {
+	std::vector<int> cpus;
+	if (num_readers > 1 && not parseCpuList(advanced_optimizations.socket_reader_cpus, cpus)) {
+		RH_WARN(_baseLog, "Could not parse the socket reader CPU list: " << advanced_optimizations.socket_reader_cpus << " the socket readers will not be pinned");
+	}
+
+	m_socketReader.clearStreams();
+	if (multipleStreams()) {
+		m_socketReader.setLane(0, 1, cpus);
+		boost::unique_lock<boost::mutex> lock(m_attach_lock);
+		for (size_t i = 0; i < m_attach_streams.size(); ++i) {
+			const struct attach_stream &stream = m_attach_streams[i];
+			m_socketReader.addStream(interface, stream.multicastAddress, stream.vlan, stream.port, stream.lane);
+		}
+		lock.unlock();
+		m_socketReader.setPktsPerRead(advanced_optimizations.pkts_per_socket_read);
+		status.interface = m_socketReader.getInterface();
+		return;
+	}
+
+	for (size_t lane = 1; lane < num_readers; ++lane) {
+		SocketReader *reader = new SocketReader();
+		boost::unique_lock<boost::mutex> lock(m_readers_lock);
+		m_extraSocketReaders.push_back(reader);
+		lock.unlock();
+		reader->setLogger(socket_log);
+		reader->setReadBackend(m_socketReader.getReadBackend());
+		reader->setSocketBufferSize(m_socketReader.getSocketBufferSize());
+		reader->setWaitStrategy(m_socketReader.getWaitStrategy(), advanced_optimizations.socket_wait_spin_budget);
+		reader->setOverflowPolicy(m_socketReader.getOverflowPolicy());
+		reader->setUdpGro(advanced_optimizations.udp_gro);
+		reader->setReceiveTimestamps(advanced_optimizations.receive_timestamps);
+		reader->setStatusInterval(advanced_optimizations.status_interval);
+		reader->setPacketFilter(advanced_optimizations.packet_filter, advanced_optimizations.packet_filter_sender, advanced_optimizations.packet_filter_bps, advanced_optimizations.packet_filter_complex);
+	}
+
+	for (size_t lane = 0; lane < num_readers; ++lane) {
+		SocketReader &reader = (lane == 0) ? m_socketReader : *m_extraSocketReaders[lane - 1];
+		reader.setLane(lane, num_readers, cpus);
+		if (attachment_override.enabled) {
+			reader.setConnectionInfo(interface, attachment_override.ip_address, attachment_override.vlan, attachment_override.port);
+		} else {
+			reader.setConnectionInfo(interface, m_attach_streams[0].multicastAddress, m_attach_streams[0].vlan, m_attach_streams[0].port);
+		}
+		reader.setPktsPerRead(advanced_optimizations.pkts_per_socket_read);
 	}
-	m_socketReader.setPktsPerRead(advanced_optimizations.pkts_per_socket_read);
 	status.interface = m_socketReader.getInterface();
 }
 
@@ -345,6 +765,9 @@ void SourceSDDS_i::setupSocketReaderOptions() throw (BadParameterError) {
  * rate is retrieved directly from the SDDS header or from the provided SRI if the proper keywords
  * are used. (See the relevant documentation for details) If the component had been started and running
  * from an attachment_override value then the componet will stop, setup the new stream, and restart.
+ * Up to max_attached_streams streams may be attached at once. If the component is running when another stream is
+ * attached the stream is handed to the running threads on a free lane of the packet buffer, the streams already
+ * attached carry on undisturbed.
  *
  * @param stream A struct containing the stream definition including network parameters and stream ID. Note that the sample rate is NOT USED!
  * @param userid Used only to log who has made the attach called. This value is not used for anything other than logging.
@@ -353,20 +776,69 @@ void SourceSDDS_i::setupSocketReaderOptions() throw (BadParameterError) {
  */
 char* SourceSDDS_i::attach(const BULKIO::SDDSStreamDefinition& stream, const char* userid) throw (BULKIO::dataSDDS::AttachError, BULKIO::dataSDDS::StreamInputError) {
 	RH_INFO(_baseLog, "Attach called by: " << userid);
-	if (m_attach_stream.attached) {
-		RH_ERROR(_baseLog, "Can only handle a single attach. Detach current stream: " << m_attach_stream.id);
-		throw BULKIO::dataSDDS::AttachError("Can only handle a single attach. Detach current stream first");
+	boost::unique_lock<boost::mutex> lock(m_attach_lock);
+	size_t max_streams = (advanced_optimizations.max_attached_streams) ? advanced_optimizations.max_attached_streams : 1;
+	if (m_attach_streams.size() >= max_streams) {
+		if (max_streams == 1) {
+			RH_ERROR(_baseLog, "Can only handle a single attach. Detach current stream: " << m_attach_streams[0].id);
+			throw BULKIO::dataSDDS::AttachError("Can only handle a single attach. Detach current stream first");
+		}
+		RH_ERROR(_baseLog, "Can only handle " << max_streams << " attached streams. Detach a current stream first");
+		throw BULKIO::dataSDDS::AttachError("Can only handle max_attached_streams attached streams. Detach a current stream first");
+	}
+
+	struct attach_stream attached;
+	attached.id = stream.id;
+	attached.multicastAddress = stream.multicastAddress;
+	attached.port = stream.port;
+	attached.vlan = stream.vlan;
+	attached.sri_set = false;
+	attached.lane = findFreeLane();
+	attached.processor = NULL;
+
+	if (attached.id.empty() || attached.id == "") {
+		attached.id = ossie::generateUUID();
 	}
 
-	m_attach_stream.attached = true;
-	m_attach_stream.id = stream.id;
-	m_attach_stream.multicastAddress = stream.multicastAddress;
-	m_attach_stream.port = stream.port;
-	m_attach_stream.vlan = stream.vlan;
+	// SRI may have been pushed for the stream before it was attached
+	std::map<std::string, BULKIO::StreamSRI>::iterator pending = m_pending_sri.find(attached.id);
+	if (pending != m_pending_sri.end()) {
+		attached.sri = pending->second;
+		attached.sri_set = true;
+	}
+
+	for (size_t i = 0; i < m_attach_streams.size(); ++i) {
+		if (m_attach_streams[i].id == attached.id) {
+			RH_ERROR(_baseLog, "A stream is already attached with the ID: " << attached.id);
+			throw BULKIO::dataSDDS::AttachError("A stream is already attached with this ID");
+		}
+	}
+
+	if (streamsRunning()) {
+		attached.processor = newStreamProcessor(attached);
+		m_streamProcessors.add(attached.lane, attached.processor);
+		try {
+			m_socketReader.addStream(interface, attached.multicastAddress, attached.vlan, attached.port, attached.lane);
+		} catch (BadParameterError &e) {
+			m_streamProcessors.remove(attached.lane);
+			delete attached.processor;
+			m_pktbuffer.reset_lane(attached.lane);
+			std::stringstream errorText;
+			errorText << "Failed to open the socket of the attached stream: " << e.what();
+			RH_ERROR(_baseLog, errorText.str());
+			throw BULKIO::dataSDDS::AttachError(errorText.str().c_str());
+		}
+		RH_INFO(_baseLog, "Attached stream " << attached.id << " on lane " << attached.lane << " while running");
+	}
 
-	if (m_attach_stream.id.empty() || m_attach_stream.id == "") {
-		m_attach_stream.id = ossie::generateUUID();
+	m_attach_streams.push_back(attached);
+	if (pending != m_pending_sri.end()) {
+		m_pending_sri.erase(pending);
 	}
+	if (attached.processor) {
+		return CORBA::string_dup(attached.id.c_str());
+	}
+	lock.unlock();
 
 	if (started() && !attachment_override.enabled) {
 		RH_INFO(_baseLog, "Attempting to start SourceSDDS processing with provided attach values.");
@@ -376,27 +848,50 @@ char* SourceSDDS_i::attach(const BULKIO::SDDSStreamDefinition& stream, const cha
 			std::stringstream errorText;
 			errorText << "Failed to start component with provided attach values, attach has failed with the error: " << e.msg;
 			RH_ERROR(_baseLog, errorText.str());
-			m_attach_stream.attached = false;
+			lock.lock();
+			m_attach_streams.pop_back();
+			lock.unlock();
 			throw BULKIO::dataSDDS::AttachError(errorText.str().c_str());
 		}
 	}
 
-	return CORBA::string_dup(m_attach_stream.id.c_str());
+	return CORBA::string_dup(attached.id.c_str());
 }
 
 /**
  * Required method by the Attach Detach Callback API. Used to remove an attached SDDS stream.
  * Throws a detach error if there is no stream which matches the attachId given.
  * If the component is running during a valid detach, the component will stop, detach, and attempt to
- * restart. The detach call will also have affect of unsetting any upstream SRI from the SDDS to
- * BulkIO class.
+ * restart. Detaching the first stream will also have affect of unsetting any upstream SRI from the SDDS to
+ * BulkIO class. With more than one attached stream a running component only lets go of the detached stream; its
+ * socket is closed, its processor pushes out what it has and closes its BulkIO stream, and its lane is reset for the
+ * next attach, while the other streams carry on undisturbed.
  *
  * @param attachId The unique attach ID which was returned during the matching attach call.
  * @throws DetachError If detach is called on a stream that is not currently attached / active.
  */
 void SourceSDDS_i::detach(const char* attachId) {
 
-	if (attachId != m_attach_stream.id) {
+	boost::unique_lock<boost::mutex> lock(m_attach_lock);
+	size_t index = findAttachedStream(attachId);
+	const bool found = (index < m_attach_streams.size());
+	if (found && streamsRunning()) {
+		// The reader lets go of the lane first so the processor can work what is left in it before closing its stream
+		struct attach_stream &detached = m_attach_streams[index];
+		m_socketReader.removeStream(detached.lane);
+		m_streamProcessors.remove(detached.lane);
+		delete detached.processor;
+		m_pktbuffer.reset_lane(detached.lane);
+		if (detached.sri_set) {
+			m_pending_sri[detached.id] = detached.sri;
+		}
+		RH_INFO(_baseLog, "Detached stream " << detached.id << " from lane " << detached.lane << " while running");
+		m_attach_streams.erase(m_attach_streams.begin() + index);
+		return;
+	}
+	lock.unlock();
+
+	if (not found) {
 		RH_ERROR(_baseLog, "ATTACHMENT ID (STREAM ID) NOT FOUND FOR: " << attachId);
 		throw BULKIO::dataSDDS::DetachError("Detach called on stream not currently running");
 	}
@@ -408,14 +903,62 @@ void SourceSDDS_i::detach(const char* attachId) {
 		stop();
 	}
 
-	m_sddsToBulkIO.unsetUpstreamSri();
-	m_attach_stream.attached = false;
+	// Another attach or detach may have moved the stream, or removed it, while the lock was released
+	lock.lock();
+	index = findAttachedStream(attachId);
+	if (index == m_attach_streams.size()) {
+		lock.unlock();
+		if (restart) {
+			start();
+		}
+		RH_ERROR(_baseLog, "ATTACHMENT ID (STREAM ID) NOT FOUND FOR: " << attachId);
+		throw BULKIO::dataSDDS::DetachError("Detach called on stream not currently running");
+	}
+
+	if (index == 0) {
+		m_sddsToBulkIO.unsetUpstreamSri();
+	}
+	// Kept for the stream should it be attached again, the SRI listener only hears from it when its SRI changes
+	if (m_attach_streams[index].sri_set && multipleStreams()) {
+		m_pending_sri[m_attach_streams[index].id] = m_attach_streams[index].sri;
+	}
+	m_attach_streams.erase(m_attach_streams.begin() + index);
+	lock.unlock();
 
 	if (restart) {
 		start();
 	}
 }
 
+/**
+ * Returns the index of the attached stream with the given attach ID, or the number of attached streams if there is
+ * none. The caller must hold m_attach_lock.
+ */
+size_t SourceSDDS_i::findAttachedStream(const std::string &attachId) {
+	size_t index = 0;
+	while (index < m_attach_streams.size() && m_attach_streams[index].id != attachId) {
+		++index;
+	}
+	return index;
+}
+
+/**
+ * Returns the lowest lane of the packet buffer no attached stream is using. The caller must hold m_attach_lock.
+ */
+size_t SourceSDDS_i::findFreeLane() {
+	size_t lane = 0;
+	for (bool used = true; used; ) {
+		used = false;
+		for (size_t i = 0; i < m_attach_streams.size() && not used; ++i) {
+			if (m_attach_streams[i].lane == lane) {
+				used = true;
+				++lane;
+			}
+		}
+	}
+	return lane;
+}
+
 /**
  * Sets the packets per read, push on ttv, wait on ttv, and data endianness options
  * of the SDDS to BulkIO processor based on the values set in the advanced optimization,
@@ -430,6 +973,41 @@ void SourceSDDS_i::setupSddsToBulkIOOptions() {
 	if (attachment_override.enabled) {
 		m_sddsToBulkIO.setEndianness(attachment_override.endianness);
 	}
+
+	// With more than one attached stream each stream gets its own processor on its own lane set up the same way,
+	// the stream ID defaults to the attach ID and any SRI received for the stream is handed to its processor.
+	boost::unique_lock<boost::mutex> lock(m_attach_lock);
+	if (not multipleStreams()) {
+		m_sddsToBulkIO.setLane(0);
+		m_sddsToBulkIO.setStreamId(DEFAULT_SDDS_STREAM_ID);
+		return;
+	}
+
+	m_streamProcessors.assign(m_pktbuffer.get_num_lanes());
+	for (size_t i = 0; i < m_attach_streams.size(); ++i) {
+		m_attach_streams[i].processor = newStreamProcessor(m_attach_streams[i]);
+		m_streamProcessors.add(m_attach_streams[i].lane, m_attach_streams[i].processor);
+	}
+}
+
+/**
+ * Creates the processor of an attached stream, set up the same way as m_sddsToBulkIO to work the stream's lane. Its
+ * stream ID defaults to the attach ID and any SRI received for the stream is handed to it. The caller owns it.
+ */
+SddsToBulkIOProcessor* SourceSDDS_i::newStreamProcessor(const struct attach_stream &stream) {
+	SddsToBulkIOProcessor *processor = new SddsToBulkIOProcessor(dataOctetOut, dataShortOut, dataFloatOut);
+	processor->setLogger(sdds2bio_log);
+	processor->setPktsPerRead(advanced_optimizations.sdds_pkts_per_bulkio_push);
+	processor->setPushOnTTV(advanced_configuration.push_on_ttv);
+	processor->setWaitForTTV(advanced_configuration.wait_on_ttv);
+	processor->setLatencyTracking(advanced_optimizations.receive_timestamps);
+	processor->setStatusInterval(advanced_optimizations.status_interval);
+	processor->setLane(stream.lane);
+	processor->setStreamId(stream.id);
+	if (stream.sri_set) {
+		processor->setUpstreamSri(stream.sri);
+	}
+	return processor;
 }
 
 /**
@@ -455,8 +1033,6 @@ void SourceSDDS_i::constructor()
 	dataSddsIn->setNewAttachDetachCallback(this);
 	dataSddsIn->setNewSriListener(this, &SourceSDDS_i::newSriListener);
 	dataSddsIn->setSriChangeListener(this, &SourceSDDS_i::newSriListener);
-
-	m_attach_stream.attached = false;
 }
 
 /**
@@ -471,8 +1047,12 @@ void SourceSDDS_i::destroyBuffersAndJoinThreads() {
 	// at the end.  It shouldn't hurt...right?
 	RH_DEBUG(_baseLog, "Shutting down the socket reader thread");
 	m_socketReader.shutDown();
+	for (size_t i = 0; i < m_extraSocketReaders.size(); ++i) {
+		m_extraSocketReaders[i]->shutDown();
+	}
 	RH_DEBUG(_baseLog, "Shutting down the sdds to bulkio thread");
 	m_sddsToBulkIO.shutDown();
+	m_streamProcessors.shutDown();
 
 	RH_DEBUG(_baseLog, "Destroying the existing packet buffers");
 	m_pktbuffer.shutDown();
@@ -485,6 +1065,20 @@ void SourceSDDS_i::destroyBuffersAndJoinThreads() {
 		m_socketReaderThread = NULL;
 	}
 
+	for (size_t i = 0; i < m_extraSocketReaderThreads.size(); ++i) {
+		m_extraSocketReaderThreads[i]->join();
+		delete m_extraSocketReaderThreads[i];
+	}
+	m_extraSocketReaderThreads.clear();
+
+	// The readers close their sockets when run returns, or when deleted if they never ran
+	boost::unique_lock<boost::mutex> readers_lock(m_readers_lock);
+	for (size_t i = 0; i < m_extraSocketReaders.size(); ++i) {
+		delete m_extraSocketReaders[i];
+	}
+	m_extraSocketReaders.clear();
+	readers_lock.unlock();
+
 	if (m_sddsToBulkIOThread) {
 		RH_DEBUG(_baseLog, "Joining the sdds to bulkio thread");
 		m_sddsToBulkIOThread->join();
@@ -492,6 +1086,14 @@ void SourceSDDS_i::destroyBuffersAndJoinThreads() {
 		m_sddsToBulkIOThread = NULL;
 	}
 
+	boost::unique_lock<boost::mutex> lock(m_attach_lock);
+	m_streamProcessors.assign(0);
+	for (size_t i = 0; i < m_attach_streams.size(); ++i) {
+		delete m_attach_streams[i].processor;
+		m_attach_streams[i].processor = NULL;
+	}
+	lock.unlock();
+
 	RH_DEBUG(_baseLog, "Everything should be shutdown and joined");
 }
 
@@ -26,8 +26,15 @@
 #include "SddsToBulkIOProcessor.h"
 #include "socketUtils/SourceNicUtils.h"
 #include <uuid/uuid.h>
+#include <map>
 #define NOT_SET 3
 
+namespace HUGE_PAGES {
+	const std::string NONE = "none";
+	const std::string TRANSPARENT = "transparent";
+	const std::string HUGETLB = "hugetlb";
+}
+
 class SourceSDDS_i : public SourceSDDS_base, public bulkio::InSDDSPort::Callback
 {
     public:
@@ -44,14 +51,37 @@ class SourceSDDS_i : public SourceSDDS_base, public bulkio::InSDDSPort::Callback
     private:
 		LOGGER sdds2bio_log;
 		LOGGER socket_log;
-        SmartPacketBuffer<SDDSpacket> m_pktbuffer;
+        SmartPacketBuffer<SDDSheader> m_pktbuffer;
 
         boost::thread *m_socketReaderThread;
         boost::thread *m_sddsToBulkIOThread;
 
         SocketReader m_socketReader;
         SddsToBulkIOProcessor m_sddsToBulkIO;
-        void setupSocketReaderOptions() throw (BadParameterError);
+
+        // Where and how _start placed the packet buffer, copied out for the status so it never touches the buffer's arena
+        int m_buffer_numa_node;
+        size_t m_buffer_page_size;
+        bool m_buffer_locked;
+
+        // With more than one socket reader m_socketReader fills the first lane of the packet buffer and these the rest.
+        // The readers are created and deleted by whichever CORBA thread starts, stops, attaches or detaches, the lock
+        // keeps the status getter from reading one that is being deleted.
+        boost::mutex m_readers_lock;
+        std::vector<SocketReader*> m_extraSocketReaders;
+        std::vector<boost::thread*> m_extraSocketReaderThreads;
+
+        // With more than one attached stream each stream's processor, see attach_stream, is worked from this set in place
+        // of m_sddsToBulkIO
+        SddsToBulkIOProcessorSet m_streamProcessors;
+
+        bool multipleStreams();
+        bool streamsRunning();
+        size_t findAttachedStream(const std::string &attachId);
+        size_t findFreeLane();
+        size_t getNumSocketReaders();
+        int getNumaNode();
+        void setupSocketReaderOptions(size_t num_readers) throw (BadParameterError);
         void setupSddsToBulkIOOptions();
         void destroyBuffersAndJoinThreads();
         struct advanced_configuration_struct get_advanced_configuration_struct();
@@ -65,10 +95,20 @@ class SourceSDDS_i : public SourceSDDS_base, public bulkio::InSDDSPort::Callback
             std::string multicastAddress;
             uint16_t vlan;
             uint16_t port;
-            bool attached;
+            BULKIO::StreamSRI sri;
+            bool sri_set;
+            // With more than one attached stream, the stream's lane of the packet buffer and, while running, its processor
+            size_t lane;
+            SddsToBulkIOProcessor *processor;
         };
+        SddsToBulkIOProcessor* newStreamProcessor(const struct attach_stream &stream);
+
+        // Guards the attached streams and their processors against the attach and SRI callbacks
+        boost::mutex m_attach_lock;
+        std::vector<struct attach_stream> m_attach_streams;
 
-        struct attach_stream m_attach_stream;
+        // SRI received for streams that are not attached, by stream ID, only used with more than one attached stream
+        std::map<std::string, BULKIO::StreamSRI> m_pending_sri;
 
 
 };
@@ -0,0 +1,194 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * SpscRing.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author:
+ */
+
+#ifndef SPSCRING_H_
+#define SPSCRING_H_
+
+#include <stddef.h>
+#include <sched.h>
+#include <unistd.h>
+
+#define SPSC_CACHE_LINE_SIZE 64
+
+/**
+ * A bounded, wait free, single producer single consumer ring.
+ *
+ * Exactly one thread may call the producer methods (push) and exactly one thread may call the consumer
+ * methods (pop) at any given time. Neither side ever takes a lock or waits on the other; if there is not
+ * enough room or not enough items the call simply returns false and the caller decides how to wait.
+ * The head and tail indices live on their own cache lines so the producer and consumer do not bounce
+ * a shared line back and forth, and each side keeps a cached copy of the other side's index so it only
+ * has to read the shared index when the cached value says it may be out of room / out of items.
+ *
+ * We are stuck with c++0x so the memory ordering is done with the GCC __sync builtins, a full barrier
+ * is issued once per batch and not once per item.
+ */
+template <class T>
+class SpscRing {
+public:
+	SpscRing(): m_buffer(NULL), m_capacity(0), m_mask(0), m_head(0), m_cached_tail(0), m_tail(0), m_cached_head(0) {}
+
+	~SpscRing() {
+		delete[] m_buffer;
+	}
+
+	/**
+	 * Allocates room for at least capacity items and empties the ring. The real capacity is rounded
+	 * up to the next power of two. Must not be called while a producer or consumer is using the ring.
+	 */
+	void reset(size_t capacity) {
+		size_t real_capacity = 1;
+		while (real_capacity < capacity) {
+			real_capacity <<= 1;
+		}
+
+		if (real_capacity != m_capacity) {
+			delete[] m_buffer;
+			m_buffer = new T[real_capacity];
+			m_capacity = real_capacity;
+			m_mask = real_capacity - 1;
+		} else {
+			// Let go of anything left over from the last use
+			for (size_t i = 0; i < m_capacity; ++i) {
+				m_buffer[i] = T();
+			}
+		}
+
+		m_head = m_cached_tail = 0;
+		m_tail = m_cached_head = 0;
+		__sync_synchronize();
+	}
+
+	/**
+	 * Producer side. Copies num items starting at first into the ring. Either all num items are pushed
+	 * and true is returned, or nothing is pushed and false is returned.
+	 */
+	template <typename Iterator>
+	bool push(Iterator first, size_t num) {
+		size_t tail = m_tail;
+		if (m_capacity - (tail - m_cached_head) < num) {
+			m_cached_head = load_acquire(m_head);
+			if (m_capacity - (tail - m_cached_head) < num) {
+				return false;
+			}
+		}
+
+		for (size_t i = 0; i < num; ++i, ++first) {
+			m_buffer[(tail + i) & m_mask] = *first;
+		}
+
+		store_release(m_tail, tail + num);
+		return true;
+	}
+
+	/**
+	 * Consumer side. Adds num items to the provided container, in ring order, either at the end of the
+	 * container or, if at_front is set, at the beginning of the container. Either all num items are
+	 * popped and true is returned, or nothing is popped and false is returned.
+	 */
+	template <typename Container>
+	bool pop(Container &que, size_t num, bool at_front = false) {
+		size_t head = m_head;
+		if (m_cached_tail - head < num) {
+			m_cached_tail = load_acquire(m_tail);
+			if (m_cached_tail - head < num) {
+				return false;
+			}
+		}
+
+		if (at_front) {
+			for (size_t i = num; i > 0; --i) {
+				que.push_front(m_buffer[(head + i - 1) & m_mask]);
+			}
+		} else {
+			for (size_t i = 0; i < num; ++i) {
+				que.push_back(m_buffer[(head + i) & m_mask]);
+			}
+		}
+
+		store_release(m_head, head + num);
+		return true;
+	}
+
+	/**
+	 * Returns the number of items currently in the ring. This is only a snapshot and may be
+	 * out of date by the time it is returned if either side is active.
+	 */
+	size_t size() const {
+		size_t tail = load_acquire(m_tail);
+		size_t head = load_acquire(m_head);
+		return tail - head;
+	}
+
+	/**
+	 * Used by either side while waiting on the other side. Spins briefly, then yields the CPU, and
+	 * finally sleeps so that a starved thread does not burn a core forever.
+	 */
+	static void backoff(unsigned int &attempt) {
+		if (attempt < 64) {
+#if defined(__i386__) || defined(__x86_64__)
+			__asm__ __volatile__("pause");
+#endif
+		} else if (attempt < 128) {
+			sched_yield();
+		} else {
+			usleep(50);
+		}
+		++attempt;
+	}
+
+private:
+	SpscRing(const SpscRing&);              // Disabled copy constructor
+	SpscRing& operator = (const SpscRing&); // Disabled assign operator
+
+	static size_t load_acquire(const volatile size_t &index) {
+		size_t value = index;
+		__sync_synchronize();
+		return value;
+	}
+
+	static void store_release(volatile size_t &index, size_t value) {
+		__sync_synchronize();
+		index = value;
+	}
+
+	T *m_buffer;
+	size_t m_capacity;
+	size_t m_mask;
+
+	// Consumer owned
+	char m_pad0[SPSC_CACHE_LINE_SIZE];
+	volatile size_t m_head;
+	size_t m_cached_tail;
+
+	// Producer owned
+	char m_pad1[SPSC_CACHE_LINE_SIZE - 2*sizeof(size_t)];
+	volatile size_t m_tail;
+	size_t m_cached_head;
+	char m_pad2[SPSC_CACHE_LINE_SIZE - 2*sizeof(size_t)];
+};
+
+#endif /* SPSCRING_H_ */
@@ -0,0 +1,122 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+/*
+ * SwapBufferPool.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author:
+ */
+
+#ifndef SWAPBUFFERPOOL_H_
+#define SWAPBUFFERPOOL_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <new>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+// Aligned so the byte swap kernels can write the buffers with non temporal stores
+#define SWAP_BUFFER_ALIGNMENT 64
+
+/**
+ * Buffers of one size that byte swapped payloads are written into and then handed to a BulkIO stream, which lets go
+ * of them, possibly on another thread, once it has pushed them. A buffer that is let go of goes back on the free list
+ * for the next push, so once the pool has as many buffers as are in flight at once nothing more is allocated. Only
+ * up to max_free buffers are kept, any more that come back are freed.
+ *
+ * The pool is held through a shared pointer by its owner and by the recycler of every buffer handed out, see
+ * SwapBufferRecycler, so a buffer a stream holds on to past the owner can still be returned.
+ */
+class SwapBufferPool {
+public:
+	SwapBufferPool(size_t buffer_size, size_t max_free): m_buffer_size(buffer_size), m_max_free(max_free) {
+		m_free.reserve(max_free);
+	}
+
+	~SwapBufferPool() {
+		for (size_t i = 0; i < m_free.size(); ++i) {
+			free(m_free[i]);
+		}
+	}
+
+	/**
+	 * Returns a free buffer, allocating one only if none has been let go of.
+	 */
+	uint8_t* acquire() {
+		boost::mutex::scoped_lock lock(m_lock);
+		if (not m_free.empty()) {
+			void *buffer = m_free.back();
+			m_free.pop_back();
+			return static_cast<uint8_t*>(buffer);
+		}
+		lock.unlock();
+
+		void *mem = NULL;
+		if (posix_memalign(&mem, SWAP_BUFFER_ALIGNMENT, m_buffer_size) != 0) {
+			throw std::bad_alloc();
+		}
+		return static_cast<uint8_t*>(mem);
+	}
+
+	/**
+	 * Puts a buffer from acquire back on the free list, or frees it if the list is full. Safe from any thread.
+	 */
+	void release(void *buffer) {
+		boost::mutex::scoped_lock lock(m_lock);
+		if (m_free.size() < m_max_free) {
+			m_free.push_back(buffer);
+			return;
+		}
+		lock.unlock();
+		free(buffer);
+	}
+
+	size_t getBufferSize() const {
+		return m_buffer_size;
+	}
+
+private:
+	SwapBufferPool(const SwapBufferPool&);
+	SwapBufferPool& operator=(const SwapBufferPool&);
+
+	boost::mutex m_lock;
+	std::vector<void*> m_free;
+	size_t m_buffer_size;
+	size_t m_max_free;
+};
+
+/**
+ * The deleter handed to a BulkIO stream along with a buffer from a SwapBufferPool, returns the buffer to the pool.
+ */
+class SwapBufferRecycler {
+public:
+	SwapBufferRecycler(const boost::shared_ptr<SwapBufferPool> &pool): m_pool(pool) {}
+
+	void operator()(void *buffer) const {
+		m_pool->release(buffer);
+	}
+
+private:
+	boost::shared_ptr<SwapBufferPool> m_pool;
+};
+
+#endif /* SWAPBUFFERPOOL_H_ */
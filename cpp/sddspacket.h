@@ -169,7 +169,10 @@ inline SDDSTime operator- (const SDDSTime& t1, const SDDSTime& t2) {
 
 // Assume we're little endian (x86, Tru64)
 const int SDDS_psize = 1080;
-class SDDSpacket {
+
+// The header portion of an SDDS packet. Kept separate from the data portion so that the
+// header and data can be received into two different places (see SDDSpacket below).
+class SDDSheader {
  public:
   //======================== SDDS header (raw network order)
   // Format Identifier
@@ -203,9 +206,6 @@ class SDDSpacket {
 
   uint16_t ssd[2];
   uint8_t aad[20];
-  //======================== SDDS data
-  uint8_t d[1024];
-//  uint16_t d[512];
 
   //======================== SDDS methods
   uint16_t get_seq(void) { return ntohs(seq); }
@@ -312,4 +312,12 @@ class SDDSpacket {
 
 };
 
+// A complete SDDS packet, the header immediately followed by the data, as it is on the wire.
+class SDDSpacket : public SDDSheader {
+ public:
+  //======================== SDDS data
+  uint8_t d[1024];
+//  uint16_t d[512];
+};
+
 #endif
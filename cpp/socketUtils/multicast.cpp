@@ -29,11 +29,14 @@
 #include <unistd.h>
 #include <stdio.h>
 #include <string>
+#include <vector>
 #include "multicast.h"
+#include "netlink_route.h"
+#include "reuseport.h"
 #include "SourceNicUtils.h"
 #include <ossie/debug.h>
 
-static multicast_t multicast_open_ (const char* iface, const char* group, int port, std::string& chosen_iface, LOGGER _log)
+static multicast_t multicast_open_ (const char* iface, const char* group, int port, std::string& chosen_iface, LOGGER _log, bool reuse_port)
 {
   unsigned int ii;
 
@@ -41,30 +44,34 @@ static multicast_t multicast_open_ (const char* iface, const char* group, int po
   VERIFY_ERR(multicast.sock >= 0, "create socket", _log);
   int one = 1;
   VERIFY_ERR(setsockopt(multicast.sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) == 0, "reuse address", _log);
+  if (reuse_port) {
+    VERIFY_ERR(setsockopt(multicast.sock, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) == 0, "reuse port", _log);
+  }
 
   /* Enumerate all the devices. */
-  struct ifconf devs = {0};
-  devs.ifc_len = 512*sizeof(struct ifreq);
-  devs.ifc_buf = (char*)malloc(devs.ifc_len);
-  VERIFY_ERR(devs.ifc_buf != 0, "memory allocation", _log);
-  VERIFY_ERR(ioctl(multicast.sock, SIOCGIFCONF, &devs) >= 0, "enum devices", _log);
-  for (ii = 0; ii < devs.ifc_len/sizeof(struct ifreq); ii++) {
+  std::vector<netlink_iface_t> devs;
+  try {
+	  netlink_interfaces(devs, _log);
+  } catch (...) {
+	  close(multicast.sock);
+	  throw;
+  }
+  for (ii = 0; ii < devs.size(); ii++) {
 	  bool any = (!*iface);
 	  bool any_interface_vlan_match = false;
 	  if(*iface && iface[0] == '.'){
-		  size_t len_dev = strlen(devs.ifc_req[ii].ifr_ifrn.ifrn_name);
+		  size_t len_dev = strlen(devs[ii].name);
 		  size_t len_iface = strlen(iface);
-		  if(len_dev >= len_iface && !strcmp(devs.ifc_req[ii].ifr_ifrn.ifrn_name + len_dev-len_iface,iface))
+		  if(len_dev >= len_iface && !strcmp(devs[ii].name + len_dev-len_iface,iface))
 			  any_interface_vlan_match = true;
 	  }
-	  bool interface_exact_match = (strcmp(iface, devs.ifc_req[ii].ifr_ifrn.ifrn_name) == 0);
+	  bool interface_exact_match = (strcmp(iface, devs[ii].name) == 0);
 	  if (any || any_interface_vlan_match || interface_exact_match) {
 		  try{
-			  struct ifreq dev = devs.ifc_req[ii];
-			  VERIFY_ERR(ioctl(multicast.sock, SIOCGIFFLAGS, &dev) >= 0, "get flags", _log);
-			  VERIFY(dev.ifr_flags & IFF_UP, "interface up", _log);
-			  VERIFY(!(dev.ifr_flags & IFF_LOOPBACK), "not loopback", _log);
-			  VERIFY(dev.ifr_flags & IFF_MULTICAST, "must be multicast", _log);
+			  const netlink_iface_t& dev = devs[ii];
+			  VERIFY(dev.flags & IFF_UP, "interface up", _log);
+			  VERIFY(!(dev.flags & IFF_LOOPBACK), "not loopback", _log);
+			  VERIFY(dev.flags & IFF_MULTICAST, "must be multicast", _log);
 			  if(any) {
 				  struct ip_mreq mreqn;
 				  memset(&mreqn, 0, sizeof(mreqn));
@@ -80,12 +87,11 @@ static multicast_t multicast_open_ (const char* iface, const char* group, int po
 				  }
 			  }
 			  else {
-				  VERIFY_ERR(ioctl(multicast.sock, SIOCGIFINDEX, &dev) == 0, "get index", _log);
 				  struct ip_mreqn mreqn;
 				  memset(&mreqn, 0, sizeof(mreqn));
 				  VERIFY_ERR(inet_aton(group, &mreqn.imr_multiaddr), "convert string to group", _log);
-				  mreqn.imr_address = ((struct sockaddr_in*)(&dev.ifr_addr))->sin_addr;
-				  mreqn.imr_ifindex = dev.ifr_ifindex;
+				  mreqn.imr_address = dev.addr;
+				  mreqn.imr_ifindex = dev.index;
 				  VERIFY_ERR(setsockopt(multicast.sock, IPPROTO_IP, IP_MULTICAST_IF, &mreqn, sizeof(struct ip_mreqn)) == 0, "set device", _log);
 				  multicast.addr.sin_family = AF_INET;
 				  multicast.addr.sin_addr.s_addr = mreqn.imr_multiaddr.s_addr;
@@ -96,13 +102,12 @@ static multicast_t multicast_open_ (const char* iface, const char* group, int po
 				  }
 			  }
 
-			  char* vlan = strchr(dev.ifr_ifrn.ifrn_name, '.');
+			  const char* vlan = strchr(dev.name, '.');
 			  if (vlan==NULL)
-			      chosen_iface = dev.ifr_ifrn.ifrn_name;
+			      chosen_iface = dev.name;
 			  else
-			      chosen_iface.assign(&dev.ifr_ifrn.ifrn_name[0], vlan-&dev.ifr_ifrn.ifrn_name[0]);
+			      chosen_iface.assign(&dev.name[0], vlan-&dev.name[0]);
 
-			  free(devs.ifc_buf);
 			  return multicast;
 		  }catch(...){};
 	  }
@@ -112,14 +117,13 @@ static multicast_t multicast_open_ (const char* iface, const char* group, int po
 
   /* If we get here, we've failed. */
   close(multicast.sock);
-  free(devs.ifc_buf);
   multicast.sock = -1;
 
   return multicast;
 }
 
 
-multicast_t multicast_client (const char* iface, const char* group, int port, std::string& chosen_iface, LOGGER _log) throw (BadParameterError)
+multicast_t multicast_client (const char* iface, const char* group, int port, std::string& chosen_iface, LOGGER _log, bool reuse_port) throw (BadParameterError)
 {
   if (!_log) {
     _log = rh_logger::Logger::getLogger("SourceSDDS_utils");
@@ -127,7 +131,7 @@ multicast_t multicast_client (const char* iface, const char* group, int port, st
   } else {
     RH_DEBUG(_log, "multicast_client method passed valid logger "<<_log->getName());
   }
-  multicast_t client = multicast_open_(iface, group, port, chosen_iface, _log);
+  multicast_t client = multicast_open_(iface, group, port, chosen_iface, _log, reuse_port);
   return client;
 }
 
@@ -146,7 +150,7 @@ multicast_t multicast_server (const char* iface, const char* group, int port, st
   } else {
     RH_DEBUG(_log, "multicast_server method passed valid logger "<<_log->getName());
   }
-  multicast_t server = multicast_open_(iface, group, port, chosen_iface, _log);
+  multicast_t server = multicast_open_(iface, group, port, chosen_iface, _log, false);
   if (server.sock != -1) {
     uint8_t ttl = 32;
     VERIFY_ERR(setsockopt(server.sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) == 0, "set ttl", _log);
@@ -0,0 +1,331 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <map>
+#include <boost/thread/mutex.hpp>
+#include "netlink_route.h"
+#include "SourceNicUtils.h"
+#include <ossie/debug.h>
+
+// Large enough for a page of dump replies, the kernel splits a dump into as many reads as it needs
+#define NETLINK_ROUTE_BUFFER_SIZE 32768
+
+// The cache, guarded by cache_lock_. monitor_ is subscribed to the link, IPv4 address and IPv4 route notifications.
+static boost::mutex cache_lock_;
+static int monitor_ = -1;
+static bool ifaces_valid_ = false;
+static std::vector<netlink_iface_t> ifaces_;
+static std::map<in_addr_t, std::string> routes_;
+static uint32_t seq_ = 0;
+
+// The links by index and the addresses found so far while dumping the interfaces
+typedef struct {
+  std::map<int, netlink_iface_t> links;
+  std::vector<netlink_iface_t>* ifaces;
+} dump_context_t;
+
+static int netlink_open_ (unsigned groups)
+{
+  int sock = socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+  if (sock < 0) {
+    return -1;
+  }
+
+  struct sockaddr_nl addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.nl_family = AF_NETLINK;
+  addr.nl_groups = groups;
+  if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+    close(sock);
+    return -1;
+  }
+  return sock;
+}
+
+static void invalidate_ ()
+{
+  ifaces_valid_ = false;
+  ifaces_.clear();
+  routes_.clear();
+}
+
+/**
+ * Throws the cache away if the kernel has told us of any change since we last looked. The notification socket is
+ * opened on first use, before anything is cached, so a change made while we dump cannot be missed. If the kernel
+ * dropped notifications because we had not read them we cannot know what changed so the cache goes as well, and
+ * nothing is cached at all while the notification socket cannot be opened.
+ */
+static void check_notifications_ (LOGGER _log)
+{
+  if (monitor_ < 0) {
+    invalidate_();
+    monitor_ = netlink_open_(RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV4_ROUTE);
+    if (monitor_ < 0) {
+      RH_DEBUG(_log, "Could not subscribe to rtnetlink notifications, errno: " << errno << " interfaces and routes will not be cached");
+      errno = 0;
+      return;
+    }
+    fcntl(monitor_, F_SETFL, O_NONBLOCK);
+    return;
+  }
+
+  char buffer[4096];
+  bool changed = false;
+  while (true) {
+    ssize_t len = recv(monitor_, buffer, sizeof(buffer), MSG_DONTWAIT);
+    if (len > 0 || (len < 0 && errno == ENOBUFS)) {
+      changed = true;
+    } else {
+      break;
+    }
+  }
+  errno = 0;
+
+  if (changed) {
+    RH_DEBUG(_log, "Interfaces or routes changed, dropping the cached ones");
+    invalidate_();
+  }
+}
+
+/**
+ * Reads the replies to the request with sequence number seq, handing each to handler, until the end of a dump or the
+ * only reply to any other request. Returns false with errno set if the read failed or the kernel refused the request.
+ */
+static bool netlink_receive_ (int sock, uint32_t seq, void (*handler)(const struct nlmsghdr*, void*), void* context)
+{
+  std::vector<char> buffer(NETLINK_ROUTE_BUFFER_SIZE);
+  while (true) {
+    int len = recv(sock, &buffer[0], buffer.size(), 0);
+    if (len < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+
+    for (struct nlmsghdr* nh = (struct nlmsghdr*)&buffer[0]; NLMSG_OK(nh, (unsigned) len); nh = NLMSG_NEXT(nh, len)) {
+      if (nh->nlmsg_seq != seq) {
+        continue;
+      }
+      if (nh->nlmsg_type == NLMSG_DONE) {
+        return true;
+      }
+      if (nh->nlmsg_type == NLMSG_ERROR) {
+        const struct nlmsgerr* err = (const struct nlmsgerr*)NLMSG_DATA(nh);
+        errno = -err->error;
+        return err->error == 0;
+      }
+
+      handler(nh, context);
+      if (!(nh->nlmsg_flags & NLM_F_MULTI)) {
+        return true;
+      }
+    }
+  }
+}
+
+/**
+ * Sends a request made up of the given header and body, plus an optional IPv4 address attribute, and reads the replies.
+ */
+static bool netlink_request_ (uint16_t type, uint16_t flags, const void* body, size_t body_len, unsigned short attr_type, const struct in_addr* attr,
+    void (*handler)(const struct nlmsghdr*, void*), void* context)
+{
+  int sock = netlink_open_(0);
+  if (sock < 0) {
+    return false;
+  }
+
+  char request[NLMSG_SPACE(sizeof(struct rtmsg)) + RTA_SPACE(sizeof(struct in_addr))];
+  memset(request, 0, sizeof(request));
+  struct nlmsghdr* nh = (struct nlmsghdr*)request;
+  nh->nlmsg_len = NLMSG_LENGTH(body_len);
+  nh->nlmsg_type = type;
+  nh->nlmsg_flags = NLM_F_REQUEST | flags;
+  nh->nlmsg_seq = ++seq_;
+  memcpy(NLMSG_DATA(nh), body, body_len);
+
+  if (attr) {
+    struct rtattr* rta = (struct rtattr*)(request + NLMSG_ALIGN(nh->nlmsg_len));
+    rta->rta_type = attr_type;
+    rta->rta_len = RTA_LENGTH(sizeof(struct in_addr));
+    memcpy(RTA_DATA(rta), attr, sizeof(struct in_addr));
+    nh->nlmsg_len = NLMSG_ALIGN(nh->nlmsg_len) + rta->rta_len;
+  }
+
+  struct sockaddr_nl kernel;
+  memset(&kernel, 0, sizeof(kernel));
+  kernel.nl_family = AF_NETLINK;
+
+  bool ok = sendto(sock, request, nh->nlmsg_len, 0, (struct sockaddr*)&kernel, sizeof(kernel)) == (ssize_t) nh->nlmsg_len &&
+      netlink_receive_(sock, nh->nlmsg_seq, handler, context);
+
+  int errsv = errno;
+  close(sock);
+  errno = errsv;
+  return ok;
+}
+
+static void link_handler_ (const struct nlmsghdr* nh, void* context)
+{
+  if (nh->nlmsg_type != RTM_NEWLINK) {
+    return;
+  }
+
+  const struct ifinfomsg* ifi = (const struct ifinfomsg*)NLMSG_DATA(nh);
+  netlink_iface_t link;
+  memset(&link, 0, sizeof(link));
+  link.index = ifi->ifi_index;
+  link.flags = ifi->ifi_flags;
+
+  int len = IFLA_PAYLOAD(nh);
+  for (const struct rtattr* rta = IFLA_RTA(ifi); RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+    if (rta->rta_type == IFLA_IFNAME) {
+      strncpy(link.name, (const char*)RTA_DATA(rta), IFNAMSIZ - 1);
+    }
+  }
+
+  ((dump_context_t*)context)->links[link.index] = link;
+}
+
+static void addr_handler_ (const struct nlmsghdr* nh, void* context)
+{
+  const struct ifaddrmsg* ifa = (const struct ifaddrmsg*)NLMSG_DATA(nh);
+  if (nh->nlmsg_type != RTM_NEWADDR || ifa->ifa_family != AF_INET) {
+    return;
+  }
+
+  dump_context_t* dump = (dump_context_t*)context;
+  netlink_iface_t iface = dump->links[ifa->ifa_index];
+  iface.index = ifa->ifa_index;
+
+  // IFA_LOCAL is our address, IFA_ADDRESS is the peer's on a point to point link and only ours without IFA_LOCAL
+  bool have_local = false;
+  int len = IFA_PAYLOAD(nh);
+  for (const struct rtattr* rta = IFA_RTA(ifa); RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+    if (rta->rta_type == IFA_LOCAL) {
+      memcpy(&iface.addr, RTA_DATA(rta), sizeof(iface.addr));
+      have_local = true;
+    } else if (rta->rta_type == IFA_ADDRESS && !have_local) {
+      memcpy(&iface.addr, RTA_DATA(rta), sizeof(iface.addr));
+    } else if (rta->rta_type == IFA_LABEL) {
+      memset(iface.name, 0, IFNAMSIZ);
+      strncpy(iface.name, (const char*)RTA_DATA(rta), IFNAMSIZ - 1);
+    }
+  }
+
+  dump->ifaces->push_back(iface);
+}
+
+static void route_handler_ (const struct nlmsghdr* nh, void* context)
+{
+  if (nh->nlmsg_type != RTM_NEWROUTE) {
+    return;
+  }
+
+  const struct rtmsg* rt = (const struct rtmsg*)NLMSG_DATA(nh);
+  int len = RTM_PAYLOAD(nh);
+  for (const struct rtattr* rta = RTM_RTA(rt); RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+    if (rta->rta_type == RTA_OIF) {
+      memcpy(context, RTA_DATA(rta), sizeof(int));
+    }
+  }
+}
+
+void netlink_interfaces (std::vector<netlink_iface_t>& ifaces, LOGGER _log) throw (BadParameterError)
+{
+  if (!_log) {
+    _log = rh_logger::Logger::getLogger("SourceSDDS_utils");
+    RH_DEBUG(_log, "netlink_interfaces method passed null logger; creating logger "<<_log->getName());
+  }
+
+  boost::mutex::scoped_lock lock(cache_lock_);
+  check_notifications_(_log);
+
+  if (!ifaces_valid_) {
+    dump_context_t dump;
+    dump.ifaces = &ifaces_;
+    ifaces_.clear();
+
+    struct ifinfomsg ifi;
+    memset(&ifi, 0, sizeof(ifi));
+    ifi.ifi_family = AF_UNSPEC;
+    VERIFY_ERR(netlink_request_(RTM_GETLINK, NLM_F_DUMP, &ifi, sizeof(ifi), 0, NULL, link_handler_, &dump), "dump links", _log);
+
+    struct ifaddrmsg ifa;
+    memset(&ifa, 0, sizeof(ifa));
+    ifa.ifa_family = AF_INET;
+    VERIFY_ERR(netlink_request_(RTM_GETADDR, NLM_F_DUMP, &ifa, sizeof(ifa), 0, NULL, addr_handler_, &dump), "dump addresses", _log);
+
+    ifaces_valid_ = (monitor_ >= 0);
+    RH_DEBUG(_log, "Found " << ifaces_.size() << " IPv4 interface addresses over rtnetlink");
+  }
+
+  ifaces = ifaces_;
+}
+
+std::string netlink_route_iface (const char* dest, LOGGER _log)
+{
+  if (!_log) {
+    _log = rh_logger::Logger::getLogger("SourceSDDS_utils");
+    RH_DEBUG(_log, "netlink_route_iface method passed null logger; creating logger "<<_log->getName());
+  }
+
+  struct in_addr addr;
+  if (!inet_aton(dest, &addr)) {
+    RH_WARN(_log, "Cannot look up the route of an invalid address: " << dest);
+    return "";
+  }
+
+  boost::mutex::scoped_lock lock(cache_lock_);
+  check_notifications_(_log);
+
+  std::map<in_addr_t, std::string>::const_iterator cached = routes_.find(addr.s_addr);
+  if (cached != routes_.end()) {
+    return cached->second;
+  }
+
+  struct rtmsg rt;
+  memset(&rt, 0, sizeof(rt));
+  rt.rtm_family = AF_INET;
+  rt.rtm_dst_len = 32;
+
+  int oif = 0;
+  char name[IF_NAMESIZE];
+  std::string iface;
+  if (!netlink_request_(RTM_GETROUTE, 0, &rt, sizeof(rt), RTA_DST, &addr, route_handler_, &oif)) {
+    RH_WARN(_log, "Could not find a route for " << dest << ", errno: " << errno);
+    errno = 0;
+  } else if (oif && if_indextoname(oif, name)) {
+    iface = name;
+  }
+
+  RH_DEBUG(_log, "Determined " << iface << " is used to route " << dest << " using rtnetlink");
+  if (monitor_ >= 0) {
+    routes_[addr.s_addr] = iface;
+  }
+  return iface;
+}
@@ -0,0 +1,65 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef NETLINK_ROUTE_H_
+#define NETLINK_ROUTE_H_
+
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <ossie/debug.h>
+#include "SourceNicUtils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * An IPv4 address of a network interface as reported by rtnetlink. There is one entry per address, in the order
+ * the kernel lists them, so this is the same list SIOCGIFCONF gives but without a limit on its length. The name is
+ * the address label, which is the interface name unless the address was given an alias such as eth0:1.
+ */
+typedef struct {
+  char name[IFNAMSIZ];
+  int index;
+  unsigned flags;
+  struct in_addr addr;
+} netlink_iface_t;
+
+/**
+ * Both lookups are answered from a process wide cache which is filled from rtnetlink dumps (RTM_GETLINK and
+ * RTM_GETADDR for the interfaces, RTM_GETROUTE for a route) and thrown away as soon as the kernel notifies us
+ * of any link, IPv4 address or IPv4 route change. Both are safe to call from any thread.
+ *
+ * netlink_interfaces fills ifaces with the IPv4 addresses of every interface, throws a BadParameterError if the
+ * kernel could not be asked.
+ *
+ * netlink_route_iface returns the name of the interface the kernel would send a packet to dest out of, which is
+ * the interface of the most specific matching route, or an empty string if there is no route.
+ */
+void netlink_interfaces (std::vector<netlink_iface_t>& ifaces, LOGGER _log=LOGGER()) throw (BadParameterError);
+std::string netlink_route_iface (const char* dest, LOGGER _log=LOGGER());
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NETLINK_ROUTE_H_ */
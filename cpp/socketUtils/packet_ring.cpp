@@ -0,0 +1,220 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/poll.h>
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/udp.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <net/ethernet.h>
+#include <linux/filter.h>
+#include <string.h>
+#include <unistd.h>
+#include "packet_ring.h"
+#include "SourceNicUtils.h"
+#include <ossie/debug.h>
+
+// Each frame in a block starts with the tpacket3_hdr, followed by the sockaddr_ll
+#define PACKET_RING_SLL(frame) ((const struct sockaddr_ll*)((const uint8_t*)(frame) + TPACKET_ALIGN(sizeof(struct tpacket3_hdr))))
+
+/**
+ * Opens the AF_PACKET socket, attaches the BPF filter, sets up and maps the TPACKET_V3 ring and finally binds
+ * to the interface. If iface is empty packets from all interfaces are captured. Throws a BadParameterError if
+ * any step fails, most commonly because the user does not have the CAP_NET_RAW capability.
+ */
+packet_ring_t packet_ring_open (const char* iface, const char* ip, int port, size_t block_size, size_t num_blocks, unsigned int block_timeout_ms, LOGGER _log) throw (BadParameterError)
+{
+  if (!_log) {
+    _log = rh_logger::Logger::getLogger("SourceSDDS_utils");
+    RH_DEBUG(_log, "packet_ring_open method passed null logger; creating logger "<<_log->getName());
+  }
+
+  packet_ring_t ring;
+  memset(&ring, 0, sizeof(ring));
+  ring.map = (uint8_t*) MAP_FAILED;
+
+  // Protocol zero so that nothing is captured before the filter is attached and the socket is bound.
+  // SOCK_DGRAM so the link layer header is already stripped and the filter and frames start at the IP header.
+  ring.sock = socket(AF_PACKET, SOCK_DGRAM, 0);
+  VERIFY_ERR(ring.sock >= 0, "create packet socket, CAP_NET_RAW is required", _log);
+
+  try {
+    VERIFY_ERR(inet_aton(ip, &ring.addr), "convert string to address", _log);
+    ring.port = port;
+
+    // Accept unfragmented UDP packets to addr:port, drop everything else
+    struct sock_filter code[] = {
+      BPF_STMT(BPF_LD  | BPF_B   | BPF_ABS, 9),                        // IP protocol
+      BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,   IPPROTO_UDP, 0, 8),
+      BPF_STMT(BPF_LD  | BPF_H   | BPF_ABS, 6),                        // IP flags and fragment offset
+      BPF_JUMP(BPF_JMP | BPF_JSET| BPF_K,   0x1fff, 6, 0),
+      BPF_STMT(BPF_LD  | BPF_W   | BPF_ABS, 16),                       // IP destination
+      BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,   ntohl(ring.addr.s_addr), 0, 4),
+      BPF_STMT(BPF_LDX | BPF_B   | BPF_MSH, 0),                        // X = IP header length
+      BPF_STMT(BPF_LD  | BPF_H   | BPF_IND, 2),                        // UDP destination port
+      BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,   (uint32_t) port, 0, 1),
+      BPF_STMT(BPF_RET | BPF_K,             0xffff),
+      BPF_STMT(BPF_RET | BPF_K,             0),
+    };
+    struct sock_fprog prog;
+    prog.len = sizeof(code) / sizeof(code[0]);
+    prog.filter = code;
+    VERIFY_ERR(setsockopt(ring.sock, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) == 0, "attach packet filter", _log);
+
+    int version = TPACKET_V3;
+    VERIFY_ERR(setsockopt(ring.sock, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) == 0, "set TPACKET_V3", _log);
+
+#ifdef PACKET_IGNORE_OUTGOING
+    // Only available on newer kernels, outgoing packets are also skipped when parsing the frames
+    int one = 1;
+    setsockopt(ring.sock, SOL_PACKET, PACKET_IGNORE_OUTGOING, &one, sizeof(one));
+#endif
+
+    struct tpacket_req3 req;
+    memset(&req, 0, sizeof(req));
+    req.tp_block_size = block_size;
+    req.tp_block_nr = num_blocks;
+    req.tp_frame_size = TPACKET_ALIGNMENT << 7;
+    req.tp_frame_nr = (block_size * num_blocks) / req.tp_frame_size;
+    req.tp_retire_blk_tov = block_timeout_ms;
+    VERIFY_ERR(setsockopt(ring.sock, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) == 0, "setup receive ring", _log);
+
+    ring.map = (uint8_t*) mmap(NULL, block_size * num_blocks, PROT_READ | PROT_WRITE, MAP_SHARED, ring.sock, 0);
+    VERIFY_ERR(ring.map != MAP_FAILED, "map receive ring", _log);
+    ring.block_size = block_size;
+    ring.num_blocks = num_blocks;
+
+    struct sockaddr_ll ll;
+    memset(&ll, 0, sizeof(ll));
+    ll.sll_family = AF_PACKET;
+    ll.sll_protocol = htons(ETH_P_IP);
+    ll.sll_ifindex = (*iface) ? if_nametoindex(iface) : 0;
+    VERIFY_ERR(!*iface || ll.sll_ifindex != 0, "find interface index", _log);
+    VERIFY_ERR(bind(ring.sock, (struct sockaddr*)&ll, sizeof(ll)) == 0, "packet socket bind", _log);
+  } catch (...) {
+    packet_ring_close(ring);
+    throw;
+  }
+
+  return ring;
+}
+
+/**
+ * Returns the next block if the kernel has handed it over to user space. If not, waits up to timeout ms for it,
+ * returning NULL if it still is not ready. The block must be given back with packet_ring_release_block.
+ */
+struct tpacket_block_desc* packet_ring_next_block (packet_ring_t* ring, int timeout)
+{
+  struct tpacket_block_desc* block = (struct tpacket_block_desc*)(ring->map + ring->current_block * ring->block_size);
+  volatile uint32_t* status = &block->hdr.bh1.block_status;
+
+  if (!(*status & TP_STATUS_USER)) {
+    struct pollfd pfd;
+    pfd.fd = ring->sock;
+    pfd.events = POLLIN | POLLERR;
+    pfd.revents = 0;
+    poll(&pfd, 1, timeout);
+
+    if (!(*status & TP_STATUS_USER)) {
+      return NULL;
+    }
+  }
+
+  // Don't let reads of the block contents move ahead of the status check
+  __sync_synchronize();
+  return block;
+}
+
+/**
+ * Hands the block back to the kernel and moves on to the next block in the ring.
+ */
+void packet_ring_release_block (packet_ring_t* ring, struct tpacket_block_desc* block)
+{
+  // All reads of the block must be done before the kernel may write to it again
+  __sync_synchronize();
+  block->hdr.bh1.block_status = TP_STATUS_KERNEL;
+  ring->current_block = (ring->current_block + 1) % ring->num_blocks;
+}
+
+/**
+ * Parses the IP and UDP headers of the frame in place, returning a pointer to the UDP payload and its length
+ * or NULL if the frame is not a complete UDP packet to the ring's address and port. The kernel filter should
+ * have already dropped anything else but it is cheap to double check and the filter does not look at lengths.
+ */
+const uint8_t* packet_ring_udp_payload (const packet_ring_t* ring, const struct tpacket3_hdr* frame, size_t* len, struct in_addr* source)
+{
+  if (PACKET_RING_SLL(frame)->sll_pkttype == PACKET_OUTGOING) {
+    return NULL;
+  }
+
+  const uint8_t* data = (const uint8_t*) frame + frame->tp_net;
+  size_t snaplen = frame->tp_snaplen;
+
+  if (snaplen < sizeof(struct iphdr)) {
+    return NULL;
+  }
+
+  const struct iphdr* ip = (const struct iphdr*) data;
+  size_t ip_len = ip->ihl * 4;
+
+  if (ip->protocol != IPPROTO_UDP || ip->daddr != ring->addr.s_addr || snaplen < ip_len + sizeof(struct udphdr)) {
+    return NULL;
+  }
+
+  const struct udphdr* udp = (const struct udphdr*)(data + ip_len);
+  size_t udp_len = ntohs(udp->len);
+
+  if (ntohs(udp->dest) != ring->port || udp_len < sizeof(struct udphdr) || snaplen < ip_len + udp_len) {
+    return NULL;
+  }
+
+  *len = udp_len - sizeof(struct udphdr);
+  if (source) {
+    source->s_addr = ip->saddr;
+  }
+  return (const uint8_t*) udp + sizeof(struct udphdr);
+}
+
+/**
+ * Returns the number of packets received and dropped by the ring since the last call.
+ */
+int packet_ring_stats (packet_ring_t ring, unsigned int* packets, unsigned int* drops)
+{
+  struct tpacket_stats_v3 stats;
+  socklen_t len = sizeof(stats);
+  memset(&stats, 0, sizeof(stats));
+  int retVal = getsockopt(ring.sock, SOL_PACKET, PACKET_STATISTICS, &stats, &len);
+  *packets = stats.tp_packets;
+  *drops = stats.tp_drops;
+  return retVal;
+}
+
+void packet_ring_close (packet_ring_t ring)
+{
+  if (ring.map != MAP_FAILED && ring.map != NULL) {
+    munmap(ring.map, ring.block_size * ring.num_blocks);
+  }
+  if (ring.sock >= 0) {
+    close(ring.sock);
+  }
+}
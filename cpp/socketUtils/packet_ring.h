@@ -0,0 +1,60 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef PACKET_RING_H_
+#define PACKET_RING_H_
+
+#include <arpa/inet.h>
+#include <stdint.h>
+#include <stdexcept>
+#include <linux/if_packet.h>
+#include <ossie/debug.h>
+#include "SourceNicUtils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * An AF_PACKET socket with a TPACKET_V3 receive ring mapped into user space. The socket carries a
+ * BPF filter so only UDP packets destined to addr:port are placed in the ring. The kernel fills one
+ * block at a time and hands it over once it is full or once the block timeout expires.
+ */
+typedef struct {
+  int sock;
+  uint8_t *map;
+  size_t block_size;
+  size_t num_blocks;
+  size_t current_block;
+  struct in_addr addr;
+  uint16_t port;
+} packet_ring_t;
+
+packet_ring_t packet_ring_open (const char* iface, const char* ip, int port, size_t block_size, size_t num_blocks, unsigned int block_timeout_ms, LOGGER _log=LOGGER()) throw (BadParameterError);
+struct tpacket_block_desc* packet_ring_next_block (packet_ring_t* ring, int timeout);
+void packet_ring_release_block (packet_ring_t* ring, struct tpacket_block_desc* block);
+const uint8_t* packet_ring_udp_payload (const packet_ring_t* ring, const struct tpacket3_hdr* frame, size_t* len, struct in_addr* source);
+int packet_ring_stats (packet_ring_t ring, unsigned int* packets, unsigned int* drops);
+void packet_ring_close (packet_ring_t ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PACKET_RING_H_ */
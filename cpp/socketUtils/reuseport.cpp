@@ -0,0 +1,123 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <stdint.h>
+#include <linux/filter.h>
+#include <vector>
+#include "reuseport.h"
+#include "SourceNicUtils.h"
+#include <ossie/debug.h>
+
+// Not defined by older kernel headers
+#ifndef BPF_MOD
+#define BPF_MOD 0x90
+#endif
+
+// A classic BPF program is limited to 4096 instructions, two per listed CPU plus up to five
+#define REUSEPORT_MAX_CPUS 2045
+
+/**
+ * Builds the program shared by the steering and filtering functions. If index is negative the program returns the
+ * socket the packet belongs to, otherwise it discards the packet if it belongs to another socket and if not either
+ * accepts it or, if then is given, runs that program on it.
+ */
+static std::vector<struct sock_filter> cpu_program_ (const int* cpus, unsigned num_cpus, unsigned num_sockets, int index, const struct sock_fprog* then, LOGGER _log)
+{
+  VERIFY(num_sockets > 0, "at least one socket to steer to", _log);
+  VERIFY(num_cpus <= REUSEPORT_MAX_CPUS, "CPU list fits in a BPF program", _log);
+
+  std::vector<struct sock_filter> code;
+  std::vector<size_t> mine_jumps;
+  struct sock_filter load_cpu = BPF_STMT(BPF_LD | BPF_W | BPF_ABS, (uint32_t) (SKF_AD_OFF + SKF_AD_CPU));
+  code.push_back(load_cpu);
+
+  // Each listed CPU jumps over the next entry on a miss and returns on a hit
+  for (unsigned ii = 0; ii < num_cpus; ii++) {
+    uint32_t socket = ii % num_sockets;
+    struct sock_filter match = BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, (uint32_t) cpus[ii], 0, 1);
+    struct sock_filter ret = BPF_STMT(BPF_RET | BPF_K, (index < 0) ? socket : 0);
+    struct sock_filter to_mine = BPF_STMT(BPF_JMP | BPF_JA, 0);
+    code.push_back(match);
+    if (index >= 0 && socket == (uint32_t) index) {
+      mine_jumps.push_back(code.size());
+      code.push_back(to_mine);
+    } else {
+      code.push_back(ret);
+    }
+  }
+
+  // Any CPU not listed is spread across the sockets
+  struct sock_filter spread = BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, num_sockets);
+  code.push_back(spread);
+  if (index < 0) {
+    struct sock_filter ret_a = BPF_STMT(BPF_RET | BPF_A, 0);
+    code.push_back(ret_a);
+    return code;
+  }
+
+  struct sock_filter others = BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, (uint32_t) index, 1, 0);
+  struct sock_filter discard = BPF_STMT(BPF_RET | BPF_K, 0);
+  code.push_back(others);
+  code.push_back(discard);
+
+  // The packets of this socket all end up here
+  for (size_t ii = 0; ii < mine_jumps.size(); ii++) {
+    code[mine_jumps[ii]].k = code.size() - (mine_jumps[ii] + 1);
+  }
+  if (then) {
+    code.insert(code.end(), then->filter, then->filter + then->len);
+  } else {
+    struct sock_filter accept = BPF_STMT(BPF_RET | BPF_K, 0xffff);
+    code.push_back(accept);
+  }
+  VERIFY(code.size() <= BPF_MAXINSNS, "CPU filter fits in a BPF program", _log);
+
+  return code;
+}
+
+void reuseport_steer_by_cpu (int sock, const int* cpus, unsigned num_cpus, unsigned num_sockets, LOGGER _log) throw (BadParameterError)
+{
+  if (!_log) {
+    _log = rh_logger::Logger::getLogger("SourceSDDS_utils");
+    RH_DEBUG(_log, "reuseport_steer_by_cpu method passed null logger; creating logger "<<_log->getName());
+  }
+
+  std::vector<struct sock_filter> code = cpu_program_(cpus, num_cpus, num_sockets, -1, NULL, _log);
+  struct sock_fprog prog;
+  prog.len = code.size();
+  prog.filter = &code[0];
+  VERIFY_ERR(setsockopt(sock, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) == 0, "attach reuseport CPU steering program", _log);
+}
+
+void reuseport_filter_by_cpu (int sock, const int* cpus, unsigned num_cpus, unsigned num_sockets, unsigned index, const struct sock_fprog* then, LOGGER _log) throw (BadParameterError)
+{
+  if (!_log) {
+    _log = rh_logger::Logger::getLogger("SourceSDDS_utils");
+    RH_DEBUG(_log, "reuseport_filter_by_cpu method passed null logger; creating logger "<<_log->getName());
+  }
+
+  VERIFY(index < num_sockets, "socket index within the group", _log);
+  std::vector<struct sock_filter> code = cpu_program_(cpus, num_cpus, num_sockets, index, then, _log);
+  struct sock_fprog prog;
+  prog.len = code.size();
+  prog.filter = &code[0];
+  VERIFY_ERR(setsockopt(sock, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) == 0, "attach CPU filter", _log);
+}
@@ -0,0 +1,66 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef REUSEPORT_H_
+#define REUSEPORT_H_
+
+#include <sys/socket.h>
+#include <linux/filter.h>
+#include <stdexcept>
+#include <ossie/debug.h>
+#include "SourceNicUtils.h"
+
+// Not defined by older C libraries, lets more than one socket bind the same address and port (linux 3.9)
+#ifndef SO_REUSEPORT
+#define SO_REUSEPORT 15
+#endif
+
+// Selects the socket of a reuseport group with a classic BPF program (linux 4.5)
+#ifndef SO_ATTACH_REUSEPORT_CBPF
+#define SO_ATTACH_REUSEPORT_CBPF 51
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Both functions split the packets arriving on a group of num_sockets sockets bound to the same address and
+ * port by the CPU that received them, so each socket can be read by a thread pinned to that CPU. A packet
+ * received on cpus[i] goes to socket i % num_sockets, a packet received on any other CPU goes to socket
+ * cpu % num_sockets. Both throw a BadParameterError if the kernel rejects the program.
+ *
+ * reuseport_steer_by_cpu attaches a SO_ATTACH_REUSEPORT_CBPF program which picks the socket of a SO_REUSEPORT
+ * group that a unicast packet is queued on; the socket index is the order the sockets were bound in. The program
+ * applies to the whole group so it only needs to be attached to one of its sockets.
+ *
+ * A multicast packet is queued on every socket joined to the group regardless of SO_REUSEPORT, so instead
+ * reuseport_filter_by_cpu attaches a socket filter to socket index of the group that discards the packets
+ * belonging to the other sockets. If then is given the packets belonging to the socket are passed on to that
+ * program, which must only jump forward, rather than accepted; this combines the CPU filter with another socket
+ * filter such as the one built by sdds_filter_program.
+ */
+void reuseport_steer_by_cpu (int sock, const int* cpus, unsigned num_cpus, unsigned num_sockets, LOGGER _log=LOGGER()) throw (BadParameterError);
+void reuseport_filter_by_cpu (int sock, const int* cpus, unsigned num_cpus, unsigned num_sockets, unsigned index, const struct sock_fprog* then=NULL, LOGGER _log=LOGGER()) throw (BadParameterError);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* REUSEPORT_H_ */
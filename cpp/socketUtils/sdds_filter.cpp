@@ -0,0 +1,134 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <stdint.h>
+#include <linux/filter.h>
+#include "sdds_filter.h"
+#include "SourceNicUtils.h"
+#include <ossie/debug.h>
+
+// The SDDS header starts right after the 8 byte UDP header, its second byte holds the complex flag in the top bit
+// and the bits per sample in the low five
+#define SDDS_FILTER_UDP_HEADER 8
+#define SDDS_FILTER_FORMAT_OFFSET 1
+#define SDDS_FILTER_BPS_MASK 0x1f
+#define SDDS_FILTER_CX_MASK 0x80
+
+// The source address sits 12 bytes into the IP header
+#define SDDS_FILTER_SOURCE_OFFSET 12
+
+/**
+ * Returns the mask and expected value of the SDDS format byte, a zero mask when neither field is screened.
+ */
+static uint8_t format_mask_ (const sdds_filter_t* filter, uint8_t* value)
+{
+  uint8_t mask = 0;
+  *value = 0;
+  if (filter->bps) {
+    mask |= SDDS_FILTER_BPS_MASK;
+    *value |= filter->bps & SDDS_FILTER_BPS_MASK;
+  }
+  if (filter->complex >= 0) {
+    mask |= SDDS_FILTER_CX_MASK;
+    *value |= (filter->complex) ? SDDS_FILTER_CX_MASK : 0;
+  }
+  return mask;
+}
+
+unsigned sdds_filter_program (const sdds_filter_t* filter, struct sock_filter* code)
+{
+  unsigned len = 0;
+  unsigned rejects[SDDS_FILTER_MAX_LEN];
+  unsigned num_rejects = 0;
+
+  if (filter->source.s_addr != INADDR_ANY) {
+    struct sock_filter load = BPF_STMT(BPF_LD | BPF_W | BPF_ABS, (uint32_t) (SKF_NET_OFF + SDDS_FILTER_SOURCE_OFFSET));
+    struct sock_filter match = BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ntohl(filter->source.s_addr), 0, 0);
+    code[len++] = load;
+    rejects[num_rejects++] = len;
+    code[len++] = match;
+  }
+
+  if (filter->length) {
+    struct sock_filter load = BPF_STMT(BPF_LD | BPF_W | BPF_LEN, 0);
+    struct sock_filter match = BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, SDDS_FILTER_UDP_HEADER + filter->length, 0, 0);
+    code[len++] = load;
+    rejects[num_rejects++] = len;
+    code[len++] = match;
+  }
+
+  uint8_t value;
+  uint8_t mask = format_mask_(filter, &value);
+  if (mask) {
+    struct sock_filter load = BPF_STMT(BPF_LD | BPF_B | BPF_ABS, SDDS_FILTER_UDP_HEADER + SDDS_FILTER_FORMAT_OFFSET);
+    struct sock_filter and_mask = BPF_STMT(BPF_ALU | BPF_AND | BPF_K, mask);
+    struct sock_filter match = BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, value, 0, 0);
+    code[len++] = load;
+    code[len++] = and_mask;
+    rejects[num_rejects++] = len;
+    code[len++] = match;
+  }
+
+  struct sock_filter accept = BPF_STMT(BPF_RET | BPF_K, 0xffff);
+  struct sock_filter reject = BPF_STMT(BPF_RET | BPF_K, SDDS_FILTER_REJECT_LEN);
+  code[len++] = accept;
+  code[len++] = reject;
+
+  // Every failed match jumps to the final reject
+  for (unsigned ii = 0; ii < num_rejects; ii++) {
+    code[rejects[ii]].jf = len - 1 - (rejects[ii] + 1);
+  }
+
+  return len;
+}
+
+void sdds_filter_attach (int sock, const sdds_filter_t* filter, LOGGER _log) throw (BadParameterError)
+{
+  if (!_log) {
+    _log = rh_logger::Logger::getLogger("SourceSDDS_utils");
+    RH_DEBUG(_log, "sdds_filter_attach method passed null logger; creating logger "<<_log->getName());
+  }
+
+  struct sock_filter code[SDDS_FILTER_MAX_LEN];
+  struct sock_fprog prog;
+  prog.len = sdds_filter_program(filter, code);
+  prog.filter = code;
+  VERIFY_ERR(setsockopt(sock, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) == 0, "attach SDDS packet filter", _log);
+}
+
+int sdds_filter_match (const sdds_filter_t* filter, const uint8_t* sdds, size_t len, struct in_addr source)
+{
+  if (filter->source.s_addr != INADDR_ANY && filter->source.s_addr != source.s_addr) {
+    return 0;
+  }
+
+  if (filter->length && filter->length != len) {
+    return 0;
+  }
+
+  uint8_t value;
+  uint8_t mask = format_mask_(filter, &value);
+  if (mask && (len <= SDDS_FILTER_FORMAT_OFFSET || (sdds[SDDS_FILTER_FORMAT_OFFSET] & mask) != value)) {
+    return 0;
+  }
+
+  return 1;
+}
@@ -0,0 +1,77 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef SDDS_FILTER_H_
+#define SDDS_FILTER_H_
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <linux/filter.h>
+#include <stdint.h>
+#include <stdexcept>
+#include <ossie/debug.h>
+#include "SourceNicUtils.h"
+
+// The longest program sdds_filter_program builds
+#define SDDS_FILTER_MAX_LEN 16
+
+// A rejected packet is cut down to its UDP header rather than dropped so it still reaches the socket as an empty
+// datagram, that lets the reader count exactly what the filter turned away.
+#define SDDS_FILTER_REJECT_LEN 8
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * What the packets on an SDDS socket are screened for. A zero source, length or bps and a negative complex
+ * accept anything in that field. bps is the value of the header field itself so 32 bit samples are 31.
+ */
+typedef struct {
+  struct in_addr source;
+  unsigned length;
+  unsigned bps;
+  int complex;
+} sdds_filter_t;
+
+/**
+ * Builds a classic BPF socket filter for a UDP socket into code, which must hold SDDS_FILTER_MAX_LEN instructions,
+ * and returns its length. Packets from another sender, of another UDP payload length or whose SDDS header has other
+ * bps or complex bits are truncated to SDDS_FILTER_REJECT_LEN and everything else is accepted whole. The program
+ * only jumps forward so it can be appended to another, see reuseport_filter_by_cpu.
+ */
+unsigned sdds_filter_program (const sdds_filter_t* filter, struct sock_filter* code);
+
+/**
+ * Attaches the program built by sdds_filter_program to the socket, replacing any socket filter already attached.
+ * Throws a BadParameterError if the kernel rejects it.
+ */
+void sdds_filter_attach (int sock, const sdds_filter_t* filter, LOGGER _log=LOGGER()) throw (BadParameterError);
+
+/**
+ * The same screening done on a received SDDS packet in user space, for readers that bypass the socket. Returns
+ * non-zero if the packet of len bytes from source would have been accepted.
+ */
+int sdds_filter_match (const sdds_filter_t* filter, const uint8_t* sdds, size_t len, struct in_addr source);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SDDS_FILTER_H_ */
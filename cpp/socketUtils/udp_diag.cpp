@@ -0,0 +1,169 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/sock_diag.h>
+#include <linux/inet_diag.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <vector>
+#include "udp_diag.h"
+#include <ossie/debug.h>
+
+#ifndef SOCK_DIAG_BY_FAMILY
+#define SOCK_DIAG_BY_FAMILY 20
+#endif
+
+// Index of the drop count in INET_DIAG_SKMEMINFO, older headers stop before it
+#define UDP_DIAG_SK_MEMINFO_DROPS 8
+
+// Only a handful of sockets can match so one read normally holds the whole reply
+#define UDP_DIAG_BUFFER_SIZE 8192
+
+// The request: the dump of UDP sockets, followed by a filter of a single condition on the local address and port
+typedef struct {
+  struct nlmsghdr nh;
+  struct inet_diag_req_v2 req;
+  struct rtattr bytecode;
+  char bc[sizeof(struct inet_diag_bc_op) + sizeof(struct inet_diag_hostcond) + sizeof(struct in_addr)];
+} udp_diag_request_t;
+
+bool udp_diag_query (const char* ip, uint16_t port, uint64_t inode, udp_diag_t& diag, LOGGER _log)
+{
+  if (!_log) {
+    _log = rh_logger::Logger::getLogger("SourceSDDS_utils");
+    RH_DEBUG(_log, "udp_diag_query method passed null logger; creating logger "<<_log->getName());
+  }
+
+  memset(&diag, 0, sizeof(diag));
+
+  struct in_addr addr;
+  if (!inet_aton(ip, &addr)) {
+    RH_DEBUG(_log, "udp_diag_query: Invalid address " << ip);
+    return false;
+  }
+
+  int sock = socket(AF_NETLINK, SOCK_RAW, NETLINK_SOCK_DIAG);
+  if (sock < 0) {
+    RH_DEBUG(_log, "udp_diag_query: Failed to open a sock_diag socket, errno: " << errno);
+    return false;
+  }
+
+  udp_diag_request_t request;
+  memset(&request, 0, sizeof(request));
+  request.nh.nlmsg_len = sizeof(request);
+  request.nh.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+  request.nh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  request.nh.nlmsg_seq = 1;
+  request.req.sdiag_family = AF_INET;
+  request.req.sdiag_protocol = IPPROTO_UDP;
+  request.req.idiag_states = ~0U;
+  request.req.idiag_ext = 1 << (INET_DIAG_SKMEMINFO - 1);
+
+  // Accept, by stepping exactly to the end, if the local address and port match. Otherwise step past the end to reject
+  struct inet_diag_bc_op* op = (struct inet_diag_bc_op*)request.bc;
+  struct inet_diag_hostcond* cond = (struct inet_diag_hostcond*)(op + 1);
+  request.bytecode.rta_type = INET_DIAG_REQ_BYTECODE;
+  request.bytecode.rta_len = RTA_LENGTH(sizeof(request.bc));
+  op->code = INET_DIAG_BC_S_COND;
+  op->yes = sizeof(request.bc);
+  op->no = sizeof(request.bc) + 4;
+  cond->family = AF_INET;
+  cond->prefix_len = 32;
+  cond->port = port;
+  memcpy(cond + 1, &addr, sizeof(addr));
+
+  struct sockaddr_nl kernel;
+  memset(&kernel, 0, sizeof(kernel));
+  kernel.nl_family = AF_NETLINK;
+  if (sendto(sock, &request, sizeof(request), 0, (struct sockaddr*)&kernel, sizeof(kernel)) != (ssize_t) sizeof(request)) {
+    RH_DEBUG(_log, "udp_diag_query: Failed to send the sock_diag request, errno: " << errno);
+    close(sock);
+    return false;
+  }
+
+  std::vector<char> buffer(UDP_DIAG_BUFFER_SIZE);
+  bool done = false, ok = true, found_inode = false;
+  while (!done) {
+    int len = recv(sock, &buffer[0], buffer.size(), 0);
+    if (len < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      RH_DEBUG(_log, "udp_diag_query: Failed to read the sock_diag reply, errno: " << errno);
+      ok = false;
+      break;
+    }
+
+    for (struct nlmsghdr* nh = (struct nlmsghdr*)&buffer[0]; NLMSG_OK(nh, (unsigned) len); nh = NLMSG_NEXT(nh, len)) {
+      if (nh->nlmsg_type == NLMSG_DONE) {
+        done = true;
+        break;
+      }
+      if (nh->nlmsg_type == NLMSG_ERROR) {
+        const struct nlmsgerr* err = (const struct nlmsgerr*)NLMSG_DATA(nh);
+        RH_DEBUG(_log, "udp_diag_query: The kernel refused the sock_diag request, errno: " << -err->error << " is udp_diag loaded?");
+        done = true;
+        ok = false;
+        break;
+      }
+      if (nh->nlmsg_type != SOCK_DIAG_BY_FAMILY) {
+        continue;
+      }
+
+      const struct inet_diag_msg* msg = (const struct inet_diag_msg*)NLMSG_DATA(nh);
+      diag.listeners++;
+
+      uint64_t drops = 0;
+      int attr_len = nh->nlmsg_len - NLMSG_LENGTH(sizeof(*msg));
+      for (const struct rtattr* rta = (const struct rtattr*)(msg + 1); RTA_OK(rta, attr_len); rta = RTA_NEXT(rta, attr_len)) {
+        if (rta->rta_type == INET_DIAG_SKMEMINFO && RTA_PAYLOAD(rta) > UDP_DIAG_SK_MEMINFO_DROPS * sizeof(uint32_t)) {
+          drops = ((const uint32_t*)RTA_DATA(rta))[UDP_DIAG_SK_MEMINFO_DROPS];
+        }
+      }
+
+      // idiag_rqueue is the receive buffer allocation, the same value /proc/net/udp shows as rx_queue
+      if (inode && msg->idiag_inode == inode) {
+        diag.rx_queue = msg->idiag_rqueue;
+        diag.drops = drops;
+        found_inode = true;
+      } else if (!found_inode && msg->idiag_rqueue >= diag.rx_queue) {
+        diag.rx_queue = msg->idiag_rqueue;
+        diag.drops = drops;
+      }
+    }
+  }
+  close(sock);
+
+  if (!ok) {
+    memset(&diag, 0, sizeof(diag));
+    return false;
+  }
+  if (diag.listeners == 0) {
+    RH_DEBUG(_log, "udp_diag_query: No UDP socket is bound to " << ip << ":" << port << ", is the socket bound?");
+    return false;
+  }
+  return true;
+}
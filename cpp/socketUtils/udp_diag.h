@@ -0,0 +1,49 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef UDP_DIAG_H_
+#define UDP_DIAG_H_
+
+#include <stdint.h>
+#include <ossie/debug.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  uint64_t rx_queue;  // Bytes waiting in the socket's receive buffer
+  uint64_t drops;     // Packets the kernel dropped on the socket, mostly because the receive buffer was full
+  int listeners;      // Number of UDP sockets bound to the address and port, in any process
+} udp_diag_t;
+
+/**
+ * Asks the kernel over NETLINK_SOCK_DIAG for the UDP sockets bound to ip:port. A socket filter is sent with the
+ * request so the kernel only reports those sockets, which keeps the cost of the query independent of how many
+ * sockets the host has. If one of them has the given inode its queue and drops are returned, otherwise those of the
+ * socket with the fullest queue are. Returns false, leaving diag zeroed, if the kernel could not be asked or no
+ * socket is bound to ip:port.
+ */
+bool udp_diag_query (const char* ip, uint16_t port, uint64_t inode, udp_diag_t& diag, LOGGER _log=LOGGER());
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UDP_DIAG_H_ */
@@ -29,8 +29,11 @@
 #include <unistd.h>
 #include <stdio.h>
 #include <string>
+#include <vector>
 #include <iostream>
 #include "unicast.h"
+#include "netlink_route.h"
+#include "reuseport.h"
 #include <ossie/debug.h>
 #include <errno.h>
 
@@ -82,7 +85,7 @@ static inline void verify_debug_ (int condition, const char* message, const char
 }
 #define verify_debug(CONDITION, MESSAGE, LOGG) verify_debug_(CONDITION, MESSAGE, #CONDITION, __FILE__, __LINE__, LOGG)
 
-static unicast_t unicast_open_ (const char* iface, const char* ip, int port, std::string& chosen_iface, LOGGER _log)
+static unicast_t unicast_open_ (const char* iface, const char* ip, int port, std::string& chosen_iface, LOGGER _log, bool reuse_port)
 {
   unsigned int ii;
 
@@ -90,38 +93,41 @@ static unicast_t unicast_open_ (const char* iface, const char* ip, int port, std
   verify(unicast.sock >= 0, "unicast_open_: create socket", _log);
   int one = 1;
   verify(setsockopt(unicast.sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) == 0, "unicast_open_: reuse address", _log);
+  if (reuse_port) {
+    verify(setsockopt(unicast.sock, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) == 0, "unicast_open_: reuse port", _log);
+  }
 
   /* Enumerate all the devices. */
-  struct ifconf devs = {0};
-  devs.ifc_len = 512*sizeof(struct ifreq);
-  devs.ifc_buf = (char*)malloc(devs.ifc_len);
-  verify(devs.ifc_buf != 0, "unicast_open_: memory allocation", _log);
-  verify(ioctl(unicast.sock, SIOCGIFCONF, &devs) >= 0, "unicast_open_: enum devices", _log);
+  std::vector<netlink_iface_t> devs;
+  try {
+	  netlink_interfaces(devs, _log);
+  } catch (...) {
+	  close(unicast.sock);
+	  throw;
+  }
 
   bool any = (!*iface);
   bool any_ip = (inet_addr(ip) == 0);
-  for (ii = 0; ii<devs.ifc_len/sizeof(struct ifreq); ii++) {
+  for (ii = 0; ii<devs.size(); ii++) {
 	  bool any_interface_vlan_match = false;
 	  if(*iface && iface[0] == '.'){
-		  size_t len_dev = strlen(devs.ifc_req[ii].ifr_ifrn.ifrn_name);
+		  size_t len_dev = strlen(devs[ii].name);
 		  size_t len_iface = strlen(iface);
-		  if(len_dev >= len_iface && !strcmp(devs.ifc_req[ii].ifr_ifrn.ifrn_name + len_dev-len_iface,iface))
+		  if(len_dev >= len_iface && !strcmp(devs[ii].name + len_dev-len_iface,iface))
 			  any_interface_vlan_match = true;
 	  }
-	  bool ip_interface_match = any_ip || (inet_addr(ip) == ((struct sockaddr_in*)(&devs.ifc_req[ii].ifr_addr))->sin_addr.s_addr);
-	  bool interface_exact_match = (strcmp(iface, devs.ifc_req[ii].ifr_ifrn.ifrn_name) == 0);
-	  RH_DEBUG(_log, "unicast_open_: "<<ii<<": "<<devs.ifc_req[ii].ifr_ifrn.ifrn_name<<"  "<<ip<<":"<<port<<"  any="<<any<<" any+vlan="<<any_interface_vlan_match<<" ip="<<ip_interface_match<<" exact="<<interface_exact_match);
+	  bool ip_interface_match = any_ip || (inet_addr(ip) == devs[ii].addr.s_addr);
+	  bool interface_exact_match = (strcmp(iface, devs[ii].name) == 0);
+	  RH_DEBUG(_log, "unicast_open_: "<<ii<<": "<<devs[ii].name<<"  "<<ip<<":"<<port<<"  any="<<any<<" any+vlan="<<any_interface_vlan_match<<" ip="<<ip_interface_match<<" exact="<<interface_exact_match);
 
 	  // If device meets IP address/interface/vlan requirements, try to bind
 	  if (ip_interface_match && (any || any_interface_vlan_match || interface_exact_match)) {
 		  try{
 			  // We found an interface that meets IP/VLAN/interface specified
 			  // Now make sure it meets all other requirements
-			  struct ifreq dev = devs.ifc_req[ii];
-			  verify_info(ioctl(unicast.sock, SIOCGIFFLAGS, &dev) >= 0, "unicast_open_: get flags", _log);
-			  verify_info(dev.ifr_flags & IFF_UP, "unicast_open_: interface up", _log);
-			  //verify_info(!(dev.ifr_flags & IFF_LOOPBACK), "unicast_open_: not loopback", _log);
-			  verify_info(ioctl(unicast.sock, SIOCGIFINDEX, &dev) == 0, "unicast_open_: get index", _log);
+			  const netlink_iface_t& dev = devs[ii];
+			  verify_info(dev.flags & IFF_UP, "unicast_open_: interface up", _log);
+			  //verify_info(!(dev.flags & IFF_LOOPBACK), "unicast_open_: not loopback", _log);
 
 			  // Now we bind...
 			  unicast.addr.sin_family = AF_INET;
@@ -130,15 +136,14 @@ static unicast_t unicast_open_ (const char* iface, const char* ip, int port, std
 			  verify_info(bind(unicast.sock, (struct sockaddr*)&unicast.addr, sizeof(struct sockaddr)) == 0, "unicast_open_: bind", _log);
 
 			  // Success! report back interface name
-			  char* vlan = strchr(dev.ifr_ifrn.ifrn_name, '.');
+			  const char* vlan = strchr(dev.name, '.');
 			  if (any && any_ip)
 				  chosen_iface = "ALL";
 			  else if (vlan==NULL)
-			      chosen_iface = dev.ifr_ifrn.ifrn_name;
+			      chosen_iface = dev.name;
 			  else
-			      chosen_iface.assign(&dev.ifr_ifrn.ifrn_name[0], vlan-&dev.ifr_ifrn.ifrn_name[0]);
+			      chosen_iface.assign(&dev.name[0], vlan-&dev.name[0]);
 
-			  free(devs.ifc_buf);
 			  return unicast;
 		  }catch(...){};
 	  }
@@ -147,14 +152,13 @@ static unicast_t unicast_open_ (const char* iface, const char* ip, int port, std
 
   /* If we get here, we've failed. */
   close(unicast.sock);
-  free(devs.ifc_buf);
   unicast.sock = -1;
 
   return unicast;
 }
 
 
-unicast_t unicast_client (const char* iface, const char* group, int port, std::string& chosen_iface, LOGGER _log) throw (BadParameterError)
+unicast_t unicast_client (const char* iface, const char* group, int port, std::string& chosen_iface, LOGGER _log, bool reuse_port) throw (BadParameterError)
 {
   if (!_log) {
     _log = rh_logger::Logger::getLogger("SourceSDDS_utils");
@@ -162,7 +166,7 @@ unicast_t unicast_client (const char* iface, const char* group, int port, std::s
   } else {
     RH_DEBUG(_log, "unicast_client method passed valid logger "<<_log->getName());
   }
-  unicast_t client = unicast_open_(iface, group, port, chosen_iface, _log);
+  unicast_t client = unicast_open_(iface, group, port, chosen_iface, _log, reuse_port);
   return client;
 }
 
@@ -185,7 +189,7 @@ unicast_t unicast_server (const char* iface, const char* group, int port, std::s
   } else {
     RH_DEBUG(_log, "unicast_server method passed valid logger "<<_log->getName());
   }
-  unicast_t server = unicast_open_(iface, group, port, chosen_iface, _log);
+  unicast_t server = unicast_open_(iface, group, port, chosen_iface, _log, false);
   if (server.sock != -1) {
     uint8_t ttl = 32;
     verify(setsockopt(server.sock, IPPROTO_IP, IP_TTL, &ttl, sizeof(ttl)) == 0, "set ttl", _log);
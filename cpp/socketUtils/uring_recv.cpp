@@ -0,0 +1,404 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <netinet/in.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "uring_recv.h"
+#include "SourceNicUtils.h"
+#include <ossie/debug.h>
+
+#ifdef HAVE_LINUX_IO_URING_H
+#include <linux/io_uring.h>
+#endif
+
+// Multishot recvmsg and the provided buffer rings it relies on arrived together with IORING_RECV_MULTISHOT.
+// There is no liburing dependency, the three system calls are made directly.
+#if defined(IORING_RECV_MULTISHOT) && defined(__NR_io_uring_setup)
+#define URING_RECV_SUPPORTED 1
+#endif
+
+#ifdef URING_RECV_SUPPORTED
+
+// The recvmsg is the only request ever submitted so the submission queue can be tiny
+#define URING_RECV_SQ_ENTRIES 4
+#define URING_RECV_BGID 0
+#define URING_RECV_USER_DATA 1
+#define URING_CANCEL_USER_DATA 2
+
+static int uring_setup (unsigned entries, struct io_uring_params* p)
+{
+  return (int) syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int uring_enter (int fd, unsigned to_submit, unsigned min_complete, unsigned flags, void* arg, size_t argsz)
+{
+  return (int) syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz);
+}
+
+static int uring_register (int fd, unsigned opcode, void* arg, unsigned nr_args)
+{
+  return (int) syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+/**
+ * Fills in the next submission queue entry with the prepared sqe and submits it.
+ */
+static int uring_submit (uring_recv_t* ring, const struct io_uring_sqe* prepared)
+{
+  unsigned tail = *ring->sq_tail;
+  unsigned index = tail & *ring->sq_mask;
+
+  ring->sqes[index] = *prepared;
+  ring->sq_array[index] = index;
+  __sync_synchronize();
+  *(volatile unsigned*) ring->sq_tail = tail + 1;
+
+  return (uring_enter(ring->fd, 1, 0, 0, NULL, 0) == 1) ? 0 : -1;
+}
+
+/**
+ * Creates the io_uring, maps its rings, registers a provided buffer ring with room for buf_entries buffers
+ * (rounded up to a power of two) and checks that the kernel supports multishot recvmsg. Throws a BadParameterError
+ * if any step fails, most commonly because the kernel is too old or io_uring has been disabled by the administrator.
+ * The recvmsg is normally left unarmed, provide the buffers and then call uring_recv_arm if ring.armed is not set.
+ */
+uring_recv_t uring_recv_open (int sock, unsigned buf_entries, LOGGER _log) throw (BadParameterError)
+{
+  if (!_log) {
+    _log = rh_logger::Logger::getLogger("SourceSDDS_utils");
+    RH_DEBUG(_log, "uring_recv_open method passed null logger; creating logger "<<_log->getName());
+  }
+
+  uring_recv_t ring;
+  memset(&ring, 0, sizeof(ring));
+  ring.sock = sock;
+  ring.sq_map = ring.cq_map = MAP_FAILED;
+  ring.sqes = (struct io_uring_sqe*) MAP_FAILED;
+
+  ring.buf_entries = 1;
+  while (ring.buf_entries < buf_entries && ring.buf_entries < URING_RECV_MAX_BUFFERS) {
+    ring.buf_entries <<= 1;
+  }
+
+  struct io_uring_params p;
+  memset(&p, 0, sizeof(p));
+
+  // Room for a completion per provided buffer plus the odd error so the multishot request is not ended by a full queue
+  p.flags = IORING_SETUP_CQSIZE;
+  p.cq_entries = ring.buf_entries * 2;
+
+#if defined(IORING_SETUP_SINGLE_ISSUER) && defined(IORING_SETUP_DEFER_TASKRUN)
+  // Only the socket reader thread touches the ring, let the kernel defer completion work until we ask for it
+  p.flags |= IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+  ring.fd = uring_setup(URING_RECV_SQ_ENTRIES, &p);
+  if (ring.fd < 0 && errno == EINVAL) {
+    memset(&p, 0, sizeof(p));
+    p.flags = IORING_SETUP_CQSIZE;
+    p.cq_entries = ring.buf_entries * 2;
+    ring.fd = uring_setup(URING_RECV_SQ_ENTRIES, &p);
+  }
+#else
+  ring.fd = uring_setup(URING_RECV_SQ_ENTRIES, &p);
+#endif
+  VERIFY_ERR(ring.fd >= 0, "create io_uring", _log);
+
+  try {
+    VERIFY(p.features & IORING_FEAT_EXT_ARG, "io_uring wait with timeout, kernel is too old", _log);
+
+    ring.sq_map_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    ring.cq_map_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+      ring.sq_map_size = ring.cq_map_size = (ring.sq_map_size > ring.cq_map_size) ? ring.sq_map_size : ring.cq_map_size;
+    }
+
+    ring.sq_map = mmap(NULL, ring.sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQ_RING);
+    VERIFY_ERR(ring.sq_map != MAP_FAILED, "map io_uring submission queue", _log);
+
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+      ring.cq_map = ring.sq_map;
+    } else {
+      ring.cq_map = mmap(NULL, ring.cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_CQ_RING);
+      VERIFY_ERR(ring.cq_map != MAP_FAILED, "map io_uring completion queue", _log);
+    }
+
+    ring.sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    ring.sqes = (struct io_uring_sqe*) mmap(NULL, ring.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQES);
+    VERIFY_ERR(ring.sqes != MAP_FAILED, "map io_uring submission entries", _log);
+
+    uint8_t* sq = (uint8_t*) ring.sq_map;
+    ring.sq_head  = (unsigned*)(sq + p.sq_off.head);
+    ring.sq_tail  = (unsigned*)(sq + p.sq_off.tail);
+    ring.sq_mask  = (unsigned*)(sq + p.sq_off.ring_mask);
+    ring.sq_array = (unsigned*)(sq + p.sq_off.array);
+
+    uint8_t* cq = (uint8_t*) ring.cq_map;
+    ring.cq_head  = (unsigned*)(cq + p.cq_off.head);
+    ring.cq_tail  = (unsigned*)(cq + p.cq_off.tail);
+    ring.cq_mask  = (unsigned*)(cq + p.cq_off.ring_mask);
+    ring.cqes     = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+
+    // The provided buffer ring must be page aligned
+    void* mem = NULL;
+    ring.buf_ring_size = ring.buf_entries * sizeof(struct io_uring_buf);
+    VERIFY(posix_memalign(&mem, sysconf(_SC_PAGESIZE), ring.buf_ring_size) == 0, "allocate provided buffer ring", _log);
+    memset(mem, 0, ring.buf_ring_size);
+    ring.buf_ring = (struct io_uring_buf_ring*) mem;
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t) ring.buf_ring;
+    reg.ring_entries = ring.buf_entries;
+    reg.bgid = URING_RECV_BGID;
+    VERIFY_ERR(uring_register(ring.fd, IORING_REGISTER_PBUF_RING, &reg, 1) == 0, "register provided buffer ring", _log);
+
+    // Every datagram is preceded by the io_uring_recvmsg_out header and the sender's address, see URING_RECV_HEADROOM
+    ring.msg.msg_namelen = sizeof(struct sockaddr_in);
+    VERIFY(sizeof(struct io_uring_recvmsg_out) + ring.msg.msg_namelen <= URING_RECV_HEADROOM, "io_uring headroom", _log);
+
+    // Probe for multishot recvmsg, a kernel without it rejects the request while it is being submitted. With
+    // no buffers provided yet a kernel that has it ends the request straight away for lack of buffers instead.
+    VERIFY_ERR(uring_recv_arm(&ring) == 0, "submit multishot recvmsg", _log);
+    uring_recv_cqe_t cqe;
+    if (uring_recv_completions(&ring, &cqe, 1) && cqe.res < 0) {
+      errno = -cqe.res;
+      VERIFY_ERR(cqe.res == -ENOBUFS, "multishot recvmsg", _log);
+    }
+  } catch (...) {
+    uring_recv_close(ring);
+    throw;
+  }
+
+  return ring;
+}
+
+/**
+ * Adds a buffer to the provided buffer ring. The kernel does not see it until uring_recv_publish is called.
+ * The buffer must stay valid until the kernel has used it or the ring has been closed.
+ */
+void uring_recv_provide (uring_recv_t* ring, void* addr, unsigned len, uint16_t bid)
+{
+  // The ring is a plain array of io_uring_buf with the tail overlaid on the first entry. Index it by hand, some
+  // versions of linux/io_uring.h declare bufs with a wrapper that moves it off of offset zero when built as C++.
+  struct io_uring_buf* buf = (struct io_uring_buf*) ring->buf_ring + (ring->buf_tail & (ring->buf_entries - 1));
+  buf->addr = (uint64_t)(uintptr_t) addr;
+  buf->len = len;
+  buf->bid = bid;
+  ++ring->buf_tail;
+}
+
+/**
+ * Hands every buffer added by uring_recv_provide over to the kernel.
+ */
+void uring_recv_publish (uring_recv_t* ring)
+{
+  // The buffer descriptors must be visible before the new tail
+  __sync_synchronize();
+  *(volatile uint16_t*) &ring->buf_ring->tail = ring->buf_tail;
+}
+
+/**
+ * Submits the multishot recvmsg. It stays armed, posting a completion per datagram, until it runs out of
+ * provided buffers or hits an error; the completion without the more flag set clears ring.armed.
+ * Returns 0 on success or -1 with errno set.
+ */
+int uring_recv_arm (uring_recv_t* ring)
+{
+  struct io_uring_sqe sqe;
+  memset(&sqe, 0, sizeof(sqe));
+  sqe.opcode = IORING_OP_RECVMSG;
+  sqe.fd = ring->sock;
+  // The msghdr is copied by the kernel while the request is being submitted, it is not referenced afterwards
+  sqe.addr = (uint64_t)(uintptr_t) &ring->msg;
+  sqe.len = 1;
+  sqe.flags = IOSQE_BUFFER_SELECT;
+  sqe.buf_group = URING_RECV_BGID;
+  sqe.ioprio = IORING_RECV_MULTISHOT;
+  sqe.user_data = URING_RECV_USER_DATA;
+
+  if (uring_submit(ring, &sqe) != 0) {
+    return -1;
+  }
+  ring->armed = 1;
+  return 0;
+}
+
+/**
+ * Cancels the armed multishot recvmsg and waits up to timeout ms for it to finish. Any completions still
+ * queued are discarded. Once this returns 0 the kernel no longer writes to any provided buffer.
+ * Returns -1 if the recvmsg could not be cancelled.
+ */
+int uring_recv_cancel (uring_recv_t* ring, int timeout)
+{
+  struct io_uring_sqe sqe;
+  memset(&sqe, 0, sizeof(sqe));
+  sqe.opcode = IORING_OP_ASYNC_CANCEL;
+  sqe.fd = -1;
+  sqe.addr = URING_RECV_USER_DATA;
+  sqe.user_data = URING_CANCEL_USER_DATA;
+
+  if (uring_submit(ring, &sqe) != 0) {
+    return -1;
+  }
+
+  for (;;) {
+    if (uring_recv_wait(ring, timeout) <= 0) {
+      return -1;
+    }
+
+    unsigned head = *ring->cq_head;
+    unsigned tail = *(volatile unsigned*) ring->cq_tail;
+    __sync_synchronize();
+
+    bool done = false;
+    for (; head != tail; ++head) {
+      const struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cq_mask];
+      if (cqe->user_data == URING_RECV_USER_DATA && !(cqe->flags & IORING_CQE_F_MORE)) {
+        done = true;
+      }
+    }
+
+    __sync_synchronize();
+    *(volatile unsigned*) ring->cq_head = head;
+
+    if (done) {
+      ring->armed = 0;
+      return 0;
+    }
+  }
+}
+
+/**
+ * Waits up to timeout ms for at least one completion. Returns the number of completions ready, 0 if
+ * there were none before the timeout or -1 with errno set on error.
+ */
+int uring_recv_wait (uring_recv_t* ring, int timeout)
+{
+  struct __kernel_timespec ts;
+  ts.tv_sec = timeout / 1000;
+  ts.tv_nsec = (timeout % 1000) * 1000000LL;
+
+  struct io_uring_getevents_arg arg;
+  memset(&arg, 0, sizeof(arg));
+  arg.ts = (uint64_t)(uintptr_t) &ts;
+
+  if (uring_enter(ring->fd, 0, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg)) < 0 && errno != ETIME && errno != EINTR) {
+    return -1;
+  }
+
+  unsigned tail = *(volatile unsigned*) ring->cq_tail;
+  return (int)(tail - *ring->cq_head);
+}
+
+/**
+ * Copies up to max completions out of the completion queue and hands their slots back to the kernel.
+ * Returns the number of completions copied.
+ */
+unsigned uring_recv_completions (uring_recv_t* ring, uring_recv_cqe_t* cqes, unsigned max)
+{
+  unsigned head = *ring->cq_head;
+  unsigned tail = *(volatile unsigned*) ring->cq_tail;
+  // Don't let reads of the completions move ahead of the tail
+  __sync_synchronize();
+
+  unsigned count = 0;
+  for (; head != tail && count < max; ++head, ++count) {
+    const struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cq_mask];
+    cqes[count].res = cqe->res;
+    cqes[count].bid = (cqe->flags & IORING_CQE_F_BUFFER) ? (int)(cqe->flags >> IORING_CQE_BUFFER_SHIFT) : -1;
+    cqes[count].more = (cqe->flags & IORING_CQE_F_MORE) != 0;
+    if (cqe->user_data == URING_RECV_USER_DATA && !cqes[count].more) {
+      ring->armed = 0;
+    }
+  }
+
+  __sync_synchronize();
+  *(volatile unsigned*) ring->cq_head = head;
+  return count;
+}
+
+/**
+ * Returns a pointer to the datagram within a buffer filled by the multishot recvmsg and its length, or NULL
+ * if the datagram was truncated. If source is provided it is set to the sender's address.
+ */
+const uint8_t* uring_recv_payload (const uring_recv_t* ring, const void* buf, int res, size_t* len, struct in_addr* source)
+{
+  const struct io_uring_recvmsg_out* out = (const struct io_uring_recvmsg_out*) buf;
+  size_t prefix = sizeof(*out) + ring->msg.msg_namelen + ring->msg.msg_controllen;
+
+  if (res < 0 || (size_t) res < prefix || (out->flags & MSG_TRUNC) || out->payloadlen > (size_t) res - prefix) {
+    return NULL;
+  }
+
+  if (source && out->namelen >= sizeof(struct sockaddr_in)) {
+    *source = ((const struct sockaddr_in*)(out + 1))->sin_addr;
+  }
+
+  *len = out->payloadlen;
+  return (const uint8_t*) buf + prefix;
+}
+
+void uring_recv_close (uring_recv_t ring)
+{
+  if (ring.sqes != MAP_FAILED && ring.sqes != NULL) {
+    munmap(ring.sqes, ring.sqes_size);
+  }
+  if (ring.cq_map != MAP_FAILED && ring.cq_map != NULL && ring.cq_map != ring.sq_map) {
+    munmap(ring.cq_map, ring.cq_map_size);
+  }
+  if (ring.sq_map != MAP_FAILED && ring.sq_map != NULL) {
+    munmap(ring.sq_map, ring.sq_map_size);
+  }
+  // Closing the io_uring cancels the recvmsg and unregisters the buffer ring
+  if (ring.fd >= 0) {
+    close(ring.fd);
+  }
+  free(ring.buf_ring);
+}
+
+#else
+
+uring_recv_t uring_recv_open (int sock, unsigned buf_entries, LOGGER _log) throw (BadParameterError)
+{
+  if (!_log) {
+    _log = rh_logger::Logger::getLogger("SourceSDDS_utils");
+  }
+  VERIFY(false, "io_uring support, this build did not find linux/io_uring.h with multishot receive", _log);
+
+  uring_recv_t ring;
+  memset(&ring, 0, sizeof(ring));
+  return ring;
+}
+
+void uring_recv_provide (uring_recv_t* ring, void* addr, unsigned len, uint16_t bid) {}
+void uring_recv_publish (uring_recv_t* ring) {}
+int uring_recv_arm (uring_recv_t* ring) { errno = ENOSYS; return -1; }
+int uring_recv_cancel (uring_recv_t* ring, int timeout) { errno = ENOSYS; return -1; }
+int uring_recv_wait (uring_recv_t* ring, int timeout) { errno = ENOSYS; return -1; }
+unsigned uring_recv_completions (uring_recv_t* ring, uring_recv_cqe_t* cqes, unsigned max) { return 0; }
+const uint8_t* uring_recv_payload (const uring_recv_t* ring, const void* buf, int res, size_t* len, struct in_addr* source) { return NULL; }
+void uring_recv_close (uring_recv_t ring) {}
+
+#endif
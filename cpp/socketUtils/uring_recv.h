@@ -0,0 +1,102 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef URING_RECV_H_
+#define URING_RECV_H_
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <stdint.h>
+#include <stdexcept>
+#include <ossie/debug.h>
+#include "SourceNicUtils.h"
+
+// The multishot recvmsg writes a 16 byte io_uring_recvmsg_out header followed by the sockaddr_in of the
+// sender ahead of the datagram. A provided buffer must reserve this much room in front of the packet.
+#define URING_RECV_HEADROOM 32
+
+// The kernel limits a provided buffer ring to 32768 entries and buffer ids to 16 bits.
+#define URING_RECV_MAX_BUFFERS 32768
+#define URING_RECV_MAX_BUFFER_ID 65535
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf_ring;
+
+/**
+ * An io_uring with a single multishot recvmsg outstanding against a UDP socket. The datagrams are received
+ * into buffers the caller provides through a registered provided buffer ring, the kernel picks the buffers
+ * in the order they were provided and reports the buffer id it used in each completion.
+ * Only available if built against a kernel with linux/io_uring.h (HAVE_LINUX_IO_URING_H) and run on a kernel
+ * that supports multishot recvmsg (6.0 or newer), uring_recv_open throws otherwise.
+ */
+typedef struct {
+  int fd;
+  int sock;
+  void *sq_map;
+  size_t sq_map_size;
+  void *cq_map;
+  size_t cq_map_size;
+  struct io_uring_sqe *sqes;
+  size_t sqes_size;
+  unsigned *sq_head;
+  unsigned *sq_tail;
+  unsigned *sq_mask;
+  unsigned *sq_array;
+  unsigned *cq_head;
+  unsigned *cq_tail;
+  unsigned *cq_mask;
+  struct io_uring_cqe *cqes;
+  struct io_uring_buf_ring *buf_ring;
+  size_t buf_ring_size;
+  unsigned buf_entries;
+  uint16_t buf_tail;
+  struct msghdr msg;
+  int armed;
+} uring_recv_t;
+
+/**
+ * A single completion. bid is the id of the buffer the datagram was received into or -1 if no buffer was
+ * consumed. more is zero once the multishot recvmsg has terminated and must be re-armed.
+ */
+typedef struct {
+  int res;
+  int bid;
+  int more;
+} uring_recv_cqe_t;
+
+uring_recv_t uring_recv_open (int sock, unsigned buf_entries, LOGGER _log=LOGGER()) throw (BadParameterError);
+void uring_recv_provide (uring_recv_t* ring, void* addr, unsigned len, uint16_t bid);
+void uring_recv_publish (uring_recv_t* ring);
+int uring_recv_arm (uring_recv_t* ring);
+int uring_recv_cancel (uring_recv_t* ring, int timeout);
+int uring_recv_wait (uring_recv_t* ring, int timeout);
+unsigned uring_recv_completions (uring_recv_t* ring, uring_recv_cqe_t* cqes, unsigned max);
+const uint8_t* uring_recv_payload (const uring_recv_t* ring, const void* buf, int res, size_t* len, struct in_addr* source);
+void uring_recv_close (uring_recv_t ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* URING_RECV_H_ */
@@ -30,18 +30,62 @@
 #include <CF/cf.h>
 #include <ossie/PropertyMap.h>
 
+namespace enums {
+    // Enumerated values for advanced_optimizations
+    namespace advanced_optimizations {
+        // Enumerated values for advanced_optimizations::socket_read_backend
+        namespace socket_read_backend {
+            static const std::string recvmmsg = "recvmmsg";
+            static const std::string packet_mmap = "packet_mmap";
+            static const std::string io_uring = "io_uring";
+        }
+        // Enumerated values for advanced_optimizations::socket_wait_strategy
+        namespace socket_wait_strategy {
+            static const std::string poll = "poll";
+            static const std::string spin = "spin";
+            static const std::string spin_then_poll = "spin_then_poll";
+            static const std::string busy_poll = "busy_poll";
+        }
+        // Enumerated values for advanced_optimizations::packet_filter_complex
+        namespace packet_filter_complex {
+            static const std::string any = "any";
+            static const std::string real = "real";
+            static const std::string complex = "complex";
+        }
+    }
+}
+
 struct advanced_optimizations_struct {
     advanced_optimizations_struct ()
     {
         buffer_size = 20000;
         udp_socket_buffer_size = 134217728;
         pkts_per_socket_read = 500;
+        socket_read_backend = "recvmmsg";
         sdds_pkts_per_bulkio_push = 1000;
         socket_read_thread_affinity = "";
         sdds_to_bulkio_thread_affinity = "";
         socket_read_thread_priority = -1;
         sdds_to_bulkio_thread_priority = -1;
         check_for_duplicate_sender = false;
+        lock_free_buffer = false;
+        scatter_receive = false;
+        socket_readers = 1;
+        socket_reader_cpus = "";
+        max_attached_streams = 1;
+        socket_wait_strategy = "poll";
+        socket_wait_spin_budget = 50;
+        udp_gro = false;
+        packet_filter = false;
+        packet_filter_sender = "";
+        packet_filter_bps = 0;
+        packet_filter_complex = "any";
+        receive_timestamps = false;
+        status_interval = 100;
+        overflow_policy = "block";
+        numa_node = "";
+        huge_pages = "none";
+        lock_buffer = false;
     }
 
     static std::string getId() {
@@ -49,18 +93,37 @@ struct advanced_optimizations_struct {
     }
 
     static const char* getFormat() {
-        return "IIHHssiib";
+        return "IIHsHssiibbbHsHsIbbsHsbHsssb";
     }
 
     CORBA::ULong buffer_size;
     CORBA::ULong udp_socket_buffer_size;
     unsigned short pkts_per_socket_read;
+    std::string socket_read_backend;
     unsigned short sdds_pkts_per_bulkio_push;
     std::string socket_read_thread_affinity;
     std::string sdds_to_bulkio_thread_affinity;
     CORBA::Long socket_read_thread_priority;
     CORBA::Long sdds_to_bulkio_thread_priority;
     bool check_for_duplicate_sender;
+    bool lock_free_buffer;
+    bool scatter_receive;
+    unsigned short socket_readers;
+    std::string socket_reader_cpus;
+    unsigned short max_attached_streams;
+    std::string socket_wait_strategy;
+    CORBA::ULong socket_wait_spin_budget;
+    bool udp_gro;
+    bool packet_filter;
+    std::string packet_filter_sender;
+    unsigned short packet_filter_bps;
+    std::string packet_filter_complex;
+    bool receive_timestamps;
+    unsigned short status_interval;
+    std::string overflow_policy;
+    std::string numa_node;
+    std::string huge_pages;
+    bool lock_buffer;
 };
 
 inline bool operator>>= (const CORBA::Any& a, advanced_optimizations_struct& s) {
@@ -76,6 +139,9 @@ inline bool operator>>= (const CORBA::Any& a, advanced_optimizations_struct& s)
     if (props.contains("advanced_optimizations::pkts_per_socket_read")) {
         if (!(props["advanced_optimizations::pkts_per_socket_read"] >>= s.pkts_per_socket_read)) return false;
     }
+    if (props.contains("advanced_optimizations::socket_read_backend")) {
+        if (!(props["advanced_optimizations::socket_read_backend"] >>= s.socket_read_backend)) return false;
+    }
     if (props.contains("advanced_optimizations::sdds_pkts_per_bulkio_push")) {
         if (!(props["advanced_optimizations::sdds_pkts_per_bulkio_push"] >>= s.sdds_pkts_per_bulkio_push)) return false;
     }
@@ -94,6 +160,60 @@ inline bool operator>>= (const CORBA::Any& a, advanced_optimizations_struct& s)
     if (props.contains("advanced_optimizations::check_for_duplicate_sender")) {
         if (!(props["advanced_optimizations::check_for_duplicate_sender"] >>= s.check_for_duplicate_sender)) return false;
     }
+    if (props.contains("advanced_optimizations::lock_free_buffer")) {
+        if (!(props["advanced_optimizations::lock_free_buffer"] >>= s.lock_free_buffer)) return false;
+    }
+    if (props.contains("advanced_optimizations::scatter_receive")) {
+        if (!(props["advanced_optimizations::scatter_receive"] >>= s.scatter_receive)) return false;
+    }
+    if (props.contains("advanced_optimizations::socket_readers")) {
+        if (!(props["advanced_optimizations::socket_readers"] >>= s.socket_readers)) return false;
+    }
+    if (props.contains("advanced_optimizations::socket_reader_cpus")) {
+        if (!(props["advanced_optimizations::socket_reader_cpus"] >>= s.socket_reader_cpus)) return false;
+    }
+    if (props.contains("advanced_optimizations::max_attached_streams")) {
+        if (!(props["advanced_optimizations::max_attached_streams"] >>= s.max_attached_streams)) return false;
+    }
+    if (props.contains("advanced_optimizations::socket_wait_strategy")) {
+        if (!(props["advanced_optimizations::socket_wait_strategy"] >>= s.socket_wait_strategy)) return false;
+    }
+    if (props.contains("advanced_optimizations::socket_wait_spin_budget")) {
+        if (!(props["advanced_optimizations::socket_wait_spin_budget"] >>= s.socket_wait_spin_budget)) return false;
+    }
+    if (props.contains("advanced_optimizations::udp_gro")) {
+        if (!(props["advanced_optimizations::udp_gro"] >>= s.udp_gro)) return false;
+    }
+    if (props.contains("advanced_optimizations::packet_filter")) {
+        if (!(props["advanced_optimizations::packet_filter"] >>= s.packet_filter)) return false;
+    }
+    if (props.contains("advanced_optimizations::packet_filter_sender")) {
+        if (!(props["advanced_optimizations::packet_filter_sender"] >>= s.packet_filter_sender)) return false;
+    }
+    if (props.contains("advanced_optimizations::packet_filter_bps")) {
+        if (!(props["advanced_optimizations::packet_filter_bps"] >>= s.packet_filter_bps)) return false;
+    }
+    if (props.contains("advanced_optimizations::packet_filter_complex")) {
+        if (!(props["advanced_optimizations::packet_filter_complex"] >>= s.packet_filter_complex)) return false;
+    }
+    if (props.contains("advanced_optimizations::receive_timestamps")) {
+        if (!(props["advanced_optimizations::receive_timestamps"] >>= s.receive_timestamps)) return false;
+    }
+    if (props.contains("advanced_optimizations::status_interval")) {
+        if (!(props["advanced_optimizations::status_interval"] >>= s.status_interval)) return false;
+    }
+    if (props.contains("advanced_optimizations::overflow_policy")) {
+        if (!(props["advanced_optimizations::overflow_policy"] >>= s.overflow_policy)) return false;
+    }
+    if (props.contains("advanced_optimizations::numa_node")) {
+        if (!(props["advanced_optimizations::numa_node"] >>= s.numa_node)) return false;
+    }
+    if (props.contains("advanced_optimizations::huge_pages")) {
+        if (!(props["advanced_optimizations::huge_pages"] >>= s.huge_pages)) return false;
+    }
+    if (props.contains("advanced_optimizations::lock_buffer")) {
+        if (!(props["advanced_optimizations::lock_buffer"] >>= s.lock_buffer)) return false;
+    }
     return true;
 }
 
@@ -106,6 +226,8 @@ inline void operator<<= (CORBA::Any& a, const advanced_optimizations_struct& s)
  
     props["advanced_optimizations::pkts_per_socket_read"] = s.pkts_per_socket_read;
  
+    props["advanced_optimizations::socket_read_backend"] = s.socket_read_backend;
+ 
     props["advanced_optimizations::sdds_pkts_per_bulkio_push"] = s.sdds_pkts_per_bulkio_push;
  
     props["advanced_optimizations::socket_read_thread_affinity"] = s.socket_read_thread_affinity;
@@ -117,6 +239,42 @@ inline void operator<<= (CORBA::Any& a, const advanced_optimizations_struct& s)
     props["advanced_optimizations::sdds_to_bulkio_thread_priority"] = s.sdds_to_bulkio_thread_priority;
  
     props["advanced_optimizations::check_for_duplicate_sender"] = s.check_for_duplicate_sender;
+ 
+    props["advanced_optimizations::lock_free_buffer"] = s.lock_free_buffer;
+ 
+    props["advanced_optimizations::scatter_receive"] = s.scatter_receive;
+ 
+    props["advanced_optimizations::socket_readers"] = s.socket_readers;
+ 
+    props["advanced_optimizations::socket_reader_cpus"] = s.socket_reader_cpus;
+ 
+    props["advanced_optimizations::max_attached_streams"] = s.max_attached_streams;
+ 
+    props["advanced_optimizations::socket_wait_strategy"] = s.socket_wait_strategy;
+ 
+    props["advanced_optimizations::socket_wait_spin_budget"] = s.socket_wait_spin_budget;
+ 
+    props["advanced_optimizations::udp_gro"] = s.udp_gro;
+ 
+    props["advanced_optimizations::packet_filter"] = s.packet_filter;
+ 
+    props["advanced_optimizations::packet_filter_sender"] = s.packet_filter_sender;
+ 
+    props["advanced_optimizations::packet_filter_bps"] = s.packet_filter_bps;
+ 
+    props["advanced_optimizations::packet_filter_complex"] = s.packet_filter_complex;
+ 
+    props["advanced_optimizations::receive_timestamps"] = s.receive_timestamps;
+ 
+    props["advanced_optimizations::status_interval"] = s.status_interval;
+ 
+    props["advanced_optimizations::overflow_policy"] = s.overflow_policy;
+ 
+    props["advanced_optimizations::numa_node"] = s.numa_node;
+ 
+    props["advanced_optimizations::huge_pages"] = s.huge_pages;
+ 
+    props["advanced_optimizations::lock_buffer"] = s.lock_buffer;
     a <<= props;
 }
 
@@ -127,6 +285,8 @@ inline bool operator== (const advanced_optimizations_struct& s1, const advanced_
         return false;
     if (s1.pkts_per_socket_read!=s2.pkts_per_socket_read)
         return false;
+    if (s1.socket_read_backend!=s2.socket_read_backend)
+        return false;
     if (s1.sdds_pkts_per_bulkio_push!=s2.sdds_pkts_per_bulkio_push)
         return false;
     if (s1.socket_read_thread_affinity!=s2.socket_read_thread_affinity)
@@ -139,6 +299,42 @@ inline bool operator== (const advanced_optimizations_struct& s1, const advanced_
         return false;
     if (s1.check_for_duplicate_sender!=s2.check_for_duplicate_sender)
         return false;
+    if (s1.lock_free_buffer!=s2.lock_free_buffer)
+        return false;
+    if (s1.scatter_receive!=s2.scatter_receive)
+        return false;
+    if (s1.socket_readers!=s2.socket_readers)
+        return false;
+    if (s1.socket_reader_cpus!=s2.socket_reader_cpus)
+        return false;
+    if (s1.max_attached_streams!=s2.max_attached_streams)
+        return false;
+    if (s1.socket_wait_strategy!=s2.socket_wait_strategy)
+        return false;
+    if (s1.socket_wait_spin_budget!=s2.socket_wait_spin_budget)
+        return false;
+    if (s1.udp_gro!=s2.udp_gro)
+        return false;
+    if (s1.packet_filter!=s2.packet_filter)
+        return false;
+    if (s1.packet_filter_sender!=s2.packet_filter_sender)
+        return false;
+    if (s1.packet_filter_bps!=s2.packet_filter_bps)
+        return false;
+    if (s1.packet_filter_complex!=s2.packet_filter_complex)
+        return false;
+    if (s1.receive_timestamps!=s2.receive_timestamps)
+        return false;
+    if (s1.status_interval!=s2.status_interval)
+        return false;
+    if (s1.overflow_policy!=s2.overflow_policy)
+        return false;
+    if (s1.numa_node!=s2.numa_node)
+        return false;
+    if (s1.huge_pages!=s2.huge_pages)
+        return false;
+    if (s1.lock_buffer!=s2.lock_buffer)
+        return false;
     return true;
 }
 
@@ -320,6 +516,32 @@ struct status_struct {
         time_slips = 0LL;
         num_packets_dropped_by_nic = 0;
         interface = "";
+        socket_wait_spin_time = 0;
+        socket_wait_poll_time = 0;
+        socket_wait_polls = 0;
+        rejected_packets = 0;
+        socket_buffer_drops = 0;
+        dequeue_latency_p50 = 0;
+        dequeue_latency_p99 = 0;
+        dequeue_latency_p999 = 0;
+        dequeue_latency_max = 0;
+        push_latency_p50 = 0;
+        push_latency_p99 = 0;
+        push_latency_p999 = 0;
+        push_latency_max = 0;
+        attached_streams = 0;
+        packets_received = 0;
+        bytes_received = 0;
+        socket_reads = 0;
+        empty_socket_reads = 0;
+        socket_reader_buffer_wait = 0;
+        processor_buffer_wait = 0;
+        overflow_drops = 0;
+        numa_node = -1;
+        buffer_page_size = 0;
+        buffer_locked = false;
+        byte_swap_kernel = "";
+        stream_status = "";
     }
 
     static std::string getId() {
@@ -327,7 +549,7 @@ struct status_struct {
     }
 
     static const char* getFormat() {
-        return "HIHsssisiisdslis";
+        return "HIHsssisiisdslisddLLLddddddddHLLLLddLhIbss";
     }
 
     unsigned short expected_sequence_number;
@@ -346,6 +568,32 @@ struct status_struct {
     CORBA::LongLong time_slips;
     CORBA::Long num_packets_dropped_by_nic;
     std::string interface;
+    double socket_wait_spin_time;
+    double socket_wait_poll_time;
+    CORBA::ULongLong socket_wait_polls;
+    CORBA::ULongLong rejected_packets;
+    CORBA::ULongLong socket_buffer_drops;
+    double dequeue_latency_p50;
+    double dequeue_latency_p99;
+    double dequeue_latency_p999;
+    double dequeue_latency_max;
+    double push_latency_p50;
+    double push_latency_p99;
+    double push_latency_p999;
+    double push_latency_max;
+    unsigned short attached_streams;
+    CORBA::ULongLong packets_received;
+    CORBA::ULongLong bytes_received;
+    CORBA::ULongLong socket_reads;
+    CORBA::ULongLong empty_socket_reads;
+    double socket_reader_buffer_wait;
+    double processor_buffer_wait;
+    CORBA::ULongLong overflow_drops;
+    CORBA::Short numa_node;
+    CORBA::ULong buffer_page_size;
+    bool buffer_locked;
+    std::string byte_swap_kernel;
+    std::string stream_status;
 };
 
 inline bool operator>>= (const CORBA::Any& a, status_struct& s) {
@@ -400,6 +648,84 @@ inline bool operator>>= (const CORBA::Any& a, status_struct& s) {
     if (props.contains("status::interface")) {
         if (!(props["status::interface"] >>= s.interface)) return false;
     }
+    if (props.contains("status::socket_wait_spin_time")) {
+        if (!(props["status::socket_wait_spin_time"] >>= s.socket_wait_spin_time)) return false;
+    }
+    if (props.contains("status::socket_wait_poll_time")) {
+        if (!(props["status::socket_wait_poll_time"] >>= s.socket_wait_poll_time)) return false;
+    }
+    if (props.contains("status::socket_wait_polls")) {
+        if (!(props["status::socket_wait_polls"] >>= s.socket_wait_polls)) return false;
+    }
+    if (props.contains("status::rejected_packets")) {
+        if (!(props["status::rejected_packets"] >>= s.rejected_packets)) return false;
+    }
+    if (props.contains("status::socket_buffer_drops")) {
+        if (!(props["status::socket_buffer_drops"] >>= s.socket_buffer_drops)) return false;
+    }
+    if (props.contains("status::dequeue_latency_p50")) {
+        if (!(props["status::dequeue_latency_p50"] >>= s.dequeue_latency_p50)) return false;
+    }
+    if (props.contains("status::dequeue_latency_p99")) {
+        if (!(props["status::dequeue_latency_p99"] >>= s.dequeue_latency_p99)) return false;
+    }
+    if (props.contains("status::dequeue_latency_p999")) {
+        if (!(props["status::dequeue_latency_p999"] >>= s.dequeue_latency_p999)) return false;
+    }
+    if (props.contains("status::dequeue_latency_max")) {
+        if (!(props["status::dequeue_latency_max"] >>= s.dequeue_latency_max)) return false;
+    }
+    if (props.contains("status::push_latency_p50")) {
+        if (!(props["status::push_latency_p50"] >>= s.push_latency_p50)) return false;
+    }
+    if (props.contains("status::push_latency_p99")) {
+        if (!(props["status::push_latency_p99"] >>= s.push_latency_p99)) return false;
+    }
+    if (props.contains("status::push_latency_p999")) {
+        if (!(props["status::push_latency_p999"] >>= s.push_latency_p999)) return false;
+    }
+    if (props.contains("status::push_latency_max")) {
+        if (!(props["status::push_latency_max"] >>= s.push_latency_max)) return false;
+    }
+    if (props.contains("status::attached_streams")) {
+        if (!(props["status::attached_streams"] >>= s.attached_streams)) return false;
+    }
+    if (props.contains("status::packets_received")) {
+        if (!(props["status::packets_received"] >>= s.packets_received)) return false;
+    }
+    if (props.contains("status::bytes_received")) {
+        if (!(props["status::bytes_received"] >>= s.bytes_received)) return false;
+    }
+    if (props.contains("status::socket_reads")) {
+        if (!(props["status::socket_reads"] >>= s.socket_reads)) return false;
+    }
+    if (props.contains("status::empty_socket_reads")) {
+        if (!(props["status::empty_socket_reads"] >>= s.empty_socket_reads)) return false;
+    }
+    if (props.contains("status::socket_reader_buffer_wait")) {
+        if (!(props["status::socket_reader_buffer_wait"] >>= s.socket_reader_buffer_wait)) return false;
+    }
+    if (props.contains("status::processor_buffer_wait")) {
+        if (!(props["status::processor_buffer_wait"] >>= s.processor_buffer_wait)) return false;
+    }
+    if (props.contains("status::overflow_drops")) {
+        if (!(props["status::overflow_drops"] >>= s.overflow_drops)) return false;
+    }
+    if (props.contains("status::numa_node")) {
+        if (!(props["status::numa_node"] >>= s.numa_node)) return false;
+    }
+    if (props.contains("status::buffer_page_size")) {
+        if (!(props["status::buffer_page_size"] >>= s.buffer_page_size)) return false;
+    }
+    if (props.contains("status::buffer_locked")) {
+        if (!(props["status::buffer_locked"] >>= s.buffer_locked)) return false;
+    }
+    if (props.contains("status::byte_swap_kernel")) {
+        if (!(props["status::byte_swap_kernel"] >>= s.byte_swap_kernel)) return false;
+    }
+    if (props.contains("status::stream_status")) {
+        if (!(props["status::stream_status"] >>= s.stream_status)) return false;
+    }
     return true;
 }
 
@@ -437,6 +763,58 @@ inline void operator<<= (CORBA::Any& a, const status_struct& s) {
     props["status::num_packets_dropped_by_nic"] = s.num_packets_dropped_by_nic;
  
     props["status::interface"] = s.interface;
+ 
+    props["status::socket_wait_spin_time"] = s.socket_wait_spin_time;
+ 
+    props["status::socket_wait_poll_time"] = s.socket_wait_poll_time;
+ 
+    props["status::socket_wait_polls"] = s.socket_wait_polls;
+ 
+    props["status::rejected_packets"] = s.rejected_packets;
+ 
+    props["status::socket_buffer_drops"] = s.socket_buffer_drops;
+ 
+    props["status::dequeue_latency_p50"] = s.dequeue_latency_p50;
+ 
+    props["status::dequeue_latency_p99"] = s.dequeue_latency_p99;
+ 
+    props["status::dequeue_latency_p999"] = s.dequeue_latency_p999;
+ 
+    props["status::dequeue_latency_max"] = s.dequeue_latency_max;
+ 
+    props["status::push_latency_p50"] = s.push_latency_p50;
+ 
+    props["status::push_latency_p99"] = s.push_latency_p99;
+ 
+    props["status::push_latency_p999"] = s.push_latency_p999;
+ 
+    props["status::push_latency_max"] = s.push_latency_max;
+ 
+    props["status::attached_streams"] = s.attached_streams;
+ 
+    props["status::packets_received"] = s.packets_received;
+ 
+    props["status::bytes_received"] = s.bytes_received;
+ 
+    props["status::socket_reads"] = s.socket_reads;
+ 
+    props["status::empty_socket_reads"] = s.empty_socket_reads;
+ 
+    props["status::socket_reader_buffer_wait"] = s.socket_reader_buffer_wait;
+ 
+    props["status::processor_buffer_wait"] = s.processor_buffer_wait;
+ 
+    props["status::overflow_drops"] = s.overflow_drops;
+ 
+    props["status::numa_node"] = s.numa_node;
+ 
+    props["status::buffer_page_size"] = s.buffer_page_size;
+ 
+    props["status::buffer_locked"] = s.buffer_locked;
+ 
+    props["status::byte_swap_kernel"] = s.byte_swap_kernel;
+ 
+    props["status::stream_status"] = s.stream_status;
     a <<= props;
 }
 
@@ -473,6 +851,58 @@ inline bool operator== (const status_struct& s1, const status_struct& s2) {
         return false;
     if (s1.interface!=s2.interface)
         return false;
+    if (s1.socket_wait_spin_time!=s2.socket_wait_spin_time)
+        return false;
+    if (s1.socket_wait_poll_time!=s2.socket_wait_poll_time)
+        return false;
+    if (s1.socket_wait_polls!=s2.socket_wait_polls)
+        return false;
+    if (s1.rejected_packets!=s2.rejected_packets)
+        return false;
+    if (s1.socket_buffer_drops!=s2.socket_buffer_drops)
+        return false;
+    if (s1.dequeue_latency_p50!=s2.dequeue_latency_p50)
+        return false;
+    if (s1.dequeue_latency_p99!=s2.dequeue_latency_p99)
+        return false;
+    if (s1.dequeue_latency_p999!=s2.dequeue_latency_p999)
+        return false;
+    if (s1.dequeue_latency_max!=s2.dequeue_latency_max)
+        return false;
+    if (s1.push_latency_p50!=s2.push_latency_p50)
+        return false;
+    if (s1.push_latency_p99!=s2.push_latency_p99)
+        return false;
+    if (s1.push_latency_p999!=s2.push_latency_p999)
+        return false;
+    if (s1.push_latency_max!=s2.push_latency_max)
+        return false;
+    if (s1.attached_streams!=s2.attached_streams)
+        return false;
+    if (s1.packets_received!=s2.packets_received)
+        return false;
+    if (s1.bytes_received!=s2.bytes_received)
+        return false;
+    if (s1.socket_reads!=s2.socket_reads)
+        return false;
+    if (s1.empty_socket_reads!=s2.empty_socket_reads)
+        return false;
+    if (s1.socket_reader_buffer_wait!=s2.socket_reader_buffer_wait)
+        return false;
+    if (s1.processor_buffer_wait!=s2.processor_buffer_wait)
+        return false;
+    if (s1.overflow_drops!=s2.overflow_drops)
+        return false;
+    if (s1.numa_node!=s2.numa_node)
+        return false;
+    if (s1.buffer_page_size!=s2.buffer_page_size)
+        return false;
+    if (s1.buffer_locked!=s2.buffer_locked)
+        return false;
+    if (s1.byte_swap_kernel!=s2.byte_swap_kernel)
+        return false;
+    if (s1.stream_status!=s2.stream_status)
+        return false;
     return true;
 }
 
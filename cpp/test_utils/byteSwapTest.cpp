@@ -0,0 +1,175 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK rh.SourceSDDS.
+ *
+ * REDHAWK rh.SourceSDDS is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK rh.SourceSDDS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+/*
+ * Checks every byte swap kernel the CPU supports against the scalar kernels, and the scalar kernels against a plain
+ * byte reversal, over odd lengths and alignments, in place and out of place, with and without non temporal stores.
+ * Exits non zero on the first mismatch. Run by make check.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ByteSwap.h"
+
+typedef void (*kernel_t)(uint8_t *dst, const uint8_t *src, size_t len, bool non_temporal);
+
+typedef struct {
+	const char *name;
+	kernel_t swap16;
+	kernel_t swap32;
+	bool supported;
+} kernel_entry_t;
+
+static const size_t MAX_LEN = 4 * 1024 + 67;
+static const size_t GUARD = 64;
+
+/**
+ * Reverses each whole sample of size bytes, copying any bytes left over as they are.
+ */
+static void referenceSwap(uint8_t *dst, const uint8_t *src, size_t len, size_t size) {
+	size_t i = 0;
+	for (; i + size <= len; i += size) {
+		for (size_t b = 0; b < size; ++b) {
+			dst[i + b] = src[i + size - 1 - b];
+		}
+	}
+	for (; i < len; ++i) {
+		dst[i] = src[i];
+	}
+}
+
+/**
+ * Runs kernel over len bytes of src at src_offset into a buffer at dst_offset, or in place if dst_offset is negative,
+ * and compares the result, and the guard bytes either side of it, with expected. Returns false on a mismatch.
+ */
+static bool check(const char *name, kernel_t kernel, size_t size, const uint8_t *src, size_t len, size_t src_offset,
+		int dst_offset, bool non_temporal, const uint8_t *expected) {
+	static uint8_t input[MAX_LEN + 2 * GUARD] __attribute__((aligned(64)));
+	static uint8_t output[MAX_LEN + 2 * GUARD] __attribute__((aligned(64)));
+
+	memset(output, 0xa5, sizeof(output));
+	memcpy(input + GUARD + src_offset, src, len);
+
+	uint8_t *result;
+	if (dst_offset < 0) {
+		memset(input, 0xa5, GUARD + src_offset);
+		memset(input + GUARD + src_offset + len, 0xa5, sizeof(input) - (GUARD + src_offset + len));
+		result = input + GUARD + src_offset;
+		kernel(result, result, len, non_temporal);
+	} else {
+		result = output + GUARD + dst_offset;
+		kernel(result, input + GUARD + src_offset, len, non_temporal);
+	}
+
+	const uint8_t *buffer = (dst_offset < 0) ? input : output;
+	bool guards_ok = true;
+	for (const uint8_t *p = buffer; p < result; ++p) {
+		guards_ok = guards_ok && (*p == 0xa5);
+	}
+	for (const uint8_t *p = result + len; p < buffer + sizeof(input); ++p) {
+		guards_ok = guards_ok && (*p == 0xa5);
+	}
+
+	if (memcmp(result, expected, len) != 0 || not guards_ok) {
+		printf("FAIL %s %zu bit len %zu src offset %zu dst offset %d non temporal %d%s\n", name, size * 8, len,
+				src_offset, dst_offset, (int) non_temporal, (guards_ok) ? "" : " wrote outside the buffer");
+		return false;
+	}
+	return true;
+}
+
+int main() {
+	kernel_entry_t kernels[] = {
+		{"scalar", byteSwap16Scalar, byteSwap32Scalar, true},
+#ifdef HAVE_BYTESWAP_X86
+		{"ssse3", byteSwap16Ssse3, byteSwap32Ssse3, __builtin_cpu_supports("ssse3") != 0},
+		{"avx2", byteSwap16Avx2, byteSwap32Avx2, __builtin_cpu_supports("avx2") != 0},
+#endif
+#ifdef HAVE_BYTESWAP_AVX512
+		{"avx512", byteSwap16Avx512, byteSwap32Avx512, __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")},
+#endif
+	};
+	const size_t num_kernels = sizeof(kernels) / sizeof(kernels[0]);
+
+	// Every length up to a few vectors of the widest kernel, then odd lengths around a full SDDS payload and beyond
+	size_t lengths[300];
+	size_t num_lengths = 0;
+	for (size_t len = 0; len <= 200; ++len) {
+		lengths[num_lengths++] = len;
+	}
+	for (size_t len = 1021; len <= 1027; ++len) {
+		lengths[num_lengths++] = len;
+	}
+	lengths[num_lengths++] = 2047;
+	lengths[num_lengths++] = 3001;
+	lengths[num_lengths++] = MAX_LEN - 3;
+
+	static const size_t src_offsets[] = {0, 1, 2, 3};
+	static const int dst_offsets[] = {-1, 0, 1, 2, 3};
+
+	uint8_t src[MAX_LEN];
+	uint8_t expected16[MAX_LEN];
+	uint8_t expected32[MAX_LEN];
+	uint8_t scalar[MAX_LEN];
+	srand(1);
+	for (size_t i = 0; i < MAX_LEN; ++i) {
+		src[i] = (uint8_t) rand();
+	}
+
+	bool ok = true;
+	for (size_t l = 0; l < num_lengths; ++l) {
+		const size_t len = lengths[l];
+
+		// The scalar kernels are the reference for the others, so they are checked against a plain byte reversal first
+		referenceSwap(expected16, src, len, 2);
+		referenceSwap(expected32, src, len, 4);
+		byteSwap16Scalar(scalar, src, len, false);
+		ok = ok && (memcmp(scalar, expected16, len) == 0);
+		byteSwap32Scalar(scalar, src, len, false);
+		ok = ok && (memcmp(scalar, expected32, len) == 0);
+		if (not ok) {
+			printf("FAIL scalar does not match a byte reversal, len %zu\n", len);
+			return 1;
+		}
+
+		for (size_t k = 0; k < num_kernels; ++k) {
+			if (not kernels[k].supported) {
+				continue;
+			}
+			for (size_t s = 0; s < sizeof(src_offsets) / sizeof(src_offsets[0]); ++s) {
+				for (size_t d = 0; d < sizeof(dst_offsets) / sizeof(dst_offsets[0]); ++d) {
+					for (int non_temporal = 0; non_temporal < 2; ++non_temporal) {
+						ok = ok && check(kernels[k].name, kernels[k].swap16, 2, src, len, src_offsets[s], dst_offsets[d], non_temporal, expected16);
+						ok = ok && check(kernels[k].name, kernels[k].swap32, 4, src, len, src_offsets[s], dst_offsets[d], non_temporal, expected32);
+					}
+				}
+			}
+		}
+		if (not ok) {
+			return 1;
+		}
+	}
+
+	for (size_t k = 0; k < num_kernels; ++k) {
+		printf("%s %s\n", kernels[k].name, (kernels[k].supported) ? "passed" : "not supported by this CPU, skipped");
+	}
+	printf("dispatching to %s\n", byteSwapKernel());
+	return 0;
+}
@@ -21,9 +21,11 @@ import unittest
 import ossie.utils.testing
 from ossie.cf import CF
 import os
+import resource
 import socket
 import struct
 import sys
+import threading
 import time
 import copy
 from omniORB import any, CORBA
@@ -70,6 +72,17 @@ def timedelta_total_seconds(timedelta):
         timedelta.microseconds + 0.0 +
         (timedelta.seconds + timedelta.days * 24 * 3600) * 10 ** 6) / 10 ** 6
 
+class StallingSink(bh.ArraySink):
+    """Holds every push until released, which holds up the SDDS to BulkIO thread pushing to it"""
+
+    def __init__(self, porttype):
+        bh.ArraySink.__init__(self, porttype)
+        self.released = threading.Event()
+
+    def pushPacket(self, data, ts, EOS, stream_id):
+        self.released.wait(10)
+        bh.ArraySink.pushPacket(self, data, ts, EOS, stream_id)
+
 class ComponentTests(ossie.utils.testing.ScaComponentTestCase):
     """Test for all component implementations in SelectionService"""
 
@@ -180,6 +193,29 @@ class ComponentTests(ossie.utils.testing.ScaComponentTestCase):
         self.assertEqual(self.comp.status.dropped_packets, 0)
         
         
+    def testEmptyInterfaceSelection(self):
+        """With no interface set, a unicast attach picks the interface with the address and a multicast attach the one the group is routed through"""
+        self.comp.interface = ''
+        compDataSddsIn = self.comp.getPort('dataSddsIn')
+
+        streamDef = BULKIO.SDDSStreamDefinition('id', BULKIO.SDDS_SI, self.uni_ip, 0, self.port, 8000, True, 'testing')
+        attachId = compDataSddsIn.attach(streamDef, 'test')
+        self.comp.start()
+        self.assertEqual(self.comp.status.interface, 'lo')
+        self.comp.stop()
+        compDataSddsIn.detach(attachId)
+
+        # Whatever the kernel would send the group out of
+        route = subprocess.check_output(['ip', 'route', 'get', self.multi_ip]).split()
+        expected = route[route.index('dev') + 1]
+
+        streamDef = BULKIO.SDDSStreamDefinition('id', BULKIO.SDDS_SI, self.multi_ip, 0, self.port, 8000, True, 'testing')
+        attachId = compDataSddsIn.attach(streamDef, 'test')
+        self.comp.start()
+        self.assertEqual(self.comp.status.interface, expected)
+        self.comp.stop()
+        compDataSddsIn.detach(attachId)
+
     def testUnicastAttachSuccess(self):
         """Attaches to the dataSddsIn port 10 times making sure that it occurs successfully each time"""
         
@@ -709,228 +745,1258 @@ class ComponentTests(ossie.utils.testing.ScaComponentTestCase):
             self.assertTrue(diff in available, "Expected " + diff + " empty buffers available but received " + available)
             self.comp.stop()
 
-    def testUdpBufferSize(self):
-
+    def testLockFreeBuffer(self):
         self.setupComponent()
-        
-        buffer_sizes = (1000, 2000, 3000, 4000, 5000, 6000)
-        prev_buffer = 0
 
-        # We cannot know exactly what the kernel will pick after our request, this test will try and increase
-        # the buffer size and simply confirm that each run creates a larger buffer size than the one before
-        # however depending on system settings this test may fail.
-        for udp_buffer_size in buffer_sizes:
-            self.comp.advanced_optimizations.udp_socket_buffer_size = udp_buffer_size
-            self.comp.start()
-            buf_size = [int(s) for s in self.comp.status.udp_socket_buffer_queue.split() if s.isdigit()][1]
-            self.assertTrue(buf_size > prev_buffer, "Failure could be false positive, see note in UDP Buffer Size test.")
-            prev_buffer = buf_size
-            self.comp.stop()
-        
-    def testSddsPacketsPerBulkIOPush(self):
-        self.setupComponent()
-        
         # Get ports
         compDataShortOut_out = self.comp.getPort('dataShortOut')
-        sdds_pkts_per_push = (1, 2, 4, 8, 16, 32, 64)
 
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
 
+        self.comp.advanced_optimizations.lock_free_buffer = True
+        self.comp.advanced_optimizations.buffer_size = 500
+        self.comp.advanced_optimizations.pkts_per_socket_read = 100
 
-        for pkts_per_push in sdds_pkts_per_push:
-            self.comp.advanced_optimizations.sdds_pkts_per_bulkio_push = pkts_per_push
+        # Start components
+        self.comp.start()
+        self.assertTrue(self.comp.advanced_optimizations.lock_free_buffer, "Lock free buffer was not enabled")
 
-            # Start components
-            self.comp.start()
+        available = self.comp.status.empty_buffers_available
+        self.assertTrue("400" in available, "Expected 400 empty buffers available but received " + available)
 
-            num_sends = 0
-            data = []
-            
+        # Create data and send more packets than the buffer can hold so buffers are recycled
+        fakeData = [x for x in range(0, 512)]
+        seq = 0
+        num_pkts = 1000
+        for i in range(num_pkts):
+            h = Sdds.SddsHeader(seq)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+            seq = (seq + 1) % 65536
+            if seq != 0 and seq % 32 == 31:
+                seq = seq + 1
+            if i % 100 == 0:
+                time.sleep(0.01)
 
-            sink = sb.StreamSink()
-            self.comp.connect(sink, providesPortName='shortIn')
-            
-            while (not(data) and num_sends < 3*max(sdds_pkts_per_push)):
-                # Create data
-                fakeData = [x for x in range(0, 512)]
-                h = Sdds.SddsHeader(num_sends)
-                p = Sdds.SddsShortPacket(h.header, fakeData)
-                p.encode()
-                self.userver.send(p.encodedPacket)
-                num_sends = num_sends + 1
-                if num_sends != 0 and num_sends % 32 == 31:
-                    num_sends = num_sends + 1
-                    
-                time.sleep(0.05)               
-                packet = sink.port.getPacket()
-                if packet.dataBuffer:
-                    data = packet.dataBuffer
+        # Wait for data to be received
+        time.sleep(1)
 
-            # Validate correct amount of data was received
-            self.assertEqual(len(data), pkts_per_push * 512)
-            self.comp.stop()
+        # Get data
+        data,stream = self.getData()
+
+        # Validate correct amount of data was received
+        self.assertEqual(len(data), num_pkts*512)
+        self.assertEqual(self.comp.status.dropped_packets, 0)
+
+    def testScatterReceive(self):
+        self.setupComponent(pkts_per_push=50)
 
-    def testPushOnTTV(self):
-        '''
-        Push on TTV will send the packet out if the TTV flag changes
-        '''
-        self.setupComponent(pkts_per_push=10)
-        
         # Get ports
         compDataShortOut_out = self.comp.getPort('dataShortOut')
-        
-        self.comp.advanced_configuration.push_on_ttv = True
 
         # Connect components
         self.comp.connect(self.sink, providesPortName='shortIn')
 
+        self.comp.advanced_optimizations.scatter_receive = True
+        self.comp.advanced_optimizations.buffer_size = 500
+        self.comp.advanced_optimizations.pkts_per_socket_read = 100
+
         # Start components
         self.comp.start()
-        ttv = 0
-        pktNum = 0
-        num_changes = 0
-        
-        # We'll do a ttv change every 7th packet
-        while pktNum < 100:
-            
-            if pktNum % 7 == 0:
-                ttv = (ttv + 1) % 2 # aka if 0 become 1, if 1 become 0
-                num_changes += 1
-            
-            # Create data
-            fakeData = [x for x in range(0, 512)]
-            h = Sdds.SddsHeader(pktNum, TTV = ttv)
+        self.assertTrue(self.comp.advanced_optimizations.scatter_receive, "Scatter receive was not enabled")
+
+        # Send more packets than the buffer can hold so the payload block wraps, each packet gets its own data
+        # so that we can tell if a payload ended up in the wrong place.
+        expectedData = []
+        seq = 0
+        num_pkts = 1000
+        for i in range(num_pkts):
+            fakeData = [(x + i) % 65536 for x in range(0, 512)]
+            expectedData.extend(fakeData)
+            h = Sdds.SddsHeader(seq)
             p = Sdds.SddsShortPacket(h.header, fakeData)
             p.encode()
             self.userver.send(p.encodedPacket)
-            pktNum = pktNum + 1
-            if pktNum != 0 and pktNum % 32 == 31:
-                pktNum = pktNum + 1
-                
-            time.sleep(0.05)
-        
-        data,stream,tsamps = self.getData(wanttstamps=True)
-        self.assertEqual(num_changes - 1, len(tsamps), "The number of bulkIO pushes (" + str(len(tsamps)) + ") does not match the expected (" + str(num_changes-1) + ").")
-            
-        self.comp.stop()
+            seq = (seq + 1) % 65536
+            if seq != 0 and seq % 32 == 31:
+                seq = seq + 1
+            if i % 100 == 0:
+                time.sleep(0.01)
+
+        # Wait for data to be received
+        time.sleep(1)
+
+        # Get data
+        data,stream = self.getData()
+
+        # Validate the data made it through intact and in order
+        self.assertEqual(len(data), num_pkts*512)
+        self.assertEqual(data, expectedData, "Data received with scatter receive did not match what was sent")
+        self.assertEqual(self.comp.status.dropped_packets, 0)
+
+    def testPacketMmapBackend(self):
+        self.setupComponent()
 
-    def testWaitOnTTV(self):
-        '''
-        Wait on TTV will send nothing unless the pkt contains a TTV flag
-        '''
-        self.setupComponent(pkts_per_push=10)
-        
         # Get ports
         compDataShortOut_out = self.comp.getPort('dataShortOut')
 
-        self.comp.advanced_configuration.wait_on_ttv = True
-
         # Connect components
         self.comp.connect(self.sink, providesPortName='shortIn')
-        
+
+        self.comp.advanced_optimizations.socket_read_backend = 'packet_mmap'
+
         # Start components
         self.comp.start()
-        ttv = 0
-        pktNum = 0
-        num_changes = 0
-        
-        # We'll do a ttv change every 7th packet
-        while pktNum < 100:
-            
-            if pktNum % 7 == 0:
-                ttv = (ttv + 1) % 2 # aka if 0 become 1, if 1 become 0
-                num_changes += 1
-            
-            # Create data
-            fakeData = [x for x in range(0, 512)]
-            h = Sdds.SddsHeader(pktNum, TTV = ttv)
+
+        # Without CAP_NET_RAW the socket reader falls back to recvmmsg, either way the data should make it through
+        backend = self.comp.advanced_optimizations.socket_read_backend
+        self.assertTrue(backend in ('packet_mmap', 'recvmmsg'), "Unexpected socket read backend " + backend)
+
+        fakeData = [x for x in range(0, 512)]
+        seq = 0
+        num_pkts = 100
+        for i in range(num_pkts):
+            h = Sdds.SddsHeader(seq)
             p = Sdds.SddsShortPacket(h.header, fakeData)
             p.encode()
             self.userver.send(p.encodedPacket)
-            pktNum = pktNum + 1
-            if pktNum != 0 and pktNum % 32 == 31:
-                pktNum = pktNum + 1
-                
-            time.sleep(0.05)
-        
-        data,stream,tsamps = self.getData(wanttstamps=True)
-        self.assertEqual(num_changes/2, len(tsamps), "The number of bulkIO pushes (" + str(len(tsamps)) + ") does not match the expected (" + str(num_changes/2) + ").")
-            
+            seq = seq + 1
+            if seq % 32 == 31:
+                seq = seq + 1
+
+        # Wait for data to be received
+        time.sleep(1)
+
+        # Get data
+        data,stream = self.getData()
+
+        # Validate correct amount of data was received
+        self.assertEqual(len(data), num_pkts*512)
+        self.assertEqual(self.comp.status.dropped_packets, 0)
         self.comp.stop()
-    
-    def testShortBigEndianness(self):
-        self.setupComponent(endianness=BIG_ENDIAN)
-        
+
+    def testIoUringBackend(self):
+        self.setupComponent()
+
         # Get ports
         compDataShortOut_out = self.comp.getPort('dataShortOut')
 
         # Connect components
         self.comp.connect(self.sink, providesPortName='shortIn')
 
+        self.comp.advanced_optimizations.socket_read_backend = 'io_uring'
+
         # Start components
         self.comp.start()
-        
-        # Create data
+
+        # On older kernels the socket reader falls back to recvmmsg, either way the data should make it through
+        backend = self.comp.advanced_optimizations.socket_read_backend
+        self.assertTrue(backend in ('io_uring', 'recvmmsg'), "Unexpected socket read backend " + backend)
+
         fakeData = [x for x in range(0, 512)]
-        
-        h = Sdds.SddsHeader(0)
-        p = Sdds.SddsShortPacket(h.header, fakeData)
-        p.encode() # Defaults to big endian encoding
-        self.userver.send(p.encodedPacket)
-        time.sleep(0.05)
+        seq = 0
+        num_pkts = 100
+        for i in range(num_pkts):
+            h = Sdds.SddsHeader(seq)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+            seq = seq + 1
+            if seq % 32 == 31:
+                seq = seq + 1
+
+        # Wait for data to be received
+        time.sleep(1)
+
+        # Get data
         data,stream = self.getData()
-        
-        self.assertEqual(self.comp.status.input_endianness, "4321", "Status property for endianness is not 4321")
-        self.assertEqual(data, fakeData, "Big Endian short did not match expected")
 
-    def testShortLittleEndianness(self):
-        self.setupComponent(endianness=LITTLE_ENDIAN)
-        
+        # Validate correct amount of data was received
+        self.assertEqual(len(data), num_pkts*512)
+        self.assertEqual(data, fakeData*num_pkts)
+        self.assertEqual(self.comp.status.dropped_packets, 0)
+        self.comp.stop()
+
+    def testMultipleSocketReaders(self):
+        self.setupComponent()
+
         # Get ports
         compDataShortOut_out = self.comp.getPort('dataShortOut')
 
         # Connect components
         self.comp.connect(self.sink, providesPortName='shortIn')
-        
+
+        self.comp.advanced_optimizations.socket_readers = 2
+
         # Start components
         self.comp.start()
-        
-        # Create data
+        self.assertEqual(self.comp.advanced_optimizations.socket_readers, 2)
+
+        # The packets may be split between the readers, they must come back out in order
         fakeData = [x for x in range(0, 512)]
-        # Byte Swap it here to make it little endian on send since encode does big endian (swap)
-        fakeData_bs = list(struct.unpack('>512H', struct.pack('@512H', *fakeData)))
-        
-        # Convert fakeData to BIG ENDIAN
-        h = Sdds.SddsHeader(0)
-        p = Sdds.SddsShortPacket(h.header, fakeData_bs)
-        p.encode() # Defaults to big endian encoding
-        self.userver.send(p.encodedPacket)
-        time.sleep(0.05)
+        seq = 0
+        num_pkts = 100
+        for i in range(num_pkts):
+            h = Sdds.SddsHeader(seq)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+            seq = seq + 1
+            if seq % 32 == 31:
+                seq = seq + 1
+
+        # Wait for data to be received
+        time.sleep(1)
+
+        # Get data
         data,stream = self.getData()
-        
-        self.assertEqual(self.comp.status.input_endianness, "1234", "Status property for endianness is not 1234")
-        self.assertEqual(data, fakeData, "Little Endian short did not match expected")
-        
-    
-    def testTimeSlips(self):
+
+        # Validate correct amount of data was received
+        self.assertEqual(len(data), num_pkts*512)
+        self.assertEqual(data, fakeData*num_pkts)
+        self.assertEqual(self.comp.status.dropped_packets, 0)
+        self.comp.stop()
+
+    def testUnevenLanes(self):
+        """A buffer size that does not split evenly between the socket readers' lanes still delivers every packet"""
         self.setupComponent()
-        
-        # Get ports
-        compDataShortOut_out = self.comp.getPort('dataShortOut')
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
+
+        # 1001 buffers between 3 lanes leaves 2 over
+        self.comp.advanced_optimizations.socket_readers = 3
+        self.comp.advanced_optimizations.buffer_size = 1001
+        self.comp.advanced_optimizations.pkts_per_socket_read = 10
 
         # Start components
         self.comp.start()
+        self.assertEqual(self.comp.advanced_optimizations.socket_readers, 3)
 
-        # Create data
+        # More packets than the buffer holds so every lane's buffers go round more than once
         fakeData = [x for x in range(0, 512)]
-        pktNum = 0
-        
-        sr=1e6
-        xdelta_ns=int(1/sr * 1e9)
-        time_ns=0
-        
-        # No time slips here
-        while pktNum < 100:
-            # Create data
+        seq = 0
+        num_pkts = 3000
+        for i in range(num_pkts):
+            h = Sdds.SddsHeader(seq)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+            seq = (seq + 1) % 65536
+            if seq % 32 == 31:
+                seq = seq + 1
+            if i % 500 == 499:
+                time.sleep(0.1)
+
+        # Wait for data to be received
+        time.sleep(1)
+
+        # Get data
+        data,stream = self.getData()
+
+        self.assertEqual(self.comp.status.socket_buffer_drops, 0)
+        self.assertEqual(self.comp.status.dropped_packets, 0)
+        self.assertEqual(len(data), num_pkts*512)
+        self.assertEqual(data, fakeData*num_pkts)
+        self.comp.stop()
+
+    def testMultipleSocketReadersLargePush(self):
+        if os.sysconf('SC_NPROCESSORS_ONLN') < 2:
+            self.skipTest('needs at least two CPUs')
+
+        # Push size above the packet count so the merge has to time out rather than wait for a full push
+        self.setupComponent(pkts_per_push=1000)
+
+        # Get ports
+        compDataShortOut_out = self.comp.getPort('dataShortOut')
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
+
+        self.comp.advanced_optimizations.socket_readers = 2
+        self.comp.advanced_optimizations.socket_reader_cpus = '0,1'
+
+        # Start components
+        self.comp.start()
+        self.assertEqual(self.comp.advanced_optimizations.socket_readers, 2)
+
+        # Loopback packets are received on the sending CPU, so switching the sender between the two reader CPUs sends
+        # runs of packets to each lane, ending on a run to one lane only
+        fakeData = [x for x in range(0, 512)]
+        seq = 0
+        num_pkts = 100
+        try:
+            for i in range(num_pkts):
+                if i % 10 == 0:
+                    subprocess.check_call(['taskset', '-p', '-c', str((i / 10) % 2), str(os.getpid())], stdout=open(os.devnull, 'w'))
+                h = Sdds.SddsHeader(seq)
+                p = Sdds.SddsShortPacket(h.header, fakeData)
+                p.encode()
+                self.userver.send(p.encodedPacket)
+                seq = seq + 1
+                if seq % 32 == 31:
+                    seq = seq + 1
+        finally:
+            subprocess.call(['taskset', '-p', '-c', '0-%d' % (os.sysconf('SC_NPROCESSORS_ONLN') - 1), str(os.getpid())], stdout=open(os.devnull, 'w'))
+
+        # Wait for data to be received, well past the merge hold
+        time.sleep(1)
+
+        # Get data, every packet must have been pushed in order without waiting for more traffic
+        data,stream = self.getData()
+
+        self.assertEqual(len(data), num_pkts*512)
+        self.assertEqual(data, fakeData*num_pkts)
+        self.assertEqual(self.comp.status.dropped_packets, 0)
+        self.comp.stop()
+
+    def testSpinThenPollWaitStrategy(self):
+        self.setupComponent()
+
+        # Get ports
+        compDataShortOut_out = self.comp.getPort('dataShortOut')
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
+
+        self.comp.advanced_optimizations.socket_wait_strategy = 'spin_then_poll'
+        self.comp.advanced_optimizations.socket_wait_spin_budget = 1000
+
+        # Start components
+        self.comp.start()
+        self.assertEqual(self.comp.advanced_optimizations.socket_wait_strategy, 'spin_then_poll')
+
+        # Leave gaps between the packets so the socket reader has to wait for them
+        fakeData = [x for x in range(0, 512)]
+        seq = 0
+        num_pkts = 20
+        for i in range(num_pkts):
+            h = Sdds.SddsHeader(seq)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+            seq = seq + 1
+            if seq % 32 == 31:
+                seq = seq + 1
+            time.sleep(0.01)
+
+        # Wait for data to be received
+        time.sleep(1)
+
+        # Get data
+        data,stream = self.getData()
+
+        # Validate correct amount of data was received and that both wait phases were used
+        self.assertEqual(len(data), num_pkts*512)
+        self.assertEqual(data, fakeData*num_pkts)
+        self.assertTrue(self.comp.status.socket_wait_spin_time > 0)
+        self.assertTrue(self.comp.status.socket_wait_poll_time > 0)
+        self.assertTrue(self.comp.status.socket_wait_polls > 0)
+        self.comp.stop()
+
+    def testUdpGro(self):
+        self.setupComponent()
+
+        # Get ports
+        compDataShortOut_out = self.comp.getPort('dataShortOut')
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
+
+        self.comp.advanced_optimizations.udp_gro = True
+
+        # Start components
+        self.comp.start()
+
+        fakeData = [x for x in range(0, 512)]
+        seq = 0
+        num_pkts = 100
+        for i in range(num_pkts):
+            h = Sdds.SddsHeader(seq)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+            seq = seq + 1
+            if seq % 32 == 31:
+                seq = seq + 1
+
+        # Wait for data to be received
+        time.sleep(1)
+
+        # Get data
+        data,stream = self.getData()
+
+        # With or without GRO support in the kernel the data should make it through untouched
+        self.assertEqual(len(data), num_pkts*512)
+        self.assertEqual(data, fakeData*num_pkts)
+        self.assertEqual(self.comp.status.dropped_packets, 0)
+        self.comp.stop()
+
+    def testPacketFilter(self):
+        self.setupComponent()
+
+        # Get ports
+        compDataShortOut_out = self.comp.getPort('dataShortOut')
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
+
+        self.comp.advanced_optimizations.packet_filter = True
+        self.comp.advanced_optimizations.packet_filter_bps = 16
+        self.comp.advanced_optimizations.packet_filter_complex = 'real'
+
+        # Start components
+        self.comp.start()
+
+        fakeData = [x for x in range(0, 512)]
+        seq = 0
+        num_pkts = 100
+        num_rejected = 0
+        for i in range(num_pkts):
+            h = Sdds.SddsHeader(seq)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+            seq = seq + 1
+            if seq % 32 == 31:
+                seq = seq + 1
+
+            # Every tenth packet is followed by one flagged complex and a runt, neither should make it to the output
+            if i % 10 == 0:
+                h = Sdds.SddsHeader(seq, CX=1)
+                p = Sdds.SddsShortPacket(h.header, fakeData)
+                p.encode()
+                self.userver.send(p.encodedPacket)
+                self.userver.send(p.encodedPacket[:100])
+                num_rejected = num_rejected + 2
+
+        # Wait for data to be received
+        time.sleep(1)
+
+        # Get data
+        data,stream = self.getData()
+
+        self.assertEqual(len(data), num_pkts*512)
+        self.assertEqual(data, fakeData*num_pkts)
+        self.assertEqual(self.comp.status.dropped_packets, 0)
+        self.assertEqual(self.comp.status.rejected_packets, num_rejected)
+        self.comp.stop()
+
+    def testSocketBufferDrops(self):
+        self.setupComponent()
+
+        # Get ports
+        compDataShortOut_out = self.comp.getPort('dataShortOut')
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
+
+        # A tiny socket buffer so a burst is likely to overflow it
+        self.comp.advanced_optimizations.udp_socket_buffer_size = 1000
+
+        # Start components
+        self.comp.start()
+
+        fakeData = [x for x in range(0, 512)]
+        packets = []
+        seq = 0
+        num_pkts = 5000
+        for i in range(num_pkts):
+            h = Sdds.SddsHeader(seq)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            packets.append(p.encodedPacket)
+            seq = (seq + 1) % 65536
+            if seq % 32 == 31:
+                seq = seq + 1
+
+        for packet in packets:
+            self.userver.send(packet)
+
+        # One more packet after a pause so the drop count of the burst is reported with it
+        time.sleep(0.5)
+        h = Sdds.SddsHeader(seq)
+        p = Sdds.SddsShortPacket(h.header, fakeData)
+        p.encode()
+        self.userver.send(p.encodedPacket)
+
+        # Wait for data to be received
+        time.sleep(1)
+
+        # Get data
+        data,stream = self.getData()
+
+        # Every packet sent is either received or counted as dropped by the kernel
+        drops = self.comp.status.socket_buffer_drops
+        self.assertEqual(len(data)/512 + drops, num_pkts + 1)
+        self.assertTrue(self.comp.status.dropped_packets >= drops)
+        self.comp.stop()
+
+    def testSocketQueueWhileStalled(self):
+        """With the SDDS to BulkIO thread held up in a push the internal buffer fills, then the socket, which the status shows"""
+        self.setupComponent()
+        self.comp.advanced_optimizations.buffer_size = 200
+        self.comp.advanced_optimizations.pkts_per_socket_read = 10
+
+        stall = StallingSink(BULKIO__POA.dataShort)
+        self.comp.getPort('dataShortOut').connectPort(stall.getPort(), 'stall')
+
+        # Start components
+        self.comp.start()
+        self.assertEqual(int(self.comp.status.udp_socket_buffer_queue.split()[0]), 0)
+
+        fakeData = [x for x in range(0, 512)]
+        seq = 0
+        for i in range(1000):
+            h = Sdds.SddsHeader(seq)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+            seq = seq + 1
+            if seq % 32 == 31:
+                seq = seq + 1
+
+        # Past the status interval so the queue is sampled again
+        time.sleep(0.5)
+        queued = int(self.comp.status.udp_socket_buffer_queue.split()[0])
+        self.assertTrue(queued > 0, "Expected packets queued in the socket but the status reads " + self.comp.status.udp_socket_buffer_queue)
+
+        stall.released.set()
+        self.comp.stop()
+
+    def testReceiveLatency(self):
+        self.setupComponent()
+
+        # Get ports
+        compDataShortOut_out = self.comp.getPort('dataShortOut')
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
+
+        self.comp.advanced_optimizations.receive_timestamps = True
+
+        # Start components
+        self.comp.start()
+
+        fakeData = [x for x in range(0, 512)]
+        seq = 0
+        num_pkts = 100
+        for i in range(num_pkts):
+            h = Sdds.SddsHeader(seq)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+            seq = seq + 1
+            if seq % 32 == 31:
+                seq = seq + 1
+
+        # Wait for data to be received
+        time.sleep(1)
+
+        # Get data
+        data,stream = self.getData()
+        self.assertEqual(len(data), num_pkts*512)
+
+        # Every packet was time stamped, the percentiles are ordered and a packet cannot be pushed before it is dequeued
+        status = self.comp.status
+        self.assertTrue(status.dequeue_latency_p50 > 0)
+        self.assertTrue(status.dequeue_latency_p50 <= status.dequeue_latency_p99 <= status.dequeue_latency_p999 <= status.dequeue_latency_max)
+        self.assertTrue(status.push_latency_p50 <= status.push_latency_p99 <= status.push_latency_p999 <= status.push_latency_max)
+        self.assertTrue(status.push_latency_max >= status.dequeue_latency_max)
+
+        # One second is an eternity on the loopback interface
+        self.assertTrue(status.push_latency_max < 1e6)
+        self.comp.stop()
+
+    def testMultipleAttach(self):
+        """Attaches two streams on different ports and checks each comes out on its own BulkIO stream"""
+        self.comp.interface = 'lo'
+        self.comp.advanced_optimizations.max_attached_streams = 2
+        compDataSddsIn = self.comp.getPort('dataSddsIn')
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
+
+        port2 = self.port + 1
+        userver2 = unicast.unicast_server(self.uni_ip, port2)
+        streamDef1 = BULKIO.SDDSStreamDefinition('stream1', BULKIO.SDDS_SI, self.uni_ip, 0, self.port, 8000, True, 'testing')
+        streamDef2 = BULKIO.SDDSStreamDefinition('stream2', BULKIO.SDDS_SI, self.uni_ip, 0, port2, 8000, True, 'testing')
+        self.assertEqual(compDataSddsIn.attach(streamDef1, 'test'), 'stream1')
+        self.assertEqual(compDataSddsIn.attach(streamDef2, 'test'), 'stream2')
+
+        # A third attach is over the maximum
+        streamDef3 = BULKIO.SDDSStreamDefinition('stream3', BULKIO.SDDS_SI, self.uni_ip, 0, port2 + 1, 8000, True, 'testing')
+        self.assertRaises(BULKIO.dataSDDS.AttachError, compDataSddsIn.attach, streamDef3, 'test')
+
+        # Start components
+        self.comp.start()
+        self.assertEqual(self.comp.status.attached_streams, 2)
+
+        # Each stream has its own sequence numbers
+        fakeData1 = [x for x in range(0, 512)]
+        fakeData2 = [x for x in range(512, 1024)]
+        num_pkts = 50
+        seq = 0
+        for i in range(num_pkts):
+            h = Sdds.SddsHeader(seq)
+            p = Sdds.SddsShortPacket(h.header, fakeData1)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+            p = Sdds.SddsShortPacket(h.header, fakeData2)
+            p.encode()
+            userver2.send(p.encodedPacket)
+            seq = seq + 1
+            if seq % 32 == 31:
+                seq = seq + 1
+
+        # Wait for data to be received
+        time.sleep(1)
+
+        for streamID, fakeData in (('stream1', fakeData1), ('stream2', fakeData2)):
+            data = []
+            streamdata = self.sink.read(timeout=1, streamID=streamID)
+            while streamdata:
+                data.extend(streamdata.data)
+                streamdata = self.sink.read(timeout=0.1, streamID=streamID)
+            self.assertEqual(len(data), num_pkts*512)
+            self.assertEqual(data, fakeData*num_pkts)
+
+        self.assertEqual(self.comp.status.dropped_packets, 0)
+
+        # Detaching one stream leaves the other attached
+        compDataSddsIn.detach('stream1')
+        self.assertEqual(self.comp.status.attached_streams, 1)
+        self.comp.stop()
+        del(userver2)
+
+    def testMultipleAttachSri(self):
+        """SRI pushed before its stream is attached is applied once it is, SRI for no attached stream goes nowhere"""
+        self.comp.interface = 'lo'
+        self.comp.advanced_optimizations.max_attached_streams = 2
+        compDataSddsIn = self.comp.getPort('dataSddsIn')
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
+
+        # Little endian data on stream2 only comes out right if its SRI reached it
+        kw = [CF.DataType("dataRef", ossie.properties.to_tc_value(LITTLE_ENDIAN, 'long'))]
+        sri = BULKIO.StreamSRI(hversion=1, xstart=0.0, xdelta=1.0, xunits=1, subsize=0, ystart=0.0, ydelta=0.0, yunits=0, mode=0, streamID='stream2', blocking=False, keywords=kw)
+        compDataSddsIn.pushSRI(sri, timestamp.now())
+        sri = BULKIO.StreamSRI(hversion=1, xstart=0.0, xdelta=1.0, xunits=1, subsize=0, ystart=0.0, ydelta=0.0, yunits=0, mode=0, streamID='unattached', blocking=False, keywords=kw)
+        compDataSddsIn.pushSRI(sri, timestamp.now())
+
+        port2 = self.port + 1
+        userver2 = unicast.unicast_server(self.uni_ip, port2)
+        streamDef1 = BULKIO.SDDSStreamDefinition('stream1', BULKIO.SDDS_SI, self.uni_ip, 0, self.port, 8000, True, 'testing')
+        streamDef2 = BULKIO.SDDSStreamDefinition('stream2', BULKIO.SDDS_SI, self.uni_ip, 0, port2, 8000, True, 'testing')
+        compDataSddsIn.attach(streamDef1, 'test')
+        compDataSddsIn.attach(streamDef2, 'test')
+
+        # Start components
+        self.comp.start()
+
+        fakeData = [x for x in range(0, 512)]
+        fakeData_bs = list(struct.unpack('>512H', struct.pack('@512H', *fakeData)))
+        num_pkts = 10
+        for seq in range(num_pkts):
+            h = Sdds.SddsHeader(seq)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+            p = Sdds.SddsShortPacket(h.header, fakeData_bs)
+            p.encode()
+            userver2.send(p.encodedPacket)
+
+        # Wait for data to be received
+        time.sleep(1)
+
+        for streamID in ('stream1', 'stream2'):
+            data = []
+            streamdata = self.sink.read(timeout=1, streamID=streamID)
+            while streamdata:
+                data.extend(streamdata.data)
+                streamdata = self.sink.read(timeout=0.1, streamID=streamID)
+            self.assertEqual(data, fakeData*num_pkts)
+        self.assertEqual(self.sink.read(timeout=0.1, streamID='unattached'), None)
+
+        self.comp.stop()
+        del(userver2)
+
+    def testAttachWhileRunning(self):
+        """Gaps on one stream show up in its own status, a stream attached while running leaves the others undisturbed"""
+        self.comp.interface = 'lo'
+        self.comp.advanced_optimizations.max_attached_streams = 3
+        compDataSddsIn = self.comp.getPort('dataSddsIn')
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
+
+        port2 = self.port + 1
+        port3 = self.port + 2
+        userver2 = unicast.unicast_server(self.uni_ip, port2)
+        userver3 = unicast.unicast_server(self.uni_ip, port3)
+        streamDef1 = BULKIO.SDDSStreamDefinition('stream1', BULKIO.SDDS_SI, self.uni_ip, 0, self.port, 8000, True, 'testing')
+        streamDef2 = BULKIO.SDDSStreamDefinition('stream2', BULKIO.SDDS_SI, self.uni_ip, 0, port2, 8000, True, 'testing')
+        streamDef3 = BULKIO.SDDSStreamDefinition('stream3', BULKIO.SDDS_SI, self.uni_ip, 0, port3, 8000, True, 'testing')
+        compDataSddsIn.attach(streamDef1, 'test')
+        compDataSddsIn.attach(streamDef2, 'test')
+
+        # Start components
+        self.comp.start()
+
+        fakeData1 = [x for x in range(0, 512)]
+        fakeData2 = [x for x in range(512, 1024)]
+        fakeData3 = [x for x in range(1024, 1536)]
+
+        # Stream 2 is missing packets 5 and 10
+        for seq in range(0, 20):
+            h = Sdds.SddsHeader(seq)
+            p = Sdds.SddsShortPacket(h.header, fakeData1)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+            if seq in (5, 10):
+                continue
+            p = Sdds.SddsShortPacket(h.header, fakeData2)
+            p.encode()
+            userver2.send(p.encodedPacket)
+
+        time.sleep(0.5)
+
+        self.assertEqual(self.comp.status.dropped_packets, 2)
+        streams = dict(entry.split(': ', 1) for entry in self.comp.status.stream_status.split('; '))
+        self.assertEqual(sorted(streams.keys()), ['stream1', 'stream2'])
+        self.assertTrue('dropped packets 0,' in streams['stream1'], streams['stream1'])
+        self.assertTrue('dropped packets 2,' in streams['stream2'], streams['stream2'])
+
+        # Stream 3 is attached without stopping, stream 1 carries on with the next sequence number
+        self.assertEqual(compDataSddsIn.attach(streamDef3, 'test'), 'stream3')
+        self.assertEqual(self.comp.status.attached_streams, 3)
+        for seq in range(20, 40):
+            if seq % 32 == 31:
+                continue
+            h = Sdds.SddsHeader(seq)
+            p = Sdds.SddsShortPacket(h.header, fakeData1)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+            p = Sdds.SddsShortPacket(h.header, fakeData3)
+            p.encode()
+            userver3.send(p.encodedPacket)
+
+        time.sleep(1)
+
+        for streamID, fakeData, num_pkts in (('stream1', fakeData1, 39), ('stream3', fakeData3, 19)):
+            data = []
+            streamdata = self.sink.read(timeout=1, streamID=streamID)
+            while streamdata:
+                self.assertFalse(streamdata.eos, "Got an EOS on " + streamID)
+                data.extend(streamdata.data)
+                streamdata = self.sink.read(timeout=0.1, streamID=streamID)
+            self.assertEqual(len(data), num_pkts*512)
+            self.assertEqual(data, fakeData*num_pkts)
+
+        self.assertEqual(self.comp.status.dropped_packets, 2)
+
+        self.comp.stop()
+        del(userver2)
+        del(userver3)
+
+    def testStatusSnapshot(self):
+        self.setupComponent()
+
+        # Get ports
+        compDataShortOut_out = self.comp.getPort('dataShortOut')
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
+
+        # Far longer than the test, anything seen below was published when the threads ran out of work
+        self.comp.advanced_optimizations.status_interval = 60000
+
+        # Start components
+        self.comp.start()
+        self.assertEqual(self.comp.status.num_udp_socket_readers, 1)
+
+        # Leave a gap of five packets
+        fakeData = [x for x in range(0, 512)]
+        for seq in range(0, 20) + range(25, 30):
+            h = Sdds.SddsHeader(seq)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+
+        # Wait for data to be received
+        time.sleep(0.5)
+
+        status = self.comp.status
+        self.assertEqual(status.dropped_packets, 5)
+        self.assertEqual(status.bits_per_sample, 16)
+        self.assertTrue(status.buffers_to_work.startswith("0 "), "Expected no buffers to work but received " + status.buffers_to_work)
+
+        # The interval can be changed while running
+        self.comp.advanced_optimizations.status_interval = 10
+        self.assertEqual(self.comp.advanced_optimizations.status_interval, 10)
+        self.comp.stop()
+
+    def testDataPathCounters(self):
+        self.setupComponent()
+
+        # Get ports
+        compDataShortOut_out = self.comp.getPort('dataShortOut')
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
+
+        # Start components
+        self.comp.start()
+
+        fakeData = [x for x in range(0, 512)]
+        for seq in range(0, 40):
+            h = Sdds.SddsHeader(seq)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+            time.sleep(0.001)
+
+        # Wait for data to be received
+        time.sleep(0.5)
+
+        status = self.comp.status
+        self.assertEqual(status.packets_received, 40)
+        self.assertEqual(status.bytes_received, 40 * 1080)
+        self.assertTrue(status.socket_reads > status.empty_socket_reads, "Expected at least one socket read with data")
+        self.assertTrue(status.empty_socket_reads > 0, "Expected the socket to have run dry between packets")
+        self.assertTrue(status.processor_buffer_wait > 0, "Expected the SDDS to BulkIO thread to have waited for packets")
+        self.comp.stop()
+
+    def testOverflowPolicy(self):
+        self.setupComponent()
+
+        # Get ports
+        compDataShortOut_out = self.comp.getPort('dataShortOut')
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
+
+        self.assertEqual(self.comp.advanced_optimizations.overflow_policy, "block")
+        self.comp.advanced_optimizations.overflow_policy = "drop_oldest"
+
+        # Start components
+        self.comp.start()
+
+        # Cannot be changed while running
+        self.comp.advanced_optimizations.overflow_policy = "drop_newest"
+        self.assertEqual(self.comp.advanced_optimizations.overflow_policy, "drop_oldest")
+
+        fakeData = [x for x in range(0, 512)]
+        for seq in range(0, 40):
+            h = Sdds.SddsHeader(seq)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+
+        # Wait for data to be received
+        time.sleep(0.5)
+
+        # Plenty of room in the buffer so nothing should have been thrown away
+        data,stream = self.getData()
+        self.assertEqual(len(data), 40 * 512)
+        self.assertEqual(self.comp.status.overflow_drops, 0)
+        self.assertEqual(self.comp.status.dropped_packets, 0)
+        self.comp.stop()
+
+    def testNumaNode(self):
+        self.setupComponent()
+
+        # Get ports
+        compDataShortOut_out = self.comp.getPort('dataShortOut')
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
+
+        # Not placed by default
+        self.assertEqual(self.comp.advanced_optimizations.numa_node, "")
+        self.comp.start()
+        self.assertEqual(self.comp.status.numa_node, -1)
+        self.comp.stop()
+
+        # Every machine has a node 0, though the kernel may refuse to place the buffer without NUMA support
+        self.comp.advanced_optimizations.numa_node = "0"
+        self.comp.start()
+        self.assertTrue(self.comp.status.numa_node in (0, -1))
+
+        # Cannot be changed while running
+        self.comp.advanced_optimizations.numa_node = "interface"
+        self.assertEqual(self.comp.advanced_optimizations.numa_node, "0")
+
+        fakeData = [x for x in range(0, 512)]
+        for seq in range(0, 40):
+            h = Sdds.SddsHeader(seq)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+
+        # Wait for data to be received
+        time.sleep(0.5)
+
+        data,stream = self.getData()
+        self.assertEqual(len(data), 40 * 512)
+        self.comp.stop()
+
+    def testHugePages(self):
+        self.setupComponent()
+
+        # Get ports
+        compDataShortOut_out = self.comp.getPort('dataShortOut')
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
+
+        self.assertEqual(self.comp.advanced_optimizations.huge_pages, "none")
+        self.assertEqual(self.comp.advanced_optimizations.lock_buffer, False)
+        self.comp.start()
+        self.assertEqual(self.comp.status.buffer_page_size, resource.getpagesize())
+        self.assertEqual(self.comp.status.buffer_locked, False)
+        self.comp.stop()
+
+        # Whether huge pages or the lock are granted depends on the system, the buffer must work either way
+        self.comp.advanced_optimizations.huge_pages = "transparent"
+        self.comp.advanced_optimizations.lock_buffer = True
+        self.comp.start()
+        self.assertTrue(self.comp.status.buffer_page_size >= resource.getpagesize())
+
+        # Cannot be changed while running
+        self.comp.advanced_optimizations.huge_pages = "hugetlb"
+        self.assertEqual(self.comp.advanced_optimizations.huge_pages, "transparent")
+
+        fakeData = [x for x in range(0, 512)]
+        for seq in range(0, 40):
+            h = Sdds.SddsHeader(seq)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+
+        # Wait for data to be received
+        time.sleep(0.5)
+
+        data,stream = self.getData()
+        self.assertEqual(len(data), 40 * 512)
+        self.comp.stop()
+
+    def testUdpBufferSize(self):
+
+        self.setupComponent()
+        
+        buffer_sizes = (1000, 2000, 3000, 4000, 5000, 6000)
+        prev_buffer = 0
+
+        # We cannot know exactly what the kernel will pick after our request, this test will try and increase
+        # the buffer size and simply confirm that each run creates a larger buffer size than the one before
+        # however depending on system settings this test may fail.
+        for udp_buffer_size in buffer_sizes:
+            self.comp.advanced_optimizations.udp_socket_buffer_size = udp_buffer_size
+            self.comp.start()
+            buf_size = [int(s) for s in self.comp.status.udp_socket_buffer_queue.split() if s.isdigit()][1]
+            self.assertTrue(buf_size > prev_buffer, "Failure could be false positive, see note in UDP Buffer Size test.")
+            prev_buffer = buf_size
+            self.comp.stop()
+        
+    def testSddsPacketsPerBulkIOPush(self):
+        self.setupComponent()
+        
+        # Get ports
+        compDataShortOut_out = self.comp.getPort('dataShortOut')
+        sdds_pkts_per_push = (1, 2, 4, 8, 16, 32, 64)
+
+
+
+        for pkts_per_push in sdds_pkts_per_push:
+            self.comp.advanced_optimizations.sdds_pkts_per_bulkio_push = pkts_per_push
+
+            # Start components
+            self.comp.start()
+
+            num_sends = 0
+            data = []
+            
+
+            sink = sb.StreamSink()
+            self.comp.connect(sink, providesPortName='shortIn')
+            
+            while (not(data) and num_sends < 3*max(sdds_pkts_per_push)):
+                # Create data
+                fakeData = [x for x in range(0, 512)]
+                h = Sdds.SddsHeader(num_sends)
+                p = Sdds.SddsShortPacket(h.header, fakeData)
+                p.encode()
+                self.userver.send(p.encodedPacket)
+                num_sends = num_sends + 1
+                if num_sends != 0 and num_sends % 32 == 31:
+                    num_sends = num_sends + 1
+                    
+                time.sleep(0.05)               
+                packet = sink.port.getPacket()
+                if packet.dataBuffer:
+                    data = packet.dataBuffer
+
+            # Validate correct amount of data was received
+            self.assertEqual(len(data), pkts_per_push * 512)
+            self.comp.stop()
+
+    def testRunsEndOnGaps(self):
+        self.setupComponent(endianness=BIG_ENDIAN, pkts_per_push=8)
+
+        # Get ports
+        compDataShortOut_out = self.comp.getPort('dataShortOut')
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
+
+        # Start components
+        self.comp.start()
+
+        # Packets are written out in runs, the missing packet 6 has to end the run without losing the packets either side of it
+        expected = []
+        for seq in range(0, 12):
+            if seq == 6:
+                continue
+            fakeData = [(seq * 512 + x) % 65536 for x in range(0, 512)]
+            h = Sdds.SddsHeader(seq)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+            expected.extend(fakeData)
+
+        time.sleep(0.5)
+        data,stream = self.getData()
+
+        self.assertEqual(self.comp.status.dropped_packets, 1)
+        self.assertEqual(data, expected, "Runs either side of a gap did not match expected")
+
+    def testPushOnTTV(self):
+        '''
+        Push on TTV will send the packet out if the TTV flag changes
+        '''
+        self.setupComponent(pkts_per_push=10)
+        
+        # Get ports
+        compDataShortOut_out = self.comp.getPort('dataShortOut')
+        
+        self.comp.advanced_configuration.push_on_ttv = True
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
+
+        # Start components
+        self.comp.start()
+        ttv = 0
+        pktNum = 0
+        num_changes = 0
+        
+        # We'll do a ttv change every 7th packet
+        while pktNum < 100:
+            
+            if pktNum % 7 == 0:
+                ttv = (ttv + 1) % 2 # aka if 0 become 1, if 1 become 0
+                num_changes += 1
+            
+            # Create data
+            fakeData = [x for x in range(0, 512)]
+            h = Sdds.SddsHeader(pktNum, TTV = ttv)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+            pktNum = pktNum + 1
+            if pktNum != 0 and pktNum % 32 == 31:
+                pktNum = pktNum + 1
+                
+            time.sleep(0.05)
+        
+        data,stream,tsamps = self.getData(wanttstamps=True)
+        self.assertEqual(num_changes - 1, len(tsamps), "The number of bulkIO pushes (" + str(len(tsamps)) + ") does not match the expected (" + str(num_changes-1) + ").")
+            
+        self.comp.stop()
+
+    def testWaitOnTTV(self):
+        '''
+        Wait on TTV will send nothing unless the pkt contains a TTV flag
+        '''
+        self.setupComponent(pkts_per_push=10)
+        
+        # Get ports
+        compDataShortOut_out = self.comp.getPort('dataShortOut')
+
+        self.comp.advanced_configuration.wait_on_ttv = True
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
+        
+        # Start components
+        self.comp.start()
+        ttv = 0
+        pktNum = 0
+        num_changes = 0
+        
+        # We'll do a ttv change every 7th packet
+        while pktNum < 100:
+            
+            if pktNum % 7 == 0:
+                ttv = (ttv + 1) % 2 # aka if 0 become 1, if 1 become 0
+                num_changes += 1
+            
+            # Create data
+            fakeData = [x for x in range(0, 512)]
+            h = Sdds.SddsHeader(pktNum, TTV = ttv)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+            pktNum = pktNum + 1
+            if pktNum != 0 and pktNum % 32 == 31:
+                pktNum = pktNum + 1
+                
+            time.sleep(0.05)
+        
+        data,stream,tsamps = self.getData(wanttstamps=True)
+        self.assertEqual(num_changes/2, len(tsamps), "The number of bulkIO pushes (" + str(len(tsamps)) + ") does not match the expected (" + str(num_changes/2) + ").")
+            
+        self.comp.stop()
+    
+    def testShortBigEndianness(self):
+        self.setupComponent(endianness=BIG_ENDIAN)
+        
+        # Get ports
+        compDataShortOut_out = self.comp.getPort('dataShortOut')
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
+
+        # Start components
+        self.comp.start()
+        
+        # Create data
+        fakeData = [x for x in range(0, 512)]
+        
+        h = Sdds.SddsHeader(0)
+        p = Sdds.SddsShortPacket(h.header, fakeData)
+        p.encode() # Defaults to big endian encoding
+        self.userver.send(p.encodedPacket)
+        time.sleep(0.05)
+        data,stream = self.getData()
+        
+        self.assertEqual(self.comp.status.input_endianness, "4321", "Status property for endianness is not 4321")
+        self.assertEqual(data, fakeData, "Big Endian short did not match expected")
+
+    def testShortLittleEndianness(self):
+        self.setupComponent(endianness=LITTLE_ENDIAN)
+        
+        # Get ports
+        compDataShortOut_out = self.comp.getPort('dataShortOut')
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
+        
+        # Start components
+        self.comp.start()
+        
+        # Create data
+        fakeData = [x for x in range(0, 512)]
+        # Byte Swap it here to make it little endian on send since encode does big endian (swap)
+        fakeData_bs = list(struct.unpack('>512H', struct.pack('@512H', *fakeData)))
+        
+        # Convert fakeData to BIG ENDIAN
+        h = Sdds.SddsHeader(0)
+        p = Sdds.SddsShortPacket(h.header, fakeData_bs)
+        p.encode() # Defaults to big endian encoding
+        self.userver.send(p.encodedPacket)
+        time.sleep(0.05)
+        data,stream = self.getData()
+        
+        self.assertEqual(self.comp.status.input_endianness, "1234", "Status property for endianness is not 1234")
+        self.assertEqual(data, fakeData, "Little Endian short did not match expected")
+        
+    
+    def testLittleEndianRuns(self):
+        self.setupComponent(endianness=LITTLE_ENDIAN, pkts_per_push=4)
+
+        # Get ports
+        compDataShortOut_out = self.comp.getPort('dataShortOut')
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
+
+        # The swapped payloads go out in runs of up to 4 packets, the last one short, with and without the
+        # payloads split from the headers
+        for scatter_receive in (False, True):
+            self.comp.advanced_optimizations.scatter_receive = scatter_receive
+            self.comp.start()
+
+            expected = []
+            for seq in range(0, 10):
+                fakeData = [(seq * 512 + x) % 65536 for x in range(0, 512)]
+                fakeData_bs = list(struct.unpack('>512H', struct.pack('@512H', *fakeData)))
+                h = Sdds.SddsHeader(seq)
+                p = Sdds.SddsShortPacket(h.header, fakeData_bs)
+                p.encode()
+                self.userver.send(p.encodedPacket)
+                expected.extend(fakeData)
+
+            time.sleep(0.5)
+            data,stream = self.getData()
+            self.assertEqual(data, expected, "Little Endian runs did not match expected")
+            self.comp.stop()
+
+    def testFloatLittleEndianness(self):
+        self.setupComponent(endianness=LITTLE_ENDIAN)
+
+        # Get ports
+        compDataFloatOut_out = self.comp.getPort('dataFloatOut')
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='floatIn')
+
+        # Start components
+        self.comp.start()
+        self.assertTrue(self.comp.status.byte_swap_kernel in ("avx512", "avx2", "ssse3", "scalar"))
+
+        # Byte Swap it here to make it little endian on send since encode does big endian (swap), every packet
+        # differs so a kernel swapping the wrong bytes or the wrong part of the payload cannot go unnoticed
+        expected = []
+        for pkt in range(0, 8):
+            fakeData = [float(pkt * 256 + x) for x in range(0, 256)]
+            fakeData_bs = list(struct.unpack('>256f', struct.pack('<256f', *fakeData)))
+            h = Sdds.SddsHeader(pkt, DM = [0, 1, 0], BPS = [1, 1, 1, 1, 1])
+            p = Sdds.SddsFloatPacket(h.header, fakeData_bs)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+            expected.extend(fakeData)
+
+        time.sleep(0.5)
+        data,stream = self.getData()
+
+        self.assertEqual(self.comp.status.input_endianness, "1234", "Status property for endianness is not 1234")
+        self.assertEqual(data, expected, "Little Endian float did not match expected")
+
+    def testTimeSlips(self):
+        self.setupComponent()
+        
+        # Get ports
+        compDataShortOut_out = self.comp.getPort('dataShortOut')
+
+        # Start components
+        self.comp.start()
+
+        # Create data
+        fakeData = [x for x in range(0, 512)]
+        pktNum = 0
+        
+        sr=1e6
+        xdelta_ns=int(1/sr * 1e9)
+        time_ns=0
+        
+        # No time slips here
+        while pktNum < 100:
+            # Create data
             h = Sdds.SddsHeader(pktNum, FREQ=(sr*73786976294.838211), TT=(time_ns*4))
             p = Sdds.SddsShortPacket(h.header, fakeData)
             p.encode()
@@ -1180,9 +2246,54 @@ class ComponentTests(ossie.utils.testing.ScaComponentTestCase):
             twsec = bulkIO_time[1].twsec
             tfsec = bulkIO_time[1].tfsec
             self.assertEqual(twsec, seconds_since_new_year, "BulkIO time stamp does not match received SDDS time stamp")
-            self.assertEqual(tfsec, expected_time_ns/1.0e9)
+            # Time stamps after the first are moved on by the ideal time step rather than read from each packet
+            self.assertAlmostEqual(tfsec, expected_time_ns/1.0e9, places=9)
             expected_time_ns = expected_time_ns + 512*xdelta_ns
 
+    def testBulkIOTimingJump(self):
+        """After a jump in the time tags the time stamp is read from the packet's time tag, not predicted from the last"""
+        self.setupComponent()
+
+        # Connect components
+        self.comp.connect(self.sink, providesPortName='shortIn')
+
+        # Start components
+        self.comp.start()
+
+        fakeData = [x for x in range(0, 512)]
+        sr=1e6
+        xdelta_ns=int(1/(sr) * 1e9)
+        jump_ns = 1000250
+        time_ns=0
+        pktNum = 0
+        expected_ns = []
+
+        # The time tags jump ahead part way through, the packets either side are contiguous
+        for i in range(60):
+            if i == 30:
+                time_ns = time_ns + jump_ns
+            h = Sdds.SddsHeader(pktNum, FREQ=(sr*73786976294.838211), TT=(time_ns*4), CX=1)
+            p = Sdds.SddsShortPacket(h.header, fakeData)
+            p.encode()
+            self.userver.send(p.encodedPacket)
+            expected_ns.append(time_ns)
+            pktNum = pktNum + 1
+            if pktNum % 32 == 31:
+                pktNum = pktNum + 1
+            time_ns = time_ns + 512*xdelta_ns
+
+        time.sleep(0.5)
+        data,stream,tsamps = self.getData(wanttstamps=True)
+        self.assertEqual(len(tsamps), len(expected_ns))
+
+        # The stamp after the jump is the packet's own time tag, the prediction would be jump_ns behind it
+        predicted_ns = expected_ns[29] + 512*xdelta_ns
+        self.assertAlmostEqual(tsamps[30][1].tfsec, expected_ns[30]/1.0e9, places=9)
+        self.assertNotAlmostEqual(tsamps[30][1].tfsec, predicted_ns/1.0e9, places=9)
+        for (offset, bulkIO_time), time_ns in zip(tsamps, expected_ns):
+            self.assertAlmostEqual(bulkIO_time.tfsec, time_ns/1.0e9, places=9)
+        self.assertEqual(self.comp.status.time_slips, 1)
+        self.comp.stop()
 
     def testUseBulkIOSRI(self):
         